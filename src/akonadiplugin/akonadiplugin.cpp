@@ -62,11 +62,11 @@ QSortFilterProxyModel* AkonadiPlugin::createBirthdayModels(QWidget* messageParen
     return sortModel;
 }
 
-void AkonadiPlugin::setPrefixSuffix(QSortFilterProxyModel* model, const QString& prefix, const QString& suffix, const QStringList& alarmMessageList)
+void AkonadiPlugin::setPrefixSuffix(QSortFilterProxyModel* model, const QString& prefix, const QString& suffix, const QSet<QString>& alarmMessages)
 {
     BirthdaySortModel* bmodel = qobject_cast<BirthdaySortModel*>(model);
     if (bmodel)
-        bmodel->setPrefixSuffix(prefix, suffix, alarmMessageList);
+        bmodel->setPrefixSuffix(prefix, suffix, alarmMessages);
 }
 
 int AkonadiPlugin::birthdayModelEnum(BirthdayModelValue value) const
@@ -26,7 +26,7 @@ public:
     QSortFilterProxyModel* createBirthdayModels(QWidget* messageParent, QObject* parent = nullptr) override;
 
     /** Set a new prefix and suffix, and the corresponding selection list. */
-    void setPrefixSuffix(QSortFilterProxyModel* birthdaySortModel, const QString& prefix, const QString& suffix, const QStringList& alarmMessageList) override;
+    void setPrefixSuffix(QSortFilterProxyModel* birthdaySortModel, const QString& prefix, const QString& suffix, const QSet<QString>& alarmMessages) override;
 
     /** Return BirthdayModel enum values. */
     int birthdayModelEnum(BirthdayModelValue) const override;
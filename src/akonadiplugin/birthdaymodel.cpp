@@ -76,12 +76,25 @@ BirthdaySortModel::BirthdaySortModel(QObject* parent)
 /******************************************************************************
 * Set a new prefix and suffix for the alarm message, and set the selection list
 * based on them.
+* The names of contacts which already have alarms are extracted from the alarm
+* messages, so that each contact can be checked by a single hash lookup.
 */
-void BirthdaySortModel::setPrefixSuffix(const QString& prefix, const QString& suffix, const QStringList& alarmMessageList)
+void BirthdaySortModel::setPrefixSuffix(const QString& prefix, const QString& suffix, const QSet<QString>& alarmMessages)
 {
+    QSet<QString> contacts;
+    const int affixLength = prefix.size() + suffix.size();
+    for (const QString& message : alarmMessages)
+    {
+        if (message.size() >= affixLength
+        &&  message.startsWith(prefix)  &&  message.endsWith(suffix))
+            contacts.insert(message.mid(prefix.size(), message.size() - affixLength));
+    }
+    if (prefix == mPrefix  &&  suffix == mSuffix  &&  contacts == mContactsWithAlarm)
+        return;   // the filter is unchanged
+
     mPrefix = prefix;
     mSuffix = suffix;
-    mContactsWithAlarm = alarmMessageList;
+    mContactsWithAlarm = contacts;
 
     invalidateFilter();
 }
@@ -95,8 +108,7 @@ bool BirthdaySortModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourc
     if (birthdayIndex.data(Qt::DisplayRole).toString().isEmpty())
         return false;
 
-    const QString text = mPrefix + nameIndex.data(Qt::DisplayRole).toString() + mSuffix;
-    if (mContactsWithAlarm.contains(text))
+    if (mContactsWithAlarm.contains(nameIndex.data(Qt::DisplayRole).toString()))
         return false;
 
     return true;
@@ -12,6 +12,7 @@
 #include <Akonadi/ContactsTreeModel>
 
 #include <QSortFilterProxyModel>
+#include <QSet>
 
 namespace Akonadi
 {
@@ -55,15 +56,15 @@ class BirthdaySortModel : public QSortFilterProxyModel
 public:
     explicit BirthdaySortModel(QObject* parent = nullptr);
 
-    void setPrefixSuffix(const QString& prefix, const QString& suffix, const QStringList& alarmMessageList);
+    void setPrefixSuffix(const QString& prefix, const QString& suffix, const QSet<QString>& alarmMessages);
 
 protected:
     bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
 
 private:
-    QStringList mContactsWithAlarm;
-    QString     mPrefix;
-    QString     mSuffix;
+    QSet<QString> mContactsWithAlarm;   // names of contacts which already have birthday alarms
+    QString       mPrefix;
+    QString       mSuffix;
 };
 
 // vim: et sw=4:
@@ -16,6 +16,10 @@
 
 #include <QPainter>
 
+namespace
+{
+const int MAX_CACHED_SIZES = 500;   // maximum number of text sizes to cache
+}
 
 void AlarmListDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
 {
@@ -65,13 +69,16 @@ void AlarmListDelegate::paint(QPainter* painter, const QStyleOptionViewItem& opt
             }
             case AlarmListModel::ColourColumn:
             {
-                const KAEvent event = static_cast<const EventListModel*>(index.model())->event(index);
-                if (event.isValid())
+                // Fetch only the event attributes needed, to avoid looking
+                // up the whole event for every cell painted.
+                const QVariant cmdError = index.data(ResourceDataModelBase::CommandErrorRole);
+                if (cmdError.isValid())
                 {
-                    if (event.commandError() == KAEvent::CmdErr::None)
+                    if (static_cast<KAEvent::CmdErr>(cmdError.toInt()) == KAEvent::CmdErr::None)
                     {
-                        if (event.actionTypes() & KAEvent::Action::Display)
-                            opt.palette.setColor(QPalette::Highlight, event.bgColour());
+                        const QVariant colour = index.data(ResourceDataModelBase::DisplayColourRole);
+                        if (colour.isValid())
+                            opt.palette.setColor(QPalette::Highlight, colour.value<QColor>());
                     }
                     else
                     {
@@ -112,14 +119,54 @@ void AlarmListDelegate::edit(KAEvent& event, EventListView* view)
 
 QRect AlarmListDelegate::textRect(const QString& text, QPainter* painter, const QStyleOptionViewItem& opt) const
 {
-    QRect displayRect;
+    return QStyle::alignedRect(opt.direction, opt.displayAlignment,
+                               textSize(text, painter, opt).boundedTo(opt.rect.size()),
+                               opt.rect);
+}
+
+/******************************************************************************
+* Return the size needed to display a text, using cached sizes where possible.
+* If all digits in the font have the same width (as is usual), texts which
+* differ only in their digits have the same size, so only one size needs to be
+* cached for each date/time format.
+*/
+QSize AlarmListDelegate::textSize(const QString& text, QPainter* painter, const QStyleOptionViewItem& opt) const
+{
+    if (opt.font != mTextSizeFont)
+    {
+        mTextSizes.clear();
+        mTextSizeFont = opt.font;
+        const QFontMetrics fm(opt.font);
+        const int width = fm.horizontalAdvance(QLatin1Char('0'));
+        mTabularDigits = true;
+        for (char c = '1';  c <= '9';  ++c)
+        {
+            if (fm.horizontalAdvance(QLatin1Char(c)) != width)
+            {
+                mTabularDigits = false;
+                break;
+            }
+        }
+    }
+
+    QString key = text;
+    if (mTabularDigits)
+    {
+        for (QChar& c : key)
+            if (c >= QLatin1Char('1')  &&  c <= QLatin1Char('9'))
+                c = QLatin1Char('0');
+    }
+    auto it = mTextSizes.constFind(key);
+    if (it != mTextSizes.constEnd())
+        return it.value();
+
+    if (mTextSizes.size() >= MAX_CACHED_SIZES)
+        mTextSizes.clear();
     QRect r = opt.rect;
     r.setWidth(INT_MAX/256);
-    displayRect = textRectangle(painter, r, opt.font, text);
-    displayRect = QStyle::alignedRect(opt.direction, opt.displayAlignment,
-                                      displayRect.size().boundedTo(opt.rect.size()),
-                                      opt.rect);
-    return displayRect;
+    const QSize size = textRectangle(painter, r, opt.font, text).size();
+    mTextSizes.insert(key, size);
+    return size;
 }
 
 #include "moc_alarmlistdelegate.cpp"
@@ -10,6 +10,9 @@
 
 #include "alarmlistview.h"
 
+#include <QFont>
+#include <QHash>
+
 
 class AlarmListDelegate : public EventListDelegate
 {
@@ -23,6 +26,11 @@ public:
 
 private:
     QRect textRect(const QString& text, QPainter*, const QStyleOptionViewItem&) const;
+    QSize textSize(const QString& text, QPainter*, const QStyleOptionViewItem&) const;
+
+    mutable QHash<QString, QSize> mTextSizes;   // cached text sizes, by text with digits normalised
+    mutable QFont mTextSizeFont;                // font which mTextSizes applies to
+    mutable bool  mTabularDigits {false};       // all digits in mTextSizeFont have the same width
 };
 
 // vim: et sw=4:
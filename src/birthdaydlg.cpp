@@ -361,6 +361,8 @@ void BirthdayDlg::slotTextLostFocus()
 
 /******************************************************************************
 * Re-evaluates the selection list according to the birthday alarm text format.
+* The texts of existing annual alarms are fetched only once, since they don't
+* depend on the prefix and suffix.
 */
 void BirthdayDlg::setSortModelSelectionList()
 {
@@ -368,16 +370,18 @@ void BirthdayDlg::setSortModelSelectionList()
     if (!akonadiPlugin)
         return;
 
-    QStringList alarmMessageList;
-    const QList<KAEvent> activeEvents = ResourcesCalendar::events(CalEvent::ACTIVE);
-    for (const KAEvent& event : activeEvents)
+    if (!mAlarmMessagesFetched)
     {
-        if (event.actionSubType() == KAEvent::SubAction::Message
-        &&  event.recurType() == KARecurrence::ANNUAL_DATE
-        &&  (mPrefixText.isEmpty()  ||  event.message().startsWith(mPrefixText)))
-            alarmMessageList.append(event.message());
+        const QList<KAEvent> activeEvents = ResourcesCalendar::events(CalEvent::ACTIVE);
+        for (const KAEvent& event : activeEvents)
+        {
+            if (event.actionSubType() == KAEvent::SubAction::Message
+            &&  event.recurType() == KARecurrence::ANNUAL_DATE)
+                mAlarmMessages.insert(event.message());
+        }
+        mAlarmMessagesFetched = true;
     }
-    akonadiPlugin->setPrefixSuffix(mBirthdaySortModel, mPrefixText, mSuffixText, alarmMessageList);
+    akonadiPlugin->setPrefixSuffix(mBirthdaySortModel, mPrefixText, mSuffixText, mAlarmMessages);
 }
 
 #include "moc_birthdaydlg.cpp"
@@ -13,6 +13,7 @@
 
 #include <QDialog>
 #include <QList>
+#include <QSet>
 
 class QFocusEvent;
 class QTreeView;
@@ -63,6 +64,8 @@ private:
     QDialogButtonBox*      mButtonBox;
     QString                mPrefixText;   // last entered value of prefix text
     QString                mSuffixText;   // last entered value of suffix text
+    QSet<QString>          mAlarmMessages;  // texts of existing annual message alarms
+    bool                   mAlarmMessagesFetched {false};  // mAlarmMessages has been initialised
     KAEvent::Flags         mFlags;        // event flag bits
     int                    mBirthdayModel_NameColumn {-1};
     int                    mBirthdayModel_DateColumn {-1};
@@ -44,6 +44,7 @@ enum Option
     OptEDIT_NEW_PRESET,
     OptFILE,
     FROM_ID,
+    OptHEADLESS,
     INTERVAL,
     KORGANIZER,
     LATE_CANCEL,
@@ -191,6 +192,9 @@ QStringList CommandOptions::setOptions(QCommandLineParser* parser, const QString
               = new QCommandLineOption(QStringList{QStringLiteral("F"), QStringLiteral("from-id")},
                                        i18n("KMail identity to use as sender of email"),
                                        QStringLiteral("ID"));
+    mOptions[OptHEADLESS]
+              = new QCommandLineOption(QStringLiteral("headless"),
+                                       i18n("Run alarms without displaying any windows"));
     mOptions[INTERVAL]
               = new QCommandLineOption(QStringList{QStringLiteral("i"), QStringLiteral("interval")},
                                        i18n("Interval between alarm repetitions"),
@@ -342,6 +346,9 @@ void CommandOptions::process()
     if (d->checkCommand(OptTRAY, TRAY))
     {
     }
+    if (d->checkCommand(OptHEADLESS, HEADLESS))
+    {
+    }
     if (d->checkCommand(OptLIST, LIST))
     {
         if (!mParser->positionalArguments().empty())
@@ -28,6 +28,7 @@ public:
         CMD_ERROR,        // error in command line options
         NONE,             // no command
         TRAY,             // --tray
+        HEADLESS,         // --headless
         TRIGGER_EVENT,    // --triggerEvent
         CANCEL_EVENT,     // --cancelEvent
         EDIT,             // --edit
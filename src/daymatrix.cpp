@@ -69,7 +69,7 @@ DayMatrix::DayMatrix(QWidget* parent)
     connect(resources, &Resources::resourceRemoved, this, &DayMatrix::resourceRemoved);
     connect(resources, &Resources::settingsChanged, this, &DayMatrix::resourceSettingsChanged);
     connect(resources, &Resources::eventsAdded, this, &DayMatrix::resourceUpdated);
-    connect(resources, &Resources::eventUpdated, this, &DayMatrix::resourceUpdated);
+    connect(resources, &Resources::eventsUpdated, this, &DayMatrix::resourceUpdated);
     connect(resources, &Resources::eventsRemoved, this, &DayMatrix::resourceUpdated);
     Preferences::connect(&Preferences::holidaysChanged, this, &DayMatrix::slotUpdateView);
     Preferences::connect(&Preferences::workTimeChanged, this, &DayMatrix::slotUpdateView);
@@ -17,6 +17,10 @@
 #include "kalarmcalendar/karecurrence.h"
 #include "kalarm_debug.h"
 
+#include <KLocalizedString>
+
+#include <QDBusMetaType>
+
 using namespace KCalendarCore;
 
 #include <stdlib.h>
@@ -26,6 +30,15 @@ using namespace KCalendarCore;
 namespace
 {
 const QString REQUEST_DBUS_OBJECT(QStringLiteral("/kalarm"));   // D-Bus object path of KAlarm's request interface
+
+QVariantMap alarmSpec(const QString& type, const QString& name, const QString& text,
+                      const QString& startDateTime, int lateCancel, unsigned flags);
+void setDisplaySpec(QVariantMap& spec, const QString& bgColor, const QString& fgColor, const QString& font,
+                    const QString& audioUrl, int reminderMins);
+void setRecurrenceSpec(QVariantMap& spec, const QString& recurrence, int subRepeatInterval, int subRepeatCount);
+void setRecurrenceSpec(QVariantMap& spec, int recurType, int recurInterval, int recurCount);
+void setRecurrenceSpec(QVariantMap& spec, int recurType, int recurInterval, const QString& endDateTime);
+void reportError(QString* error, const QString& message);
 }
 
 
@@ -36,6 +49,7 @@ const QString REQUEST_DBUS_OBJECT(QStringLiteral("/kalarm"));   // D-Bus object
 DBusHandler::DBusHandler()
 {
     qCDebug(KALARM_LOG) << "DBusHandler:";
+    qDBusRegisterMetaType<QList<QVariantMap>>();
     new KalarmAdaptor(this);
     QDBusConnection::sessionBus().registerObject(REQUEST_DBUS_OBJECT, this);
 }
@@ -65,14 +79,10 @@ bool DBusHandler::scheduleMessage(const QString& name, const QString& message, c
                                   const QString& audioUrl, int reminderMins, const QString& recurrence,
                                   int subRepeatInterval, int subRepeatCount)
 {
-    KADateTime start;
-    KARecurrence recur;
-    Duration subRepeatDuration;
-    if (!convertRecurrence(start, recur, startDateTime, recurrence, subRepeatInterval, subRepeatDuration))
-        return false;
-    return scheduleMessage(name, message, start, lateCancel, flags, bgColor, fgColor, font,
-                           QUrl::fromUserInput(audioUrl, QString(), QUrl::AssumeLocalFile),
-                           reminderMins, recur, subRepeatDuration, subRepeatCount);
+    QVariantMap spec = alarmSpec(QStringLiteral("message"), name, message, startDateTime, lateCancel, flags);
+    setDisplaySpec(spec, bgColor, fgColor, font, audioUrl, reminderMins);
+    setRecurrenceSpec(spec, recurrence, subRepeatInterval, subRepeatCount);
+    return scheduleAlarm(spec);
 }
 
 bool DBusHandler::scheduleMessage(const QString& name, const QString& message, const QString& startDateTime, int lateCancel, unsigned flags,
@@ -80,13 +90,10 @@ bool DBusHandler::scheduleMessage(const QString& name, const QString& message, c
                                   const QString& audioUrl, int reminderMins,
                                   int recurType, int recurInterval, int recurCount)
 {
-    KADateTime start;
-    KARecurrence recur;
-    if (!convertRecurrence(start, recur, startDateTime, recurType, recurInterval, recurCount))
-        return false;
-    return scheduleMessage(name, message, start, lateCancel, flags, bgColor, fgColor, font,
-                           QUrl::fromUserInput(audioUrl, QString(), QUrl::AssumeLocalFile),
-                           reminderMins, recur);
+    QVariantMap spec = alarmSpec(QStringLiteral("message"), name, message, startDateTime, lateCancel, flags);
+    setDisplaySpec(spec, bgColor, fgColor, font, audioUrl, reminderMins);
+    setRecurrenceSpec(spec, recurType, recurInterval, recurCount);
+    return scheduleAlarm(spec);
 }
 
 bool DBusHandler::scheduleMessage(const QString& name, const QString& message, const QString& startDateTime, int lateCancel, unsigned flags,
@@ -94,13 +101,10 @@ bool DBusHandler::scheduleMessage(const QString& name, const QString& message, c
                                   const QString& audioUrl, int reminderMins,
                                   int recurType, int recurInterval, const QString& endDateTime)
 {
-    KADateTime start;
-    KARecurrence recur;
-    if (!convertRecurrence(start, recur, startDateTime, recurType, recurInterval, endDateTime))
-        return false;
-    return scheduleMessage(name, message, start, lateCancel, flags, bgColor, fgColor, font,
-                           QUrl::fromUserInput(audioUrl, QString(), QUrl::AssumeLocalFile),
-                           reminderMins, recur);
+    QVariantMap spec = alarmSpec(QStringLiteral("message"), name, message, startDateTime, lateCancel, flags);
+    setDisplaySpec(spec, bgColor, fgColor, font, audioUrl, reminderMins);
+    setRecurrenceSpec(spec, recurType, recurInterval, endDateTime);
+    return scheduleAlarm(spec);
 }
 
 bool DBusHandler::scheduleMessage(const QString& message, const QString& startDateTime, int lateCancel, unsigned flags,
@@ -134,41 +138,28 @@ bool DBusHandler::scheduleFile(const QString& name, const QString& url, const QS
                                const QString& audioUrl, int reminderMins, const QString& recurrence,
                                int subRepeatInterval, int subRepeatCount)
 {
-    KADateTime start;
-    KARecurrence recur;
-    Duration subRepeatDuration;
-    if (!convertRecurrence(start, recur, startDateTime, recurrence, subRepeatInterval, subRepeatDuration))
-        return false;
-    return scheduleFile(name, QUrl::fromUserInput(url, QString(), QUrl::AssumeLocalFile),
-                        start, lateCancel, flags, bgColor,
-                        QUrl::fromUserInput(audioUrl, QString(), QUrl::AssumeLocalFile),
-                        reminderMins, recur, subRepeatDuration, subRepeatCount);
+    QVariantMap spec = alarmSpec(QStringLiteral("file"), name, url, startDateTime, lateCancel, flags);
+    setDisplaySpec(spec, bgColor, QString(), QString(), audioUrl, reminderMins);
+    setRecurrenceSpec(spec, recurrence, subRepeatInterval, subRepeatCount);
+    return scheduleAlarm(spec);
 }
 
 bool DBusHandler::scheduleFile(const QString& name, const QString& url, const QString& startDateTime, int lateCancel, unsigned flags, const QString& bgColor,
                                const QString& audioUrl, int reminderMins, int recurType, int recurInterval, int recurCount)
 {
-    KADateTime start;
-    KARecurrence recur;
-    if (!convertRecurrence(start, recur, startDateTime, recurType, recurInterval, recurCount))
-        return false;
-    return scheduleFile(name, QUrl::fromUserInput(url, QString(), QUrl::AssumeLocalFile),
-                        start, lateCancel, flags, bgColor,
-                        QUrl::fromUserInput(audioUrl, QString(), QUrl::AssumeLocalFile),
-                        reminderMins, recur);
+    QVariantMap spec = alarmSpec(QStringLiteral("file"), name, url, startDateTime, lateCancel, flags);
+    setDisplaySpec(spec, bgColor, QString(), QString(), audioUrl, reminderMins);
+    setRecurrenceSpec(spec, recurType, recurInterval, recurCount);
+    return scheduleAlarm(spec);
 }
 
 bool DBusHandler::scheduleFile(const QString& name, const QString& url, const QString& startDateTime, int lateCancel, unsigned flags, const QString& bgColor,
                                const QString& audioUrl, int reminderMins, int recurType, int recurInterval, const QString& endDateTime)
 {
-    KADateTime start;
-    KARecurrence recur;
-    if (!convertRecurrence(start, recur, startDateTime, recurType, recurInterval, endDateTime))
-        return false;
-    return scheduleFile(name, QUrl::fromUserInput(url, QString(), QUrl::AssumeLocalFile),
-                        start, lateCancel, flags, bgColor,
-                        QUrl::fromUserInput(audioUrl, QString(), QUrl::AssumeLocalFile),
-                        reminderMins, recur);
+    QVariantMap spec = alarmSpec(QStringLiteral("file"), name, url, startDateTime, lateCancel, flags);
+    setDisplaySpec(spec, bgColor, QString(), QString(), audioUrl, reminderMins);
+    setRecurrenceSpec(spec, recurType, recurInterval, endDateTime);
+    return scheduleAlarm(spec);
 }
 
 bool DBusHandler::scheduleFile(const QString& url, const QString& startDateTime, int lateCancel, unsigned flags, const QString& bgColor,
@@ -196,34 +187,25 @@ bool DBusHandler::scheduleFile(const QString& url, const QString& startDateTime,
 bool DBusHandler::scheduleCommand(const QString& name, const QString& commandLine, const QString& startDateTime, int lateCancel, unsigned flags,
                                   const QString& recurrence, int subRepeatInterval, int subRepeatCount)
 {
-    KADateTime start;
-    KARecurrence recur;
-    Duration subRepeatDuration;
-    if (!convertRecurrence(start, recur, startDateTime, recurrence, subRepeatInterval, subRepeatDuration))
-        return false;
-    return scheduleCommand(name, commandLine, start, lateCancel, flags, recur, subRepeatDuration, subRepeatCount);
+    QVariantMap spec = alarmSpec(QStringLiteral("command"), name, commandLine, startDateTime, lateCancel, flags);
+    setRecurrenceSpec(spec, recurrence, subRepeatInterval, subRepeatCount);
+    return scheduleAlarm(spec);
 }
 
 bool DBusHandler::scheduleCommand(const QString& name, const QString& commandLine, const QString& startDateTime, int lateCancel, unsigned flags,
                                   int recurType, int recurInterval, int recurCount)
 {
-    KADateTime start = convertDateTime(startDateTime);
-    if (!start.isValid())
-        return false;
-    KARecurrence recur;
-    if (!convertRecurrence(start, recur, startDateTime, recurType, recurInterval, recurCount))
-        return false;
-    return scheduleCommand(name, commandLine, start, lateCancel, flags, recur);
+    QVariantMap spec = alarmSpec(QStringLiteral("command"), name, commandLine, startDateTime, lateCancel, flags);
+    setRecurrenceSpec(spec, recurType, recurInterval, recurCount);
+    return scheduleAlarm(spec);
 }
 
 bool DBusHandler::scheduleCommand(const QString& name, const QString& commandLine, const QString& startDateTime, int lateCancel, unsigned flags,
                                   int recurType, int recurInterval, const QString& endDateTime)
 {
-    KADateTime start;
-    KARecurrence recur;
-    if (!convertRecurrence(start, recur, startDateTime, recurType, recurInterval, endDateTime))
-        return false;
-    return scheduleCommand(name, commandLine, start, lateCancel, flags, recur);
+    QVariantMap spec = alarmSpec(QStringLiteral("command"), name, commandLine, startDateTime, lateCancel, flags);
+    setRecurrenceSpec(spec, recurType, recurInterval, endDateTime);
+    return scheduleAlarm(spec);
 }
 
 bool DBusHandler::scheduleCommand(const QString& commandLine, const QString& startDateTime, int lateCancel, unsigned flags,
@@ -248,34 +230,39 @@ bool DBusHandler::scheduleEmail(const QString& name, const QString& fromID, cons
                                 const QString& attachments, const QString& startDateTime, int lateCancel, unsigned flags,
                                 const QString& recurrence, int subRepeatInterval, int subRepeatCount)
 {
-    KADateTime start;
-    KARecurrence recur;
-    Duration subRepeatDuration;
-    if (!convertRecurrence(start, recur, startDateTime, recurrence, subRepeatInterval, subRepeatDuration))
-        return false;
-    return scheduleEmail(name, fromID, addresses, subject, message, attachments, start, lateCancel, flags, recur, subRepeatDuration, subRepeatCount);
+    QVariantMap spec = alarmSpec(QStringLiteral("email"), name, message, startDateTime, lateCancel, flags);
+    spec[QStringLiteral("fromID")]      = fromID;
+    spec[QStringLiteral("addresses")]   = addresses;
+    spec[QStringLiteral("subject")]     = subject;
+    spec[QStringLiteral("attachments")] = attachments;
+    setRecurrenceSpec(spec, recurrence, subRepeatInterval, subRepeatCount);
+    return scheduleAlarm(spec);
 }
 
 bool DBusHandler::scheduleEmail(const QString& name, const QString& fromID, const QString& addresses, const QString& subject, const QString& message,
                                 const QString& attachments, const QString& startDateTime, int lateCancel, unsigned flags,
                                 int recurType, int recurInterval, int recurCount)
 {
-    KADateTime start;
-    KARecurrence recur;
-    if (!convertRecurrence(start, recur, startDateTime, recurType, recurInterval, recurCount))
-        return false;
-    return scheduleEmail(name, fromID, addresses, subject, message, attachments, start, lateCancel, flags, recur);
+    QVariantMap spec = alarmSpec(QStringLiteral("email"), name, message, startDateTime, lateCancel, flags);
+    spec[QStringLiteral("fromID")]      = fromID;
+    spec[QStringLiteral("addresses")]   = addresses;
+    spec[QStringLiteral("subject")]     = subject;
+    spec[QStringLiteral("attachments")] = attachments;
+    setRecurrenceSpec(spec, recurType, recurInterval, recurCount);
+    return scheduleAlarm(spec);
 }
 
 bool DBusHandler::scheduleEmail(const QString& name, const QString& fromID, const QString& addresses, const QString& subject, const QString& message,
                                 const QString& attachments, const QString& startDateTime, int lateCancel, unsigned flags,
                                 int recurType, int recurInterval, const QString& endDateTime)
 {
-    KADateTime start;
-    KARecurrence recur;
-    if (!convertRecurrence(start, recur, startDateTime, recurType, recurInterval, endDateTime))
-        return false;
-    return scheduleEmail(name, fromID, addresses, subject, message, attachments, start, lateCancel, flags, recur);
+    QVariantMap spec = alarmSpec(QStringLiteral("email"), name, message, startDateTime, lateCancel, flags);
+    spec[QStringLiteral("fromID")]      = fromID;
+    spec[QStringLiteral("addresses")]   = addresses;
+    spec[QStringLiteral("subject")]     = subject;
+    spec[QStringLiteral("attachments")] = attachments;
+    setRecurrenceSpec(spec, recurType, recurInterval, endDateTime);
+    return scheduleAlarm(spec);
 }
 
 bool DBusHandler::scheduleEmail(const QString& fromID, const QString& addresses, const QString& subject, const QString& message,
@@ -302,34 +289,31 @@ bool DBusHandler::scheduleEmail(const QString& fromID, const QString& addresses,
 bool DBusHandler::scheduleAudio(const QString& name, const QString& audioUrl, int volumePercent, const QString& startDateTime, int lateCancel,
                                 unsigned flags, const QString& recurrence, int subRepeatInterval, int subRepeatCount)
 {
-    KADateTime start;
-    KARecurrence recur;
-    Duration subRepeatDuration;
-    if (!convertRecurrence(start, recur, startDateTime, recurrence, subRepeatInterval, subRepeatDuration))
-        return false;
-    return scheduleAudio(name, audioUrl, volumePercent, start, lateCancel, flags, recur, subRepeatDuration, subRepeatCount);
+    QVariantMap spec = alarmSpec(QStringLiteral("audio"), name, QString(), startDateTime, lateCancel, flags);
+    spec[QStringLiteral("audioUrl")]      = audioUrl;
+    spec[QStringLiteral("volumePercent")] = volumePercent;
+    setRecurrenceSpec(spec, recurrence, subRepeatInterval, subRepeatCount);
+    return scheduleAlarm(spec);
 }
 
 bool DBusHandler::scheduleAudio(const QString& name, const QString& audioUrl, int volumePercent, const QString& startDateTime, int lateCancel,
                                 unsigned flags, int recurType, int recurInterval, int recurCount)
 {
-    KADateTime start = convertDateTime(startDateTime);
-    if (!start.isValid())
-        return false;
-    KARecurrence recur;
-    if (!convertRecurrence(start, recur, startDateTime, recurType, recurInterval, recurCount))
-        return false;
-    return scheduleAudio(name, audioUrl, volumePercent, start, lateCancel, flags, recur);
+    QVariantMap spec = alarmSpec(QStringLiteral("audio"), name, QString(), startDateTime, lateCancel, flags);
+    spec[QStringLiteral("audioUrl")]      = audioUrl;
+    spec[QStringLiteral("volumePercent")] = volumePercent;
+    setRecurrenceSpec(spec, recurType, recurInterval, recurCount);
+    return scheduleAlarm(spec);
 }
 
 bool DBusHandler::scheduleAudio(const QString& name, const QString& audioUrl, int volumePercent, const QString& startDateTime, int lateCancel,
                                 unsigned flags, int recurType, int recurInterval, const QString& endDateTime)
 {
-    KADateTime start;
-    KARecurrence recur;
-    if (!convertRecurrence(start, recur, startDateTime, recurType, recurInterval, endDateTime))
-        return false;
-    return scheduleAudio(name, audioUrl, volumePercent, start, lateCancel, flags, recur);
+    QVariantMap spec = alarmSpec(QStringLiteral("audio"), name, QString(), startDateTime, lateCancel, flags);
+    spec[QStringLiteral("audioUrl")]      = audioUrl;
+    spec[QStringLiteral("volumePercent")] = volumePercent;
+    setRecurrenceSpec(spec, recurType, recurInterval, endDateTime);
+    return scheduleAlarm(spec);
 }
 
 bool DBusHandler::scheduleAudio(const QString& audioUrl, int volumePercent, const QString& startDateTime, int lateCancel,
@@ -352,6 +336,11 @@ bool DBusHandler::scheduleAudio(const QString& audioUrl, int volumePercent, cons
 
 bool DBusHandler::edit(const QString& eventID)
 {
+    if (KAlarmApp::headless())
+    {
+        qCWarning(KALARM_LOG) << "D-Bus call: edit() not available in headless mode";
+        return false;
+    }
     if (!Resources::allPopulated())
         return false;    // can't access events before calendars are loaded
     return KAlarm::editAlarmById(EventId(eventID));
@@ -359,6 +348,11 @@ bool DBusHandler::edit(const QString& eventID)
 
 bool DBusHandler::editNew(int type)
 {
+    if (KAlarmApp::headless())
+    {
+        qCWarning(KALARM_LOG) << "D-Bus call: editNew() not available in headless mode";
+        return false;
+    }
     EditAlarmDlg::Type dlgtype;
     switch (type)
     {
@@ -376,131 +370,211 @@ bool DBusHandler::editNew(int type)
 
 bool DBusHandler::editNew(const QString& templateName)
 {
+    if (KAlarmApp::headless())
+    {
+        qCWarning(KALARM_LOG) << "D-Bus call: editNew() not available in headless mode";
+        return false;
+    }
     return KAlarm::editNewAlarm(templateName);
 }
 
 
 /******************************************************************************
-* Schedule a message alarm, after converting the parameters from strings.
+* Schedule a list of alarms. All the alarm specifications are validated before
+* any alarm is created, and if any is invalid, no alarms are created. The new
+* alarms are added to the calendar together, so that it is only saved once.
+* The batch is not atomic once validation has succeeded: if the calendar fails
+* to add some of the alarms, the others remain scheduled, and alarms which were
+* already due have been executed. 'eventIds' and 'errors' show which alarms
+* were created.
 */
-bool DBusHandler::scheduleMessage(const QString& name, const QString& message, const KADateTime& start, int lateCancel, unsigned flags,
-                                  const QString& bgColor, const QString& fgColor, const QString& fontStr,
-                                  const QUrl& audioFile, int reminderMins, const KARecurrence& recurrence,
-                                  const KCalendarCore::Duration& subRepeatDuration, int subRepeatCount)
+bool DBusHandler::scheduleBatch(const QList<QVariantMap>& alarms, QStringList& eventIds, QStringList& errors)
 {
-    KAEvent::Flags kaEventFlags = convertStartFlags(start, flags);
-    const KAEvent::SubAction action = (kaEventFlags & KAEvent::DISPLAY_COMMAND) ? KAEvent::SubAction::Command : KAEvent::SubAction::Message;
-    const QColor bg = convertBgColour(bgColor);
-    if (!bg.isValid())
-        return false;
-    QColor fg;
-    if (fgColor.isEmpty())
-        fg = Preferences::defaultFgColour();
-    else
+    qCDebug(KALARM_LOG) << "DBusHandler::scheduleBatch:" << alarms.count();
+    const int count = alarms.count();
+    eventIds.fill(QString(), count);
+    errors.fill(QString(), count);
+    if (!Resources::allPopulated())
     {
-        fg.setNamedColor(fgColor);
-        if (!fg.isValid())
-        {
-            qCCritical(KALARM_LOG) << "D-Bus call: invalid foreground color:" << fgColor;
-            return false;
-        }
+        // Can't add events before calendars are loaded
+        errors.fill(i18nc("@info", "Calendars have not yet been loaded"), count);
+        return false;
     }
-    QFont font;
-    if (fontStr.isEmpty())
-        kaEventFlags |= KAEvent::DEFAULT_FONT;
-    else
+
+    QList<KAEvent> events;
+    events.reserve(count);
+    bool ok = true;
+    for (int i = 0;  i < count;  ++i)
     {
-        if (!font.fromString(fontStr))    // N.B. this doesn't do good validation
-        {
-            qCCritical(KALARM_LOG) << "D-Bus call: invalid font:" << fontStr;
-            return false;
-        }
+        events += createEvent(alarms[i], errors[i]);
+        if (!errors[i].isEmpty())
+            ok = false;
     }
-    return theApp()->scheduleEvent(action, name, message, start, lateCancel, kaEventFlags, bg, fg, font,
-                                   audioFile.toString(), -1, reminderMins, recurrence, subRepeatDuration, subRepeatCount);
+    if (!ok)
+        return false;
+    return theApp()->scheduleEvents(events, eventIds, errors);
 }
 
 /******************************************************************************
-* Schedule a file alarm, after converting the parameters from strings.
+* Schedule a single alarm from an alarm specification.
+* Reply = true unless there was a parameter error or the alarm could not be
+*         scheduled. A late-cancelled alarm counts as success.
 */
-bool DBusHandler::scheduleFile(const QString& name, const QUrl& file,
-                               const KADateTime& start, int lateCancel, unsigned flags, const QString& bgColor,
-                               const QUrl& audioFile, int reminderMins, const KARecurrence& recurrence,
-                               const KCalendarCore::Duration& subRepeatDuration, int subRepeatCount)
+bool DBusHandler::scheduleAlarm(const QVariantMap& spec)
 {
-    const KAEvent::Flags kaEventFlags = convertStartFlags(start, flags);
-    const QColor bg = convertBgColour(bgColor);
-    if (!bg.isValid())
+    QString error;
+    KAEvent event = createEvent(spec, error);
+    if (!error.isEmpty())
         return false;
-    return theApp()->scheduleEvent(KAEvent::SubAction::File, name, file.toString(), start, lateCancel, kaEventFlags, bg, Qt::black, QFont(),
-                                   audioFile.toString(), -1, reminderMins, recurrence, subRepeatDuration, subRepeatCount);
+    if (!event.isValid())
+        return true;    // the alarm was late-cancelled
+    return theApp()->scheduleEvent(event);
 }
 
 /******************************************************************************
-* Schedule a command alarm, after converting the parameters from strings.
+* Create an alarm from an alarm specification. This is the single validation
+* path for all the D-Bus schedule calls.
+* The recurrence is specified either by 'recurrence' (an iCalendar RRULE, with
+* optional sub-repetition), or by 'recurType' and 'recurInterval' together with
+* either 'recurCount' or 'endDateTime'.
+* Reply = new event, or invalid if 'error' is set or the alarm was late-cancelled.
 */
-bool DBusHandler::scheduleCommand(const QString& name, const QString& commandLine,
-                                  const KADateTime& start, int lateCancel, unsigned flags,
-                                  const KARecurrence& recurrence, const KCalendarCore::Duration& subRepeatDuration, int subRepeatCount)
-{
-    const KAEvent::Flags kaEventFlags = convertStartFlags(start, flags);
-    return theApp()->scheduleEvent(KAEvent::SubAction::Command, name, commandLine, start, lateCancel, kaEventFlags, Qt::black, Qt::black, QFont(),
-                                   QString(), -1, 0, recurrence, subRepeatDuration, subRepeatCount);
-}
+KAEvent DBusHandler::createEvent(const QVariantMap& spec, QString& error)
+{
+    error.clear();
+    const QString type          = spec.value(QStringLiteral("type")).toString();
+    const QString name          = spec.value(QStringLiteral("name")).toString();
+    QString       text          = spec.value(QStringLiteral("text")).toString();
+    const QString startDateTime = spec.value(QStringLiteral("startDateTime")).toString();
+    const QString audioUrl      = spec.value(QStringLiteral("audioUrl")).toString();
+    const int     lateCancel    = spec.value(QStringLiteral("lateCancel")).toInt();
+    const unsigned flags        = spec.value(QStringLiteral("flags")).toUInt();
+    const int     subRepeatCount = spec.value(QStringLiteral("subRepeatCount")).toInt();
+    if (startDateTime.isEmpty())
+    {
+        reportError(&error, i18nc("@info", "No start date/time"));
+        return {};
+    }
+    KADateTime start;
+    KARecurrence recur;
+    Duration subRepeatDuration;
+    bool ok;
+    if (spec.contains(QStringLiteral("recurType")))
+    {
+        const int recurType     = spec.value(QStringLiteral("recurType")).toInt();
+        const int recurInterval = spec.value(QStringLiteral("recurInterval")).toInt();
+        if (spec.contains(QStringLiteral("endDateTime")))
+            ok = convertRecurrence(start, recur, startDateTime, recurType, recurInterval,
+                                   spec.value(QStringLiteral("endDateTime")).toString(), &error);
+        else
+            ok = convertRecurrence(start, recur, startDateTime, recurType, recurInterval,
+                                   spec.value(QStringLiteral("recurCount")).toInt(), &error);
+    }
+    else
+        ok = convertRecurrence(start, recur, startDateTime, spec.value(QStringLiteral("recurrence")).toString(),
+                               spec.value(QStringLiteral("subRepeatInterval")).toInt(), subRepeatDuration, &error);
+    if (!ok)
+        return {};
+    KAEvent::Flags kaEventFlags = convertStartFlags(start, flags);
 
-/******************************************************************************
-* Schedule an email alarm, after validating the addresses and attachments.
-*/
-bool DBusHandler::scheduleEmail(const QString& name, const QString& fromID, const QString& addresses, const QString& subject,
-                                const QString& message, const QString& attachments,
-                                const KADateTime& start, int lateCancel, unsigned flags,
-                                const KARecurrence& recurrence, const KCalendarCore::Duration& subRepeatDuration, int subRepeatCount)
-{
-    const KAEvent::Flags kaEventFlags = convertStartFlags(start, flags);
+    KAEvent::SubAction action;
+    QColor bg = Qt::black;
+    QColor fg = Qt::black;
+    QFont font;
+    QString audioFile;
+    float volume = -1;
+    int reminderMins = 0;
     uint senderId = 0;
-    if (!fromID.isEmpty())
+    KCalendarCore::Person::List addrs;
+    QString subject;
+    QStringList atts;
+    if (type == QLatin1String("message")  ||  type == QLatin1String("file"))
     {
-        senderId = Identities::identityUoid(fromID);
-        if (!senderId)
+        bg = convertBgColour(spec.value(QStringLiteral("bgColor")).toString(), &error);
+        if (!bg.isValid())
+            return {};
+        if (type == QLatin1String("file"))
         {
-            qCCritical(KALARM_LOG) << "D-Bus call scheduleEmail(): unknown sender ID:" << fromID;
-            return false;
+            action = KAEvent::SubAction::File;
+            text = QUrl::fromUserInput(text, QString(), QUrl::AssumeLocalFile).toString();
+        }
+        else
+        {
+            action = (kaEventFlags & KAEvent::DISPLAY_COMMAND) ? KAEvent::SubAction::Command : KAEvent::SubAction::Message;
+            const QString fgColor = spec.value(QStringLiteral("fgColor")).toString();
+            if (fgColor.isEmpty())
+                fg = Preferences::defaultFgColour();
+            else
+            {
+                fg.setNamedColor(fgColor);
+                if (!fg.isValid())
+                {
+                    reportError(&error, i18nc("@info", "Invalid foreground color: %1", fgColor));
+                    return {};
+                }
+            }
+            const QString fontStr = spec.value(QStringLiteral("font")).toString();
+            if (fontStr.isEmpty())
+                kaEventFlags |= KAEvent::DEFAULT_FONT;
+            else if (!font.fromString(fontStr))    // N.B. this doesn't do good validation
+            {
+                reportError(&error, i18nc("@info", "Invalid font: %1", fontStr));
+                return {};
+            }
         }
+        audioFile = QUrl::fromUserInput(audioUrl, QString(), QUrl::AssumeLocalFile).toString();
+        reminderMins = spec.value(QStringLiteral("reminderMins")).toInt();
     }
-    KCalendarCore::Person::List addrs;
-    QString bad = KAMail::convertAddresses(addresses, addrs);
-    if (!bad.isEmpty())
+    else if (type == QLatin1String("command"))
+        action = KAEvent::SubAction::Command;
+    else if (type == QLatin1String("email"))
     {
-        qCCritical(KALARM_LOG) << "D-Bus call scheduleEmail(): invalid email addresses:" << bad;
-        return false;
+        action = KAEvent::SubAction::Email;
+        const QString fromID = spec.value(QStringLiteral("fromID")).toString();
+        if (!fromID.isEmpty())
+        {
+            senderId = Identities::identityUoid(fromID);
+            if (!senderId)
+            {
+                reportError(&error, i18nc("@info", "Unknown sender ID: %1", fromID));
+                return {};
+            }
+        }
+        QString bad = KAMail::convertAddresses(spec.value(QStringLiteral("addresses")).toString(), addrs);
+        if (!bad.isEmpty())
+        {
+            reportError(&error, i18nc("@info", "Invalid email addresses: %1", bad));
+            return {};
+        }
+        if (addrs.isEmpty())
+        {
+            reportError(&error, i18nc("@info", "No email address"));
+            return {};
+        }
+        bad = KAMail::convertAttachments(spec.value(QStringLiteral("attachments")).toString(), atts);
+        if (!bad.isEmpty())
+        {
+            reportError(&error, i18nc("@info", "Invalid email attachment: %1", bad));
+            return {};
+        }
+        subject = spec.value(QStringLiteral("subject")).toString();
     }
-    if (addrs.isEmpty())
+    else if (type == QLatin1String("audio"))
     {
-        qCCritical(KALARM_LOG) << "D-Bus call scheduleEmail(): no email address";
-        return false;
+        action = KAEvent::SubAction::Audio;
+        text.clear();
+        audioFile = audioUrl;
+        const int volumePercent = spec.value(QStringLiteral("volumePercent"), -1).toInt();
+        volume = (volumePercent >= 0) ? volumePercent / 100.0f : -1;
     }
-    QStringList atts;
-    bad = KAMail::convertAttachments(attachments, atts);
-    if (!bad.isEmpty())
+    else
     {
-        qCCritical(KALARM_LOG) << "D-Bus call scheduleEmail(): invalid email attachment:" << bad;
-        return false;
+        reportError(&error, i18nc("@info", "Invalid alarm type: '%1'", type));
+        return {};
     }
-    return theApp()->scheduleEvent(KAEvent::SubAction::Email, name, message, start, lateCancel, kaEventFlags, Qt::black, Qt::black, QFont(),
-                                   QString(), -1, 0, recurrence, subRepeatDuration, subRepeatCount, senderId, addrs, subject, atts);
-}
-
-/******************************************************************************
-* Schedule a audio alarm, after converting the parameters from strings.
-*/
-bool DBusHandler::scheduleAudio(const QString& name, const QString& audioUrl, int volumePercent,
-                                const KADateTime& start, int lateCancel, unsigned flags,
-                                const KARecurrence& recurrence, const KCalendarCore::Duration& subRepeatDuration, int subRepeatCount)
-{
-    const KAEvent::Flags kaEventFlags = convertStartFlags(start, flags);
-    const float volume = (volumePercent >= 0) ? volumePercent / 100.0f : -1;
-    return theApp()->scheduleEvent(KAEvent::SubAction::Audio, name, QString(), start, lateCancel, kaEventFlags, Qt::black, Qt::black, QFont(),
-                                   audioUrl, volume, 0, recurrence, subRepeatDuration, subRepeatCount);
+    return KAlarmApp::createEvent(action, name, text, start, lateCancel, kaEventFlags, bg, fg, font,
+                                  audioFile, volume, reminderMins, recur, subRepeatDuration, subRepeatCount,
+                                  senderId, addrs, subject, atts);
 }
 
 
@@ -511,7 +585,7 @@ bool DBusHandler::scheduleAudio(const QString& name, const QString& audioUrl, in
 * If no time zone is specified, it defaults to the local clock time (which is
 * not the same as the local time zone).
 */
-KADateTime DBusHandler::convertDateTime(const QString& dateTime, const KADateTime& defaultDt)
+KADateTime DBusHandler::convertDateTime(const QString& dateTime, QString* error, const KADateTime& defaultDt)
 {
     int i = dateTime.indexOf(QLatin1Char(' '));
     QString dtString = dateTime;
@@ -562,9 +636,9 @@ KADateTime DBusHandler::convertDateTime(const QString& dateTime, const KADateTim
     if (error  ||  !result.isValid())
     {
         if (!defaultDt.isValid())
-            qCCritical(KALARM_LOG) << "D-Bus call: invalid start date/time: '" << dateTime << "'";
+            reportError(error, i18nc("@info", "Invalid start date/time: '%1'", dateTime));
         else
-            qCCritical(KALARM_LOG) << "D-Bus call: invalid recurrence end date/time: '" << dateTime << "'";
+            reportError(error, i18nc("@info", "Invalid recurrence end date/time: '%1'", dateTime));
     }
     return result;
 }
@@ -597,25 +671,31 @@ KAEvent::Flags DBusHandler::convertStartFlags(const KADateTime& start, unsigned
 /******************************************************************************
 * Convert the background colour string to a QColor.
 */
-QColor DBusHandler::convertBgColour(const QString& bgColor)
+QColor DBusHandler::convertBgColour(const QString& bgColor, QString* error)
 {
     if (bgColor.isEmpty())
         return Preferences::defaultBgColour();
     const QColor bg(bgColor);
     if (!bg.isValid())
-        qCCritical(KALARM_LOG) << "D-Bus call: invalid background color:" << bgColor;
+        reportError(error, i18nc("@info", "Invalid background color: %1", bgColor));
     return bg;
 }
 
+/******************************************************************************
+* Convert the start date/time and iCalendar recurrence strings.
+*/
 bool DBusHandler::convertRecurrence(KADateTime& start, KARecurrence& recurrence,
                                     const QString& startDateTime, const QString& icalRecurrence,
-                    int subRepeatInterval, KCalendarCore::Duration& subRepeatDuration)
+                                    int subRepeatInterval, KCalendarCore::Duration& subRepeatDuration, QString* error)
 {
-    start = convertDateTime(startDateTime);
+    start = convertDateTime(startDateTime, error);
     if (!start.isValid())
         return false;
     if (!recurrence.set(icalRecurrence))
+    {
+        reportError(error, i18nc("@info", "Invalid recurrence: %1", icalRecurrence));
         return false;
+    }
     if (subRepeatInterval  &&  recurrence.type() == KARecurrence::NO_RECUR)
     {
         subRepeatInterval = 0;
@@ -628,37 +708,46 @@ bool DBusHandler::convertRecurrence(KADateTime& start, KARecurrence& recurrence,
     return true;
 }
 
+/******************************************************************************
+* Convert the start date/time string and a recurrence with a repetition count.
+*/
 bool DBusHandler::convertRecurrence(KADateTime& start, KARecurrence& recurrence, const QString& startDateTime,
-                                    int recurType, int recurInterval, int recurCount)
+                                    int recurType, int recurInterval, int recurCount, QString* error)
 {
-    start = convertDateTime(startDateTime);
+    start = convertDateTime(startDateTime, error);
     if (!start.isValid())
         return false;
-    return convertRecurrence(recurrence, start, recurType, recurInterval, recurCount, KADateTime());
+    return convertRecurrence(recurrence, start, recurType, recurInterval, recurCount, KADateTime(), error);
 }
 
+/******************************************************************************
+* Convert the start date/time string and a recurrence with an end date/time.
+*/
 bool DBusHandler::convertRecurrence(KADateTime& start, KARecurrence& recurrence, const QString& startDateTime,
-                                    int recurType, int recurInterval, const QString& endDateTime)
+                                    int recurType, int recurInterval, const QString& endDateTime, QString* error)
 {
-    start = convertDateTime(startDateTime);
+    start = convertDateTime(startDateTime, error);
     if (!start.isValid())
         return false;
-    const KADateTime end = convertDateTime(endDateTime, start);
+    const KADateTime end = convertDateTime(endDateTime, error, start);
     if (end.isDateOnly()  &&  !start.isDateOnly())
     {
-        qCCritical(KALARM_LOG) << "D-Bus call: alarm is date-only, but recurrence end is date/time";
+        reportError(error, i18nc("@info", "Alarm is date-only, but recurrence end is date/time"));
         return false;
     }
     if (!end.isDateOnly()  &&  start.isDateOnly())
     {
-        qCCritical(KALARM_LOG) << "D-Bus call: alarm is timed, but recurrence end is date-only";
+        reportError(error, i18nc("@info", "Alarm is timed, but recurrence end is date-only"));
         return false;
     }
-    return convertRecurrence(recurrence, start, recurType, recurInterval, 0, end);
+    return convertRecurrence(recurrence, start, recurType, recurInterval, 0, end, error);
 }
 
+/******************************************************************************
+* Convert a D-Bus recurrence type and parameters to a KARecurrence.
+*/
 bool DBusHandler::convertRecurrence(KARecurrence& recurrence, const KADateTime& start, int recurType,
-                                    int recurInterval, int recurCount, const KADateTime& end)
+                                    int recurInterval, int recurCount, const KADateTime& end, QString* error)
 {
     KARecurrence::Type type;
     switch (recurType)
@@ -669,13 +758,82 @@ bool DBusHandler::convertRecurrence(KARecurrence& recurrence, const KADateTime&
         case MONTHLY:   type = KARecurrence::MONTHLY_DAY;  break;
         case YEARLY:    type = KARecurrence::ANNUAL_DATE;  break;
         default:
-            qCCritical(KALARM_LOG) << "D-Bus call: invalid recurrence type:" << recurType;
+            reportError(error, i18nc("@info", "Invalid recurrence type: %1", recurType));
             return false;
     }
     recurrence.set(type, recurInterval, recurCount, start, end);
     return true;
 }
 
+namespace
+{
+
+/******************************************************************************
+* Create an alarm specification containing the parameters common to all
+* alarm types.
+*/
+QVariantMap alarmSpec(const QString& type, const QString& name, const QString& text,
+                      const QString& startDateTime, int lateCancel, unsigned flags)
+{
+    QVariantMap spec;
+    spec[QStringLiteral("type")]          = type;
+    spec[QStringLiteral("name")]          = name;
+    spec[QStringLiteral("text")]          = text;
+    spec[QStringLiteral("startDateTime")] = startDateTime;
+    spec[QStringLiteral("lateCancel")]    = lateCancel;
+    spec[QStringLiteral("flags")]         = flags;
+    return spec;
+}
+
+/******************************************************************************
+* Set the display and sound parameters of a message or file alarm specification.
+*/
+void setDisplaySpec(QVariantMap& spec, const QString& bgColor, const QString& fgColor, const QString& font,
+                    const QString& audioUrl, int reminderMins)
+{
+    spec[QStringLiteral("bgColor")]      = bgColor;
+    spec[QStringLiteral("fgColor")]      = fgColor;
+    spec[QStringLiteral("font")]         = font;
+    spec[QStringLiteral("audioUrl")]     = audioUrl;
+    spec[QStringLiteral("reminderMins")] = reminderMins;
+}
+
+/******************************************************************************
+* Set the recurrence parameters of an alarm specification.
+*/
+void setRecurrenceSpec(QVariantMap& spec, const QString& recurrence, int subRepeatInterval, int subRepeatCount)
+{
+    spec[QStringLiteral("recurrence")]        = recurrence;
+    spec[QStringLiteral("subRepeatInterval")] = subRepeatInterval;
+    spec[QStringLiteral("subRepeatCount")]    = subRepeatCount;
+}
+
+void setRecurrenceSpec(QVariantMap& spec, int recurType, int recurInterval, int recurCount)
+{
+    spec[QStringLiteral("recurType")]     = recurType;
+    spec[QStringLiteral("recurInterval")] = recurInterval;
+    spec[QStringLiteral("recurCount")]    = recurCount;
+}
+
+void setRecurrenceSpec(QVariantMap& spec, int recurType, int recurInterval, const QString& endDateTime)
+{
+    spec[QStringLiteral("recurType")]     = recurType;
+    spec[QStringLiteral("recurInterval")] = recurInterval;
+    spec[QStringLiteral("endDateTime")]   = endDateTime;
+}
+
+/******************************************************************************
+* Log a parameter error, and return it to the caller if 'error' is non-null.
+*/
+void reportError(QString* error, const QString& message)
+{
+    qCCritical(KALARM_LOG) << "D-Bus call:" << message;
+    if (error)
+        *error = message;
+}
+
+}
+
 #include "moc_dbushandler.cpp"
 
 // vim: et sw=4:
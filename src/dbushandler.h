@@ -122,33 +122,26 @@ public Q_SLOTS:
     Q_SCRIPTABLE bool scheduleAudio(const QString& audioUrl, int volumePercent, const QString& startDateTime, int lateCancel,
                                     unsigned flags, int recurType, int recurInterval, const QString& endDateTime);
 
+    // Create a list of alarms, saving them together. If any alarm specification
+    // is invalid, no alarms are created. Otherwise, alarms which the calendar
+    // fails to add are reported in 'errors', but the others remain scheduled.
+    Q_SCRIPTABLE bool scheduleBatch(const QList<QVariantMap>& alarms, QStringList& eventIds, QStringList& errors);
+
     // Edit an alarm.
     Q_SCRIPTABLE bool edit(const QString& eventID);
     Q_SCRIPTABLE bool editNew(int type);
     Q_SCRIPTABLE bool editNew(const QString& templateName);
 
 private:
-    static bool scheduleMessage(const QString& name, const QString& message, const KADateTime& start, int lateCancel, unsigned flags,
-                                const QString& bgColor, const QString& fgColor, const QString& fontStr,
-                                const QUrl& audioFile, int reminderMins, const KARecurrence&,
-                                const KCalendarCore::Duration& subRepeatDuration = KCalendarCore::Duration(0), int subRepeatCount = 0);
-    static bool scheduleFile(const QString& name, const QUrl& file, const KADateTime& start, int lateCancel, unsigned flags, const QString& bgColor,
-                             const QUrl& audioFile, int reminderMins, const KARecurrence&,
-                             const KCalendarCore::Duration& subRepeatDuration = KCalendarCore::Duration(0), int subRepeatCount = 0);
-    static bool scheduleCommand(const QString& name, const QString& commandLine, const KADateTime& start, int lateCancel, unsigned flags,
-                                const KARecurrence&, const KCalendarCore::Duration& subRepeatDuration = KCalendarCore::Duration(0), int subRepeatCount = 0);
-    static bool scheduleEmail(const QString& name, const QString& fromID, const QString& addresses, const QString& subject, const QString& message,
-                              const QString& attachments, const KADateTime& start, int lateCancel, unsigned flags,
-                              const KARecurrence&, const KCalendarCore::Duration& subRepeatDuration = KCalendarCore::Duration(0), int subRepeatCount = 0);
-    static bool scheduleAudio(const QString& name, const QString& audioUrl, int volumePercent, const KADateTime& start, int lateCancel, unsigned flags,
-                              const KARecurrence&, const KCalendarCore::Duration& subRepeatDuration = KCalendarCore::Duration(0), int subRepeatCount = 0);
-    static KADateTime convertDateTime(const QString& dateTime, const KADateTime& = KADateTime());
+    static bool      scheduleAlarm(const QVariantMap& spec);
+    static KAEvent   createEvent(const QVariantMap& spec, QString& error);
+    static KADateTime convertDateTime(const QString& dateTime, QString* error, const KADateTime& = KADateTime());
     static KAEvent::Flags convertStartFlags(const KADateTime& start, unsigned flags);
-    static QColor    convertBgColour(const QString& bgColor);
-    static bool      convertRecurrence(KADateTime& start, KARecurrence&, const QString& startDateTime, const QString& icalRecurrence, int subRepeatInterval, KCalendarCore::Duration& subRepeatDuration);
-    static bool      convertRecurrence(KADateTime& start, KARecurrence&, const QString& startDateTime, int recurType, int recurInterval, int recurCount);
-    static bool      convertRecurrence(KADateTime& start, KARecurrence&, const QString& startDateTime, int recurType, int recurInterval, const QString& endDateTime);
-    static bool      convertRecurrence(KARecurrence&, const KADateTime& start, int recurType, int recurInterval, int recurCount, const KADateTime& end);
+    static QColor    convertBgColour(const QString& bgColor, QString* error);
+    static bool      convertRecurrence(KADateTime& start, KARecurrence&, const QString& startDateTime, const QString& icalRecurrence, int subRepeatInterval, KCalendarCore::Duration& subRepeatDuration, QString* error);
+    static bool      convertRecurrence(KADateTime& start, KARecurrence&, const QString& startDateTime, int recurType, int recurInterval, int recurCount, QString* error);
+    static bool      convertRecurrence(KADateTime& start, KARecurrence&, const QString& startDateTime, int recurType, int recurInterval, const QString& endDateTime, QString* error);
+    static bool      convertRecurrence(KARecurrence&, const KADateTime& start, int recurType, int recurInterval, int recurCount, const KADateTime& end, QString* error);
 };
 
 // vim: et sw=4:
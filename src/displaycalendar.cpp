@@ -18,8 +18,10 @@
 
 #include <KLocalizedString>
 
+#include <QCoreApplication>
 #include <QStandardPaths>
 #include <QDir>
+#include <QTimer>
 
 using namespace KCalendarCore;
 using namespace KAlarmCal;
@@ -40,6 +42,7 @@ QString                         DisplayCalendar::mDisplayCalPath;
 QString                         DisplayCalendar::mDisplayICalPath;
 DisplayCalendar::CalType        DisplayCalendar::mCalType;
 bool                            DisplayCalendar::mOpen {false};
+bool                            DisplayCalendar::mSavePending {false};
 
 
 /******************************************************************************
@@ -55,6 +58,9 @@ void DisplayCalendar::initialise()
     mDisplayICalPath = mDisplayCalPath;
     mDisplayICalPath.replace(QStringLiteral("\\.vcs$"), QStringLiteral(".ics"));
     mCalType = (mDisplayCalPath == mDisplayICalPath) ? LOCAL_ICAL : LOCAL_VCAL;    // is the calendar in ICal or VCal format?
+    // Write any pending save however the application quits, since the
+    // calendar is needed to redisplay alarms after the next start.
+    QObject::connect(qApp, &QCoreApplication::aboutToQuit, qApp, &DisplayCalendar::savePending);
     mInitialised = true;
 }
 
@@ -140,11 +146,37 @@ int DisplayCalendar::load()
 }
 
 /******************************************************************************
-* Save the calendar.
+* Schedule the calendar to be saved.
+* The save is done once control returns to the event loop, so that multiple
+* changes made together (e.g. when many alarms are displayed at the same time)
+* result in only a single write of the calendar file. The save is never delayed
+* beyond the current event loop pass, and a pending save is also written when
+* the application is about to quit.
+* Note that the calendar has not been written when this method returns, so the
+* reply only indicates whether a save is pending. Any error in writing the file
+* is reported to the user by saveCal() when the save is done.
+* Reply = true if a save is pending,
+*       = false if the calendar is not open.
 */
 bool DisplayCalendar::save()
 {
-    return saveCal();
+    if (!mCalendarStorage  ||  !mOpen)
+        return false;
+    if (!mSavePending)
+    {
+        mSavePending = true;
+        QTimer::singleShot(0, &DisplayCalendar::savePending);   //NOLINT(clang-analyzer-cplusplus.NewDeleteLeaks)
+    }
+    return true;
+}
+
+/******************************************************************************
+* Save the calendar if a save has been scheduled and not yet done.
+*/
+void DisplayCalendar::savePending()
+{
+    if (mSavePending)
+        saveCal();
 }
 
 /******************************************************************************
@@ -157,6 +189,7 @@ bool DisplayCalendar::saveCal(const QString& newFile)
         return false;
     if (!mOpen  &&  newFile.isEmpty())
         return false;
+    mSavePending = false;
 
     qCDebug(KALARM_LOG) << "DisplayCalendar::saveCal:" << "\"" << newFile;
     QString saveFilename = newFile.isEmpty() ? mDisplayCalPath : newFile;
@@ -186,6 +219,8 @@ bool DisplayCalendar::saveCal(const QString& newFile)
 */
 void DisplayCalendar::close()
 {
+    savePending();   // write any changes which have not yet been saved
+    mSavePending = false;
     if (mCalendarStorage)
     {
         mCalendarStorage->calendar().reset();
@@ -296,7 +331,7 @@ bool DisplayCalendar::addEvent(KAEvent& evnt)
 
 /******************************************************************************
 * Delete the specified event from the calendar, if it exists.
-* The calendar is then optionally saved.
+* The calendar is then optionally scheduled to be saved; see save().
 */
 bool DisplayCalendar::deleteEvent(const QString& eventID, bool saveit)
 {
@@ -331,7 +366,7 @@ bool DisplayCalendar::deleteEvent(const QString& eventID, bool saveit)
         if (status != CalEvent::EMPTY)
         {
             if (saveit)
-                return saveCal();
+                return save();
             return true;
         }
     }
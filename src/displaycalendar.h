@@ -43,6 +43,7 @@ private:
     static int                        load();
     static void                       close();
     static bool                       saveCal(const QString& newFile = QString());
+    static void                       savePending();
     static bool                       isValid()    { return !mCalendarStorage.isNull(); }
     static void                       updateKAEvents();
 
@@ -54,6 +55,7 @@ private:
     static QString                    mDisplayICalPath;    // path of display iCalendar file
     static CalType                    mCalType;            // mCalendar's type (ical/vcal)
     static bool                       mOpen;               // true if the calendar file is open
+    static bool                       mSavePending;        // true if a save has been scheduled
 };
 
 // vim: et sw=4:
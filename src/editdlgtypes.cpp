@@ -1263,7 +1263,11 @@ void EditEmailAlarmDlg::type_initValues(const KAEvent& event)
     if (event.isValid())
     {
         // Set the values to those for the specified event
-        mEmailAttachList->addItems(event.emailAttachments());
+        const QStringList attachments = event.emailAttachments();
+        mEmailAttachList->addItems(attachments);
+        // Check remote attachments in the background, ready for validation.
+        for (const QString& att : attachments)
+            KAMail::checkAttachmentAsync(att, this);
         mEmailToEdit->setText(event.emailAddresses(QStringLiteral(", ")));
         mEmailSubjectEdit->setText(event.emailSubject());
         mEmailBcc->setChecked(event.emailBcc());
@@ -1321,6 +1325,8 @@ void EditEmailAlarmDlg::setEmailFields(uint fromID, const KCalendarCore::Person:
     if (!attachments.isEmpty())
     {
         mEmailAttachList->addItems(attachments);
+        for (const QString& att : attachments)
+            KAMail::checkAttachmentAsync(att, this);
         attachmentEnable();
     }
 }
@@ -1525,6 +1531,7 @@ void EditEmailAlarmDlg::slotAddAttachment()
         if (!file.isEmpty())
         {
             mEmailAttachList->addItem(file);
+            KAMail::checkAttachmentAsync(file, this);
             mEmailAttachList->setCurrentIndex(mEmailAttachList->count() - 1);   // select the new item
             mEmailRemoveButton->setEnabled(true);
             mEmailAttachList->setEnabled(true);
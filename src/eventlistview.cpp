@@ -29,6 +29,7 @@ EventListView::EventListView(QWidget* parent)
     setSelectionMode(ExtendedSelection);
     setSelectionBehavior(SelectRows);
     setTextElideMode(Qt::ElideRight);
+    setUniformRowHeights(true);   // all rows are single line, so avoid measuring each row
     // Set default WhatsThis text to be displayed when no actual item is clicked on
     setWhatsThis(i18nc("@info:whatsthis", "List of scheduled alarms"));
     header()->setSortIndicatorShown(true);
@@ -172,16 +173,15 @@ bool EventListView::viewportEvent(QEvent* e)
             int i = toolTip.indexOf(QLatin1Char('\n'));
             if (i < 0)
             {
-                auto m = qobject_cast<EventListModel*>(model());
                 if (index.column() == ResourceDataModelBase::TextColumn
                 ||  index.column() == ResourceDataModelBase::NameColumn
-                ||  !m  ||  m->event(index).commandError() == KAEvent::CmdErr::None)
+                ||  static_cast<KAEvent::CmdErr>(index.data(ResourceDataModelBase::CommandErrorRole).toInt()) == KAEvent::CmdErr::None)
                 {
                     // Single line tooltip. Only display it if the text column
                     // is truncated in the view display.
                     value = model()->data(index, Qt::FontRole);
-                    const QFontMetrics fm(qvariant_cast<QFont>(value).resolve(listViewOptions().font));
-                    const int textWidth = fm.boundingRect(toolTip).width() + 1;
+                    const QFontMetrics fm(qvariant_cast<QFont>(value).resolve(font()));
+                    const int textWidth = fm.horizontalAdvance(toolTip) + 1;
                     const int margin = QApplication::style()->pixelMetric(QStyle::PM_FocusFrameHMargin) + 1;
                     const int left = columnViewportPosition(index.column()) + margin;
                     const int right = left + textWidth;
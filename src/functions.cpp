@@ -32,7 +32,6 @@
 #include <KCalendarCore/ICalFormat>
 #include <KCalendarCore/Person>
 #include <KCalendarCore/Duration>
-#include <KCalendarCore/MemoryCalendar>
 using namespace KCalendarCore;
 #include <KIdentityManagementCore/IdentityManager>
 #include <KIdentityManagementCore/Identity>
@@ -47,10 +46,6 @@ using namespace KCalendarCore;
 #include <KAuth/ExecuteJob>
 #endif
 #include <KStandardShortcut>
-#include <KFileItem>
-#include <KJobWidgets>
-#include <KIO/StatJob>
-#include <KIO/StoredTransferJob>
 #include <KFileCustomDialog>
 #include <KWindowSystem>
 #if ENABLE_X11
@@ -65,7 +60,6 @@ using namespace KCalendarCore;
 #include <QMimeData>
 #include <QStandardPaths>
 #include <QPushButton>
-#include <QTemporaryFile>
 
 //clazy:excludeall=non-pod-global-static
 
@@ -296,22 +290,27 @@ UpdateResult addEvents(QList<KAEvent>& events, Resource& resource, QWidget* msgP
         }
         else
         {
+            // Save the event details in the calendar file, and get the new event IDs.
+            // The events are all added before the resource is saved, so that
+            // they are notified together and the calendar is written only once.
+            QList<int> failed;
+            ResourcesCalendar::addEvents(events, resource, msgParent, ResourcesCalendar::NoOption, failed);
+            int f = 0;
             for (int i = 0, end = events.count();  i < end;  ++i)
             {
-                // Save the event details in the calendar file, and get the new event ID
-                KAEvent& event = events[i];
-                if (!ResourcesCalendar::addEvent(event, resource, msgParent))
+                if (f < failed.count()  &&  failed[f] == i)
                 {
+                    ++f;
                     status.appendFailed(i);
                     status.setError(UPDATE_ERROR);
                     continue;
                 }
+                const KAEvent& event = events[i];
                 if (allowKOrgUpdate  &&  event.copyToKOrganizer())
                 {
                     UpdateResult st = sendToKOrganizer(event);    // tell KOrganizer to show the event
                     status.korgUpdate(st);
                 }
-
             }
             if (status.failedCount() == events.count())
                 status.status = UPDATE_FAILED;
@@ -800,18 +799,12 @@ void purgeArchive(int purgeDays)
     if (purgeDays < 0)
         return;
     qCDebug(KALARM_LOG) << "KAlarm::purgeArchive:" << purgeDays;
-    const QDate cutoff = KADateTime::currentLocalDate().addDays(-purgeDays);
+    const QDate cutoff = purgeDays ? KADateTime::currentLocalDate().addDays(-purgeDays) : QDate();
     const Resource resource = Resources::getStandard(CalEvent::ARCHIVED, true);
     if (!resource.isValid())
         return;
-    QList<KAEvent> events = ResourcesCalendar::events(resource);
-    for (int i = 0;  i < events.count();  )
-    {
-        if (purgeDays  &&  events.at(i).createdDateTime().date() >= cutoff)
-            events.remove(i);
-        else
-            ++i;
-    }
+    // Fetch only the expired events, using the resource's creation date index.
+    const QList<KAEvent> events = resource.archivedEvents(cutoff);
     if (!events.isEmpty())
         ResourcesCalendar::purgeEvents(events);   // delete the events and save the calendar
 }
@@ -888,38 +881,9 @@ bool importAlarms(Resource& resource, QWidget* parent)
 
     const CalEvent::Types alarmTypes = resource.isValid() ? resource.alarmTypes() : CalEvent::ACTIVE | CalEvent::ARCHIVED | CalEvent::TEMPLATE;
 
-    // Read all the selected calendar files and extract their alarms.
-    QHash<CalEvent::Type, QList<KAEvent>> events;
-    for (const QUrl& url : urls)
-    {
-        if (!url.isValid())
-        {
-            qCDebug(KALARM_LOG) << "KAlarm::importAlarms: Invalid URL";
-            continue;
-        }
-        qCDebug(KALARM_LOG) << "KAlarm::importAlarms:" << url.toDisplayString();
-        importCalendarFile(url, alarmTypes, true, parent, events);
-    }
-    if (events.isEmpty())
-        return false;
-
-    // Add the alarms to the destination resource.
-    bool success = true;
-    for (auto it = events.constBegin();  it != events.constEnd();  ++it)
-    {
-        Resource res;
-        if (resource.isValid())
-            res = resource;
-        else
-            res = Resources::destination(it.key());
-
-        for (const KAEvent& event : std::as_const(it.value()))
-        {
-            if (!res.addEvent(event))
-                success = false;
-        }
-    }
-    return success;
+    // Read all the selected calendar files and add their alarms to the
+    // destination resources, a batch at a time.
+    return importCalendarFiles(urls, alarmTypes, resource, parent);
 }
 
 /******************************************************************************
@@ -946,78 +910,7 @@ bool exportAlarms(const QList<KAEvent>& events, QWidget* parent)
     }
     lastExportUrl = url.adjusted(QUrl::RemoveFilename);
     qCDebug(KALARM_LOG) << "KAlarm::exportAlarms:" << url.toDisplayString();
-
-    MemoryCalendar::Ptr calendar(new MemoryCalendar(Preferences::timeSpecAsZone()));
-    FileStorage::Ptr calStorage(new FileStorage(calendar, file));
-    if (append  &&  !calStorage->load())
-    {
-        auto statJob = KIO::stat(url, KIO::StatJob::SourceSide, KIO::StatDetail::StatDefaultDetails);
-        KJobWidgets::setWindow(statJob, parent);
-        statJob->exec();
-        KFileItem fi(statJob->statResult(), url);
-        if (fi.size())
-        {
-            qCCritical(KALARM_LOG) << "KAlarm::exportAlarms: Error loading calendar file" << file << "for append";
-            KAMessageBox::error(MainWindow::mainMainWindow(),
-                                xi18nc("@info", "Error loading calendar to append to:<nl/><filename>%1</filename>", url.toDisplayString()));
-            return false;
-        }
-    }
-    KACalendar::setKAlarmVersion(calendar);
-
-    // Add the alarms to the calendar
-    bool success = true;
-    bool exported = false;
-    for (const KAEvent& event : events)
-    {
-        Event::Ptr kcalEvent(new Event);
-        const CalEvent::Type type = event.category();
-        const QString id = CalEvent::uid(kcalEvent->uid(), type);
-        kcalEvent->setUid(id);
-        event.updateKCalEvent(kcalEvent, KAEvent::UidAction::Ignore);
-        if (calendar->addEvent(kcalEvent))
-            exported = true;
-        else
-            success = false;
-    }
-
-    if (exported)
-    {
-        // One or more alarms have been exported to the calendar.
-        // Save the calendar to file.
-        QTemporaryFile* tempFile = nullptr;
-        bool local = url.isLocalFile();
-        if (!local)
-        {
-            tempFile = new QTemporaryFile;
-            file = tempFile->fileName();
-        }
-        calStorage->setFileName(file);
-        calStorage->setSaveFormat(new ICalFormat);
-        if (!calStorage->save())
-        {
-            qCCritical(KALARM_LOG) << "KAlarm::exportAlarms:" << file << ": failed";
-            KAMessageBox::error(MainWindow::mainMainWindow(),
-                                xi18nc("@info", "Failed to save new calendar to:<nl/><filename>%1</filename>", url.toDisplayString()));
-            success = false;
-        }
-        else if (!local)
-        {
-            QFile qFile(file);
-            qFile.open(QIODevice::ReadOnly);
-            auto uploadJob = KIO::storedPut(&qFile, url, -1);
-            KJobWidgets::setWindow(uploadJob, parent);
-            if (!uploadJob->exec())
-            {
-                qCCritical(KALARM_LOG) << "KAlarm::exportAlarms:" << file << ": upload failed";
-                KAMessageBox::error(MainWindow::mainMainWindow(),
-                                    xi18nc("@info", "Cannot upload new calendar to:<nl/><filename>%1</filename>", url.toDisplayString()));
-                success = false;
-            }
-        }
-        delete tempFile;
-    }
-    return success;
+    return exportCalendarFile(events, url, append, parent);
 }
 
 /******************************************************************************
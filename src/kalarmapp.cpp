@@ -25,9 +25,11 @@
 #include "resources/datamodel.h"
 #include "resources/resources.h"
 #include "lib/desktop.h"
+#include "lib/logfilewriter.h"
 #include "lib/messagebox.h"
 #include "notifications_interface.h" // DBUS-generated
 #include "dbusproperties.h"          // DBUS-generated
+#include "kalarmcalendar/alarmtext.h"
 #include "kalarmcalendar/datetime.h"
 #include "kalarmcalendar/karecurrence.h"
 #include "kalarm_debug.h"
@@ -49,11 +51,15 @@
 #include <QStandardPaths>
 #include <QSystemTrayIcon>
 #include <QCommandLineParser>
+#include <QElapsedTimer>
 
 #include <stdlib.h>
 #include <ctype.h>
 #include <iostream>
 #include <climits>
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
 
 namespace
 {
@@ -64,6 +70,8 @@ const char FDO_NOTIFICATIONS_PATH[]    = "/org/freedesktop/Notifications";
 
 const QLatin1String GENERAL_GROUP("General");
 
+QElapsedTimer startupTimer;   // measures the time taken to start up
+
 /******************************************************************************
 * Find the maximum number of seconds late which a late-cancel alarm is allowed
 * to be. This is calculated as the late cancel interval, plus a few seconds
@@ -80,12 +88,34 @@ QWidget* mainWidget()
 {
     return MainWindow::mainMainWindow();
 }
+
+/******************************************************************************
+* Log the time taken to start up and load the calendars, and the peak memory
+* used, so that headless and GUI modes can be compared.
+* Note that headless mode still constructs a QApplication, so the widget and
+* platform plugin libraries are loaded in both modes.
+*/
+void logStartup(bool headless)
+{
+    static bool logged = false;
+    if (logged)
+        return;
+    logged = true;
+    long maxRss = -1;
+#ifdef Q_OS_UNIX
+    struct rusage usage;
+    if (!getrusage(RUSAGE_SELF, &usage))
+        maxRss = usage.ru_maxrss;
+#endif
+    qCInfo(KALARM_LOG) << "KAlarmApp: Started" << (headless ? "(headless)" : "(GUI)") << "in" << startupTimer.elapsed() << "ms; peak resident memory" << maxRss << "kB";
+}
 }
 
 
 KAlarmApp*  KAlarmApp::mInstance  = nullptr;
 int         KAlarmApp::mActiveCount = 0;
 int         KAlarmApp::mFatalError  = 0;
+bool        KAlarmApp::mHeadless    = false;
 QString     KAlarmApp::mFatalMessage;
 
 
@@ -103,12 +133,12 @@ KAlarmApp::KAlarmApp(int& argc, char** argv)
 */
 KAlarmApp::~KAlarmApp()
 {
-    while (!mCommandProcesses.isEmpty())
-    {
-        ProcData* pd = mCommandProcesses.at(0);
-        mCommandProcesses.pop_front();
-        delete pd;
-    }
+    const QList<ProcData*> procs = mCommandProcesses.values();
+    mCommandProcesses.clear();
+    mCommandEvents.clear();
+    mCommandBacklog.clear();
+    qDeleteAll(procs);
+    LogFileWriter::terminate();
     ResourcesCalendar::terminate();
     DisplayCalendar::terminate();
     DataModel::terminate();
@@ -123,6 +153,25 @@ KAlarmApp* KAlarmApp::create(int& argc, char** argv)
 {
     if (!mInstance)
     {
+        startupTimer.start();
+
+        // Check for headless mode, which must be known before the application
+        // is constructed. In headless mode no windows are displayed, so don't
+        // require a display server.
+        for (int i = 1;  i < argc;  ++i)
+        {
+            const QByteArray arg(argv[i]);
+            if (arg == "--headless")
+            {
+                mHeadless = true;
+                if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+                    qputenv("QT_QPA_PLATFORM", "offscreen");
+                break;
+            }
+            if (arg == "-e"  ||  arg == "--exec"  ||  arg == "-E"  ||  arg == "--exec-display")
+                break;   // following arguments belong to the command
+        }
+
         mInstance = new KAlarmApp(argc, argv);
 
         if (mFatalError)
@@ -189,6 +238,8 @@ void KAlarmApp::initialise()
                  this, &KAlarmApp::slotResourcesCreated);
     connect(resources, &Resources::resourcesPopulated,
                  this, &KAlarmApp::processQueue);
+    connect(resources, &Resources::resourcesPopulated,
+                 this, []() { logStartup(mHeadless); });
 
     initialiseTimerResources();   // initialise calendars and alarm timer
 
@@ -200,7 +251,8 @@ void KAlarmApp::initialise()
 
     // Get notified when the Freedesktop notifications properties have changed.
     QDBusConnection conn = QDBusConnection::sessionBus();
-    if (conn.interface()->isServiceRegistered(QString::fromLatin1(FDO_NOTIFICATIONS_SERVICE)))
+    mNotificationsAvailable = conn.interface()->isServiceRegistered(QString::fromLatin1(FDO_NOTIFICATIONS_SERVICE));
+    if (mNotificationsAvailable)
     {
         OrgFreedesktopDBusPropertiesInterface* piface = new OrgFreedesktopDBusPropertiesInterface(
                 QString::fromLatin1(FDO_NOTIFICATIONS_SERVICE),
@@ -441,6 +493,39 @@ int KAlarmApp::activateInstance(const QStringList& args, const QString& workingD
                 break;
         }
 
+        if (mHeadless)
+        {
+            switch (command)
+            {
+                case CommandOptions::EDIT:
+                case CommandOptions::EDIT_NEW:
+                case CommandOptions::EDIT_NEW_PRESET:
+                {
+                    // Dialogs can't be used in headless mode.
+                    const QString error = xi18nc("@info:shell", "<icode>%1</icode>: option not available in headless mode", options->commandName());
+                    Q_EMIT setExitValue(1);
+                    if (outputText)
+                    {
+                        // Instance was activated from main().
+                        *outputText = error;
+                        delete options;
+                        return 1;
+                    }
+                    // Instance was activated by DBus.
+                    std::cerr << qPrintable(error) << std::endl;
+                    exitCode = 1;
+                    command = CommandOptions::CMD_ERROR;
+                    break;
+                }
+                case CommandOptions::TRAY:
+                case CommandOptions::NONE:
+                    command = CommandOptions::HEADLESS;   // don't display any windows
+                    break;
+                default:
+                    break;
+            }
+        }
+
         switch (command)
         {
             case CommandOptions::TRIGGER_EVENT:
@@ -638,6 +723,12 @@ int KAlarmApp::activateInstance(const QStringList& args, const QString& workingD
                 }
                 break;
 
+            case CommandOptions::HEADLESS:
+                // Run alarms without displaying any windows
+                if (!initCheck())   // open the calendar, start processing execution queue
+                    exitCode = 1;
+                break;
+
             case CommandOptions::TRAY:
                 // Display only the system tray icon
                 if (Preferences::showInSystemTray()  &&  QSystemTrayIcon::isSystemTrayAvailable())
@@ -715,6 +806,8 @@ int KAlarmApp::activateInstance(const QStringList& args, const QString& workingD
 */
 void KAlarmApp::createOnlyMainWindow()
 {
+    if (mHeadless)
+        return;   // quitIf() prevents quitting in headless mode
     if (!MainWindow::count())
     {
         if (wantShowInSystemTray())
@@ -752,6 +845,8 @@ bool KAlarmApp::quitIf(int exitCode, bool force)
         mPendingQuit = false;
         if (mActiveCount > 0  ||  MessageDisplay::instanceCount(true))  // ignore always-hidden displays (e.g. audio alarms)
             return false;
+        if (mHeadless)
+            return false;   // keep running to process alarms, since there are no windows to close
         const int mwcount = MainWindow::count();
         MainWindow* mw = mwcount ? MainWindow::firstWindow() : nullptr;
         if (mwcount > 1  ||  (mwcount && (!mw->isHidden() || !mw->isTrayParent())))
@@ -881,7 +976,10 @@ void KAlarmApp::quitFatal()
             return;
         case 1:
             mFatalError = 2;
-            KMessageBox::error(nullptr, mFatalMessage);   // this is an application modal window
+            if (mHeadless)
+                qCCritical(KALARM_LOG) << "KAlarmApp:" << mFatalMessage;
+            else
+                KMessageBox::error(nullptr, mFatalMessage);   // this is an application modal window
             mFatalError = 3;
             [[fallthrough]];   // fall through to '3'
         case 3:
@@ -1418,7 +1516,7 @@ void KAlarmApp::slotResourcesCreated()
 * Called when all calendars have been fetched at startup, or calendar migration
 * has completed.
 * Check whether there are any writable active calendars, and if not, warn the
-* user.
+* user. In headless mode, the warning is only logged.
 */
 void KAlarmApp::checkWritableCalendar()
 {
@@ -1442,6 +1540,8 @@ void KAlarmApp::checkWritableCalendar()
     if (!active)
     {
         qCWarning(KALARM_LOG) << "KAlarmApp::checkWritableCalendar: No writable active calendar";
+        if (mHeadless)
+            return;   // nobody can dismiss a message box in headless mode
         KAMessageBox::information(MainWindow::mainMainWindow(),
                                   xi18nc("@info", "Alarms cannot be created or updated, because no writable active alarm calendar is enabled.<nl/><nl/>"
                                                  "To fix this, use <interface>View | Show Calendars</interface> to check or change calendar statuses."),
@@ -1503,6 +1603,7 @@ void KAlarmApp::slotEditAlarmById()
 /******************************************************************************
 * If alarms are being archived, check whether there is a default archived
 * calendar, and if not, warn the user.
+* In headless mode, the warning is only logged.
 */
 void KAlarmApp::promptArchivedCalendar()
 {
@@ -1510,6 +1611,8 @@ void KAlarmApp::promptArchivedCalendar()
     if (archived)
     {
         qCWarning(KALARM_LOG) << "KAlarmApp::checkArchivedCalendar: Archiving, but no writable archived calendar";
+        if (mHeadless)
+            return;
         KAMessageBox::information(MainWindow::mainMainWindow(),
                                   xi18nc("@info", "Alarms are configured to be archived, but this is not possible because no writable archived alarm calendar is enabled.<nl/><nl/>"
                                                  "To fix this, use <interface>View | Show Calendars</interface> to check or change calendar statuses."),
@@ -1518,6 +1621,8 @@ void KAlarmApp::promptArchivedCalendar()
     else
     {
         qCWarning(KALARM_LOG) << "KAlarmApp::checkArchivedCalendar: Archiving, but no standard archived calendar";
+        if (mHeadless)
+            return;
         KAMessageBox::information(MainWindow::mainMainWindow(),
                                   xi18nc("@info", "Alarms are configured to be archived, but this is not possible because no archived alarm calendar is set as default.<nl/><nl/>"
                                                  "To fix this, use <interface>View | Show Calendars</interface>, select an archived alarms calendar, and check <interface>Use as Default for Archived Alarms</interface>."),
@@ -1736,26 +1841,29 @@ bool KAlarmApp::scheduleEvent(QueuedAction queuedActionFlags,
         qCDebug(KALARM_LOG) << "KAlarmApp::scheduleEvent: not executed (late-cancel)" << text;
         return true;               // alarm time was already archived too long ago
     }
-    KADateTime alarmTime = dateTime;
-    // Round down to the nearest minute to avoid scheduling being messed up
-    if (!dateTime.isDateOnly())
-        alarmTime.setTime(QTime(alarmTime.time().hour(), alarmTime.time().minute(), 0));
+    KAEvent event = createEvent(action, name, text, dateTime, lateCancel, flags, bg, fg, font,
+                                audioFile, audioVolume, reminderMinutes, recurrence,
+                                repeatInterval, repeatCount,
+                                mailFromID, mailAddresses, mailSubject, mailAttachments);
+    return scheduleEvent(queuedActionFlags, event);
+}
 
-    KAEvent event(alarmTime, name, text, bg, fg, font, action, lateCancel, flags, true);
-    if (reminderMinutes)
+/******************************************************************************
+* Schedule a new alarm which has been created by createEvent().
+* If the alarm is already due, it is executed once, and then only added to the
+* calendar if it has future recurrences.
+* Reply = true unless the event is invalid.
+*/
+bool KAlarmApp::scheduleEvent(QueuedAction queuedActionFlags, KAEvent& event)
+{
+    if (!event.isValid())
     {
-        const bool onceOnly = flags & KAEvent::REMINDER_ONCE;
-        event.setReminder(reminderMinutes, onceOnly);
+        qCWarning(KALARM_LOG) << "KAlarmApp::scheduleEvent: Error! Invalid event";
+        return false;
     }
-    if (!audioFile.isEmpty())
-        event.setAudioFile(audioFile, audioVolume, -1, 0, (flags & KAEvent::REPEAT_SOUND) ? 0 : -1);
-    if (!mailAddresses.isEmpty())
-        event.setEmail(mailFromID, mailAddresses, mailSubject, mailAttachments);
-    event.setRecurrence(recurrence);
-    event.setFirstRecurrence();
-    event.setRepetition(Repetition(repeatInterval, repeatCount - 1));
-    event.endChanges();
-    if (alarmTime <= now)
+    const QString text = event.cleanText();
+    const KADateTime now = KADateTime::currentUtcDateTime();
+    if (event.startDateTime().effectiveKDateTime() <= now)
     {
         // Alarm is due for execution already.
         // First execute it once without adding it to the calendar file.
@@ -1779,6 +1887,133 @@ bool KAlarmApp::scheduleEvent(QueuedAction queuedActionFlags,
     return true;
 }
 
+/******************************************************************************
+* Create a new alarm from its parameters, without adding it to the calendar.
+* The alarm time is rounded down to the nearest minute.
+* Reply = the new event
+*       = invalid event if the alarm time is invalid, or if the alarm would be
+*         late-cancelled because its time has already passed.
+*/
+KAEvent KAlarmApp::createEvent(KAEvent::SubAction action, const QString& name, const QString& text,
+                               const KADateTime& dateTime, int lateCancel, KAEvent::Flags flags,
+                               const QColor& bg, const QColor& fg, const QFont& font,
+                               const QString& audioFile, float audioVolume, int reminderMinutes,
+                               const KARecurrence& recurrence, const KCalendarCore::Duration& repeatInterval, int repeatCount,
+                               uint mailFromID, const KCalendarCore::Person::List& mailAddresses,
+                               const QString& mailSubject, const QStringList& mailAttachments)
+{
+    if (!dateTime.isValid())
+        return {};
+    if (lateCancel  &&  dateTime < KADateTime::currentUtcDateTime().addSecs(-maxLateness(lateCancel)))
+        return {};                 // alarm time was already archived too long ago
+    KADateTime alarmTime = dateTime;
+    // Round down to the nearest minute to avoid scheduling being messed up
+    if (!dateTime.isDateOnly())
+        alarmTime.setTime(QTime(alarmTime.time().hour(), alarmTime.time().minute(), 0));
+
+    KAEvent event(alarmTime, name, text, bg, fg, font, action, lateCancel, flags, true);
+    if (reminderMinutes)
+    {
+        const bool onceOnly = flags & KAEvent::REMINDER_ONCE;
+        event.setReminder(reminderMinutes, onceOnly);
+    }
+    if (!audioFile.isEmpty())
+        event.setAudioFile(audioFile, audioVolume, -1, 0, (flags & KAEvent::REPEAT_SOUND) ? 0 : -1);
+    if (!mailAddresses.isEmpty())
+        event.setEmail(mailFromID, mailAddresses, mailSubject, mailAttachments);
+    event.setRecurrence(recurrence);
+    event.setFirstRecurrence();
+    event.setRepetition(Repetition(repeatInterval, repeatCount - 1));
+    event.endChanges();
+    return event;
+}
+
+/******************************************************************************
+* Called in response to a D-Bus request to schedule a batch of new alarms.
+* Alarms which are already due are executed once. All the alarms which still
+* have future occurrences are then added to the default calendar in a single
+* operation, so that the calendar is only saved once.
+* Invalid events in 'events' are alarms which have been late-cancelled; they
+* are ignored.
+* 'eventIds' is set to the ID of each new alarm, or empty if none was created.
+* 'errors' is set to an error message for each alarm, or empty if no error.
+* Reply = true if no errors occurred.
+*/
+bool KAlarmApp::scheduleEvents(QList<KAEvent>& events, QStringList& eventIds, QStringList& errors)
+{
+    qCDebug(KALARM_LOG) << "KAlarmApp::scheduleEvents:" << events.count();
+    const int count = events.count();
+    eventIds.fill(QString(), count);
+    errors.fill(QString(), count);
+    if (!mInitialised  ||  !Resources::allPopulated())
+    {
+        qCWarning(KALARM_LOG) << "KAlarmApp::scheduleEvents: Error! Calendars not yet loaded";
+        errors.fill(i18nc("@info", "Calendars have not yet been loaded"), count);
+        return false;
+    }
+    Resource resource = Resources::destination(CalEvent::ACTIVE, nullptr, Resources::NoResourcePrompt | Resources::UseOnlyResource);
+    if (!resource.isValid())
+    {
+        qCWarning(KALARM_LOG) << "KAlarmApp::scheduleEvents: Error! Cannot create alarms (no default calendar is defined)";
+        errors.fill(i18nc("@info", "No default calendar is defined"), count);
+        return false;
+    }
+
+    const KADateTime now = KADateTime::currentUtcDateTime();
+    QList<KAEvent> dueEvents;
+    QList<KAEvent> newEvents;
+    QList<int> indexes;     // index in 'events' of each item in 'newEvents'
+    for (int i = 0;  i < count;  ++i)
+    {
+        KAEvent& event = events[i];
+        if (!event.isValid())
+            continue;    // late-cancelled
+        if (event.startDateTime().effectiveKDateTime() <= now)
+        {
+            // Alarm is due for execution already. Execute it once without
+            // adding it to the calendar, once the other alarms have been added.
+            dueEvents += event;
+            // If it's a recurring alarm, reschedule it for its next occurrence
+            if (!event.recurs()
+            ||  event.setNextOccurrence(now) == KAEvent::OccurType::None)
+                continue;
+            // It has recurrences in the future
+        }
+        newEvents += event;
+        indexes += i;
+    }
+
+    bool ok = true;
+    if (!newEvents.isEmpty())
+    {
+        const KAlarm::UpdateResult result = KAlarm::addEvents(newEvents, resource, nullptr, true, false);
+        const bool allFailed = (result >= KAlarm::UPDATE_FAILED);
+        for (int j = 0, end = newEvents.count();  j < end;  ++j)
+        {
+            const int i = indexes[j];
+            if (allFailed  ||  result.failed.contains(j))
+            {
+                errors[i] = result.message.isEmpty() ? i18nc("@info", "Error creating alarm") : result.message;
+                ok = false;
+            }
+            else
+            {
+                events[i] = newEvents[j];
+                eventIds[i] = newEvents[j].id();
+            }
+        }
+    }
+
+    for (KAEvent& event : dueEvents)
+    {
+        if (execAlarm(event, event.firstAlarm()) == (void*)-2)
+            mActionQueue.enqueue(ActionQEntry(event, QueuedAction::Trigger));
+    }
+    if (!mActionQueue.isEmpty())
+        QTimer::singleShot(0, this, &KAlarmApp::processQueue);   //NOLINT(clang-analyzer-cplusplus.NewDeleteLeaks)
+    return ok;
+}
+
 /******************************************************************************
 * Called in response to a D-Bus request to trigger or cancel an event.
 * Optionally display the event. Delete the event from the calendar file and
@@ -2302,9 +2537,10 @@ void* KAlarmApp::execAlarm(KAEvent& event, const KAAlarm& alarm, ExecAlarmFlags
                 // NOTE: The pre-action is not executed for a recurring alarm if an
                 // alarm message window for a previous occurrence is still visible.
                 // Check whether the command is already being executed for this alarm.
-                for (const ProcData* pd : std::as_const(mCommandProcesses))
+                for (auto it = mCommandEvents.constFind(event.id());  it != mCommandEvents.constEnd() && it.key() == event.id();  ++it)
                 {
-                    if (pd->event->id() == event.id()  &&  (pd->flags & ProcData::PRE_ACTION))
+                    const ProcData* pd = it.value();
+                    if (pd->flags & ProcData::PRE_ACTION)
                     {
                         qCDebug(KALARM_LOG) << "KAlarmApp::execAlarm: Already executing pre-DISPLAY command";
                         return pd->process;   // already executing - don't duplicate the action
@@ -2339,7 +2575,16 @@ void* KAlarmApp::execAlarm(KAEvent& event, const KAAlarm& alarm, ExecAlarmFlags
                 const int mdFlags = (flags & Reschedule ? 0 : MessageDisplay::NoReschedule)
                                   | (flags & AllowDefer ? 0 : MessageDisplay::NoDefer)
                                   | (flags & NoRecordCmdError ? MessageDisplay::NoRecordCmdError : 0);
-                MessageDisplay::create(event, alarm, mdFlags)->showDisplay();
+                if (mHeadless  &&  !mNotificationsAvailable)
+                {
+                    // There is nowhere to display the alarm, so just log it.
+                    qCWarning(KALARM_LOG) << "KAlarmApp::execAlarm: Alarm" << event.id() << ":" << AlarmText::summary(event, 10);
+                    if (flags & Reschedule)
+                        rescheduleAlarm(event, alarm, true);
+                    alarmCompleted(event);
+                }
+                else
+                    MessageDisplay::create(event, alarm, mdFlags)->showDisplay();
             }
             else if (replaceReminder)
             {
@@ -2390,6 +2635,14 @@ void* KAlarmApp::execAlarm(KAEvent& event, const KAAlarm& alarm, ExecAlarmFlags
         }
         case KAAlarm::Action::Audio:
         {
+            if (mHeadless)
+            {
+                // Sounds are not played in headless mode.
+                qCDebug(KALARM_LOG) << "KAlarmApp::execAlarm: Headless mode: not playing audio alarm" << event.id();
+                if (flags & Reschedule)
+                    rescheduleAlarm(event, alarm, true);
+                return nullptr;
+            }
             // Play the sound, provided that the same event
             // isn't already playing
             MessageDisplay* disp = MessageDisplay::findEvent(EventId(event));
@@ -2518,11 +2771,12 @@ ShellProcess* KAlarmApp::doShellCommand(const QString& command, const KAEvent& e
             connect(proc, SIGNAL(receivedStdout(ShellProcess*)), receiver, slotOutput);
             connect(proc, SIGNAL(receivedStderr(ShellProcess*)), receiver, slotOutput);
         }
+        QString heading;
         if (mode == QIODevice::ReadWrite  &&  !event.logFile().isEmpty())
         {
             // Output is to be appended to a log file.
-            // Set up a logging process to write the command's output to.
-            QString heading;
+            // The command's output is written directly to the file by the
+            // system, and a heading is written before the command is started.
             if (alarm  &&  alarm->dateTime().isValid())
             {
                 const QString dateTime = alarm->dateTime().formatLocale();
@@ -2530,16 +2784,10 @@ ShellProcess* KAlarmApp::doShellCommand(const QString& command, const KAEvent& e
             }
             else
                 heading = QStringLiteral("\n******* KAlarm *******\n");
-            QFile logfile(event.logFile());
-            if (logfile.open(QIODevice::Append | QIODevice::Text))
-            {
-                QTextStream out(&logfile);
-                out << heading;
-                logfile.close();
-            }
             proc->setStandardOutputFile(event.logFile(), QIODevice::Append);
         }
         pd = new ProcData(proc, new KAEvent(event), (alarm ? new KAAlarm(*alarm) : nullptr), flags);
+        pd->logHeading = heading.toUtf8();
         if (flags & ProcData::TEMP_FILE)
             pd->tempFiles += command;
         if (!tmpXtermFile.isEmpty())
@@ -2549,8 +2797,19 @@ ShellProcess* KAlarmApp::doShellCommand(const QString& command, const KAEvent& e
             pd->exitReceiver = receiver;
             pd->exitMethod   = methodExited;
         }
-        mCommandProcesses.append(pd);
-        if (proc->start(mode))
+        pd->mode = mode;
+        addCommandProcess(pd);
+        if (!pd->execInXterm()  &&  !commandSlotAvailable())
+        {
+            // Too many commands are already running. Start this one when
+            // earlier commands have completed.
+            qCDebug(KALARM_LOG) << "KAlarmApp::doShellCommand: Queued," << mCommandBacklog.count() << "commands waiting";
+            pd->waitTimer.start();
+            pd->backlogIndex = ++mCommandBacklogLast;
+            mCommandBacklog.insert(pd->backlogIndex, pd);
+            return proc;
+        }
+        if (startCommandProcess(pd))
             return proc;
     }
 
@@ -2559,12 +2818,124 @@ ShellProcess* KAlarmApp::doShellCommand(const QString& command, const KAEvent& e
     commandErrorMsg(proc, event, alarm, flags);
     if (pd)
     {
-        mCommandProcesses.removeAt(mCommandProcesses.indexOf(pd));
+        removeCommandProcess(pd);
         delete pd;
     }
     return nullptr;
 }
 
+/******************************************************************************
+* Return whether another command process may be started now, without exceeding
+* the maximum number of concurrently executing commands.
+* Commands executed in a terminal window are not limited, since the terminal
+* window may remain open indefinitely.
+*/
+bool KAlarmApp::commandSlotAvailable() const
+{
+    const int maxConcurrent = Preferences::cmdMaxConcurrent();
+    if (maxConcurrent <= 0)
+        return true;    // no limit
+    const int running = mCommandProcesses.count() - mCommandBacklog.count() - mXtermCommandCount;
+    return running < maxConcurrent;
+}
+
+/******************************************************************************
+* Start commands which are waiting in the backlog, in the order in which they
+* were requested, as far as the maximum number of concurrent commands allows.
+*/
+void KAlarmApp::startQueuedCommands()
+{
+    while (!mCommandBacklog.isEmpty()  &&  commandSlotAvailable())
+    {
+        auto it = mCommandBacklog.begin();
+        ProcData* pd = it.value();
+        mCommandBacklog.erase(it);
+        pd->backlogIndex = 0;
+        const qint64 wait = pd->waitTimer.elapsed();
+        mCommandWaitTotal += wait;
+        ++mCommandWaitCount;
+        if (wait > mCommandWaitMax)
+            mCommandWaitMax = wait;
+        qCDebug(KALARM_LOG) << "KAlarmApp::startQueuedCommands:" << pd->event->id() << "waited" << wait << "ms (average"
+                            << mCommandWaitTotal / mCommandWaitCount << "ms, max" << mCommandWaitMax << "ms)";
+        if (commandLateCancelled(*pd))
+        {
+            // The alarm was already rescheduled when it triggered, so just
+            // notify the caller that the command was not run.
+            qCDebug(KALARM_LOG) << "KAlarmApp::startQueuedCommands:" << pd->event->id() << ": not executed (late-cancel)";
+            removeCommandProcess(pd);
+            if (pd->exitReceiver && !pd->exitMethod.isEmpty())
+                QMetaObject::invokeMethod(pd->exitReceiver, pd->exitMethod.constData(), Qt::DirectConnection, Q_ARG(ShellProcess::Status, pd->process->status()));
+            delete pd;
+            continue;
+        }
+        if (!startCommandProcess(pd))
+        {
+            // Process the error in the same way as if the command had exited.
+            qCWarning(KALARM_LOG) << "KAlarmApp::startQueuedCommands: Command failed to start";
+            slotCommandExited(pd->process);
+        }
+    }
+}
+
+/******************************************************************************
+* Start a command process. If the command's output is logged, the log file
+* heading is first written in the background, and the command is started once
+* that has completed, so that the heading precedes the command's output.
+* Reply = false if the command failed to start.
+*/
+bool KAlarmApp::startCommandProcess(ProcData* pd)
+{
+    if (!pd->logHeading.isEmpty())
+    {
+        // Use the process as the context, so that the callback is discarded if
+        // the process is deleted, even if another process is later created at
+        // the same address.
+        ShellProcess* proc = pd->process;
+        LogFileWriter::append(pd->event->logFile(), pd->logHeading, proc,
+                              [this, proc]() { slotCommandLogHeadingWritten(proc); });
+        return true;
+    }
+    return pd->process->start(pd->mode);
+}
+
+/******************************************************************************
+* Called when the log file heading for a command has been written.
+* Start the command.
+*/
+void KAlarmApp::slotCommandLogHeadingWritten(ShellProcess* proc)
+{
+    ProcData* pd = mCommandProcesses.value(proc);
+    if (!pd)
+        return;
+    pd->logHeading.clear();
+    if (!pd->process->start(pd->mode))
+    {
+        // Process the error in the same way as if the command had exited.
+        qCWarning(KALARM_LOG) << "KAlarmApp::slotCommandLogHeadingWritten: Command failed to start";
+        slotCommandExited(proc);
+    }
+}
+
+/******************************************************************************
+* Check whether a command which has been waiting in the backlog is now too late
+* to execute, according to its alarm's late-cancel setting.
+* Pre- and post-alarm actions, and commands whose output is displayed, are
+* never cancelled, since the remainder of the alarm depends on them.
+*/
+bool KAlarmApp::commandLateCancelled(const ProcData& pd)
+{
+    if (pd.flags & (ProcData::PRE_ACTION | ProcData::POST_ACTION | ProcData::DISP_OUTPUT))
+        return false;
+    const int lateCancel = pd.event->lateCancel();
+    if (!lateCancel  ||  !pd.alarm)
+        return false;
+    const DateTime alarmTime = pd.alarm->dateTime();
+    if (!alarmTime.isValid()  ||  alarmTime.isDateOnly())
+        return false;
+    return alarmTime.effectiveKDateTime() < KADateTime::currentUtcDateTime().addSecs(-maxLateness(lateCancel));
+}
+
 /******************************************************************************
 * Compose a command line to execute the given command in a terminal window.
 * 'tempScriptFile' receives the name of a temporary script file which is
@@ -2657,73 +3028,72 @@ void KAlarmApp::slotCommandExited(ShellProcess* proc)
 {
     qCDebug(KALARM_LOG) << "KAlarmApp::slotCommandExited";
     // Find this command in the command list
-    for (int i = 0, end = mCommandProcesses.count();  i < end;  ++i)
+    ProcData* pd = mCommandProcesses.value(proc);
+    if (pd)
     {
-        ProcData* pd = mCommandProcesses.at(i);
-        if (pd->process == proc)
+        // Found the command. Check its exit status.
+        bool executeAlarm = pd->preAction();
+        const ShellProcess::Status status = proc->status();
+        if (status == ShellProcess::Status::Success  &&  !proc->exitCode())
         {
-            // Found the command. Check its exit status.
-            bool executeAlarm = pd->preAction();
-            const ShellProcess::Status status = proc->status();
-            if (status == ShellProcess::Status::Success  &&  !proc->exitCode())
-            {
-                qCDebug(KALARM_LOG) << "KAlarmApp::slotCommandExited:" << pd->event->id() << ": SUCCESS";
-                clearEventCommandError(*pd->event, pd->preAction() ? KAEvent::CmdErr::Pre
-                                                 : pd->postAction() ? KAEvent::CmdErr::Post
-                                                 : KAEvent::CmdErr::Fail);
-            }
+            qCDebug(KALARM_LOG) << "KAlarmApp::slotCommandExited:" << pd->event->id() << ": SUCCESS";
+            clearEventCommandError(*pd->event, pd->preAction() ? KAEvent::CmdErr::Pre
+                                             : pd->postAction() ? KAEvent::CmdErr::Post
+                                             : KAEvent::CmdErr::Fail);
+        }
+        else
+        {
+            QString errmsg = proc->errorMessage();
+            if (status == ShellProcess::Status::Success  ||  status == ShellProcess::Status::NotFound)
+                qCWarning(KALARM_LOG) << "KAlarmApp::slotCommandExited:" << pd->event->id() << ":" << errmsg << "exit status =" << status << ", code =" << proc->exitCode();
             else
+                qCWarning(KALARM_LOG) << "KAlarmApp::slotCommandExited:" << pd->event->id() << ":" << errmsg << "exit status =" << status;
+            if (pd->messageBoxParent)
             {
-                QString errmsg = proc->errorMessage();
-                if (status == ShellProcess::Status::Success  ||  status == ShellProcess::Status::NotFound)
-                    qCWarning(KALARM_LOG) << "KAlarmApp::slotCommandExited:" << pd->event->id() << ":" << errmsg << "exit status =" << status << ", code =" << proc->exitCode();
-                else
-                    qCWarning(KALARM_LOG) << "KAlarmApp::slotCommandExited:" << pd->event->id() << ":" << errmsg << "exit status =" << status;
-                if (pd->messageBoxParent)
-                {
-                    // Close the existing informational KMessageBox for this process
-                    const QList<QDialog*> dialogs = pd->messageBoxParent->findChildren<QDialog*>();
-                    if (!dialogs.isEmpty())
-                        delete dialogs[0];
-                    setEventCommandError(*pd->event, pd->preAction() ? KAEvent::CmdErr::Pre
-                                                   : pd->postAction() ? KAEvent::CmdErr::Post
-                                                   : KAEvent::CmdErr::Fail);
-                    if (!pd->tempFile())
-                    {
-                        errmsg += QLatin1Char('\n');
-                        errmsg += proc->command();
-                    }
-                    KAMessageBox::error(pd->messageBoxParent, errmsg);
-                }
-                else
-                    commandErrorMsg(proc, *pd->event, pd->alarm, pd->flags);
-
-                if (executeAlarm
-                &&  (pd->event->extraActionOptions() & KAEvent::CancelOnPreActError))
+                // Close the existing informational KMessageBox for this process
+                const QList<QDialog*> dialogs = pd->messageBoxParent->findChildren<QDialog*>();
+                if (!dialogs.isEmpty())
+                    delete dialogs[0];
+                setEventCommandError(*pd->event, pd->preAction() ? KAEvent::CmdErr::Pre
+                                               : pd->postAction() ? KAEvent::CmdErr::Post
+                                               : KAEvent::CmdErr::Fail);
+                if (!pd->tempFile())
                 {
-                    qCDebug(KALARM_LOG) << "KAlarmApp::slotCommandExited:" << pd->event->id() << ": pre-action failed: cancelled";
-                    if (pd->reschedule())
-                        rescheduleAlarm(*pd->event, *pd->alarm, true);
-                    executeAlarm = false;
+                    errmsg += QLatin1Char('\n');
+                    errmsg += proc->command();
                 }
+                KAMessageBox::error(pd->messageBoxParent, errmsg);
             }
-            if (pd->preAction())
-                ResourcesCalendar::setAlarmPending(*pd->event, false);
-            if (executeAlarm)
+            else
+                commandErrorMsg(proc, *pd->event, pd->alarm, pd->flags);
+
+            if (executeAlarm
+            &&  (pd->event->extraActionOptions() & KAEvent::CancelOnPreActError))
             {
-                execAlarm(*pd->event, *pd->alarm,   (pd->reschedule()     ? Reschedule : NoExecFlag)
-                                                  | (pd->allowDefer()     ? AllowDefer : NoExecFlag)
-                                                  | (pd->noRecordCmdErr() ? NoRecordCmdError : NoExecFlag)
-                                                  | NoPreAction);
+                qCDebug(KALARM_LOG) << "KAlarmApp::slotCommandExited:" << pd->event->id() << ": pre-action failed: cancelled";
+                if (pd->reschedule())
+                    rescheduleAlarm(*pd->event, *pd->alarm, true);
+                executeAlarm = false;
             }
-            mCommandProcesses.removeAt(i);
-            if (pd->exitReceiver && !pd->exitMethod.isEmpty())
-                QMetaObject::invokeMethod(pd->exitReceiver, pd->exitMethod.constData(), Qt::DirectConnection, Q_ARG(ShellProcess::Status, status));
-            delete pd;
-            break;
         }
+        if (pd->preAction())
+            ResourcesCalendar::setAlarmPending(*pd->event, false);
+        if (executeAlarm)
+        {
+            execAlarm(*pd->event, *pd->alarm,   (pd->reschedule()     ? Reschedule : NoExecFlag)
+                                              | (pd->allowDefer()     ? AllowDefer : NoExecFlag)
+                                              | (pd->noRecordCmdErr() ? NoRecordCmdError : NoExecFlag)
+                                              | NoPreAction);
+        }
+        removeCommandProcess(pd);
+        if (pd->exitReceiver && !pd->exitMethod.isEmpty())
+            QMetaObject::invokeMethod(pd->exitReceiver, pd->exitMethod.constData(), Qt::DirectConnection, Q_ARG(ShellProcess::Status, status));
+        delete pd;
     }
 
+    // Start any commands which were waiting for this one to complete
+    startQueuedCommands();
+
     // If there are now no executing shell commands, quit if a quit was queued
     if (mPendingQuit  &&  mCommandProcesses.isEmpty())
         quitIf(mPendingQuitCode);
@@ -2783,14 +3153,9 @@ void KAlarmApp::commandErrorMsg(const ShellProcess* proc, const KAEvent& event,
 void KAlarmApp::commandMessage(ShellProcess* proc, QWidget* parent)
 {
     // Find this command in the command list
-    for (ProcData* pd : std::as_const(mCommandProcesses))
-    {
-        if (pd->process == proc)
-        {
-            pd->messageBoxParent = parent;
-            break;
-        }
-    }
+    ProcData* pd = mCommandProcesses.value(proc);
+    if (pd)
+        pd->messageBoxParent = parent;
 }
 
 /******************************************************************************
@@ -2886,16 +3251,42 @@ void KAlarmApp::clearEventCommandError(const KAEvent& event, KAEvent::CmdErr err
 }
 
 /******************************************************************************
-* Find the currently executing command process for an event ID, if any.
+* Find the command process for an event ID, if any. If there is more than one,
+* the oldest is returned.
 */
 KAlarmApp::ProcData* KAlarmApp::findCommandProcess(const QString& eventId) const
 {
-    for (ProcData* pd : std::as_const(mCommandProcesses))
+    // QMultiHash holds the values for a key in order from newest to oldest.
+    ProcData* pd = nullptr;
+    for (auto it = mCommandEvents.constFind(eventId);  it != mCommandEvents.constEnd() && it.key() == eventId;  ++it)
+        pd = it.value();
+    return pd;
+}
+
+/******************************************************************************
+* Add a command process to the lists of running or waiting processes.
+*/
+void KAlarmApp::addCommandProcess(ProcData* pd)
+{
+    mCommandProcesses.insert(pd->process, pd);
+    mCommandEvents.insert(pd->event->id(), pd);
+    if (pd->execInXterm())
+        ++mXtermCommandCount;
+}
+
+/******************************************************************************
+* Remove a command process from the lists of running or waiting processes.
+*/
+void KAlarmApp::removeCommandProcess(ProcData* pd)
+{
+    if (mCommandProcesses.remove(pd->process)  &&  pd->execInXterm())
+        --mXtermCommandCount;
+    mCommandEvents.remove(pd->event->id(), pd);
+    if (pd->backlogIndex)
     {
-        if (pd->event->id() == eventId)
-            return pd;
+        mCommandBacklog.remove(pd->backlogIndex);
+        pd->backlogIndex = 0;
     }
-    return nullptr;
 }
 
 
@@ -15,6 +15,9 @@
 #include "kalarmcalendar/kaevent.h"
 
 #include <QApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMap>
 #include <QPointer>
 #include <QQueue>
 
@@ -59,6 +62,11 @@ public:
     /** Return the unique instance. */
     static KAlarmApp*  instance()                      { return mInstance; }
 
+    /** Return whether the application is running in headless mode, i.e.
+     *  scheduling alarms without displaying any windows.
+     */
+    static bool        headless()                      { return mHeadless; }
+
     bool               checkCalendar()                 { return initCheck(); }
     bool               wantShowInSystemTray() const;
     bool               alarmsEnabled() const           { return mAlarmsEnabled; }
@@ -90,21 +98,17 @@ public:
     bool               windowFocusBroken() const;
     bool               needWindowFocusFix() const;
     // Methods called indirectly by the D-Bus interface
-    bool               scheduleEvent(KAEvent::SubAction subAction, const QString& name, const QString& text,
-                                     const KADateTime& dt, int lateCancel, KAEvent::Flags flags,
-                                     const QColor& bg, const QColor& fg, const QFont& font,
-                                     const QString& audioFile, float audioVolume,
-                                     int reminderMinutes, const KARecurrence& recurrence,
-                                     const KCalendarCore::Duration& repeatInterval, int repeatCount,
-                                     uint mailFromID = 0, const KCalendarCore::Person::List& mailAddresses = KCalendarCore::Person::List(),
-                                     const QString& mailSubject = QString(),
-                                     const QStringList& mailAttachments = QStringList())
-    { return scheduleEvent(QueuedAction::NoAction,
-                           subAction, name, text, dt, lateCancel, flags,
-                           bg, fg, font, audioFile, audioVolume,
-                           reminderMinutes, recurrence, repeatInterval, repeatCount,
-                           mailFromID, mailAddresses, mailSubject, mailAttachments);
-    }
+    bool               scheduleEvent(KAEvent& event)  { return scheduleEvent(QueuedAction::NoAction, event); }
+    bool               scheduleEvents(QList<KAEvent>& events, QStringList& eventIds, QStringList& errors);
+    static KAEvent     createEvent(KAEvent::SubAction subAction, const QString& name, const QString& text,
+                                   const KADateTime& dt, int lateCancel, KAEvent::Flags flags,
+                                   const QColor& bg, const QColor& fg, const QFont& font,
+                                   const QString& audioFile, float audioVolume,
+                                   int reminderMinutes, const KARecurrence& recurrence,
+                                   const KCalendarCore::Duration& repeatInterval, int repeatCount,
+                                   uint mailFromID = 0, const KCalendarCore::Person::List& mailAddresses = KCalendarCore::Person::List(),
+                                   const QString& mailSubject = QString(),
+                                   const QStringList& mailAttachments = QStringList());
     bool               dbusTriggerEvent(const EventId& eventID)   { return dbusHandleEvent(eventID, QueuedAction::Trigger); }
     bool               dbusDeleteEvent(const EventId& eventID)    { return dbusHandleEvent(eventID, QueuedAction::Cancel); }
     QString            dbusList();
@@ -150,6 +154,7 @@ private Q_SLOTS:
     void               slotResourcePopulated(const Resource&);
     void               slotPurge()                     { purge(mArchivedPurgeDays); }
     void               slotCommandExited(ShellProcess*);
+    void               slotCommandLogHeadingWritten(ShellProcess*);
     void               slotFDOPropertiesChanged(const QString& interface,
                                                 const QVariantMap& changedProperties,
                                                 const QStringList& invalidatedProperties);
@@ -202,6 +207,10 @@ private:
         QByteArray        exitMethod;
         QPointer<QWidget> messageBoxParent;
         QStringList       tempFiles;
+        QByteArray        logHeading;       // heading to write to log file before starting command
+        QElapsedTimer     waitTimer;        // time since the command was queued to start
+        quint64           backlogIndex {0}; // key in mCommandBacklog, or 0 if not waiting to start
+        QIODevice::OpenMode mode {QIODevice::ReadWrite};
         int               flags;
         bool              eventDeleted {false};
     };
@@ -240,6 +249,7 @@ private:
                                      uint mailFromID = 0, const KCalendarCore::Person::List& mailAddresses = KCalendarCore::Person::List(),
                                      const QString& mailSubject = QString(),
                                      const QStringList& mailAttachments = QStringList());
+    bool               scheduleEvent(QueuedAction queuedActionFlags, KAEvent&);
     int                handleEvent(const EventId&, QueuedAction, bool findUniqueId = false);
     int                rescheduleAlarm(KAEvent&, const KAAlarm&, bool updateCalAndDisplay,
                                        const KADateTime& nextDt = KADateTime());
@@ -258,10 +268,17 @@ private:
     void               setEventCommandError(const KAEvent&, KAEvent::CmdErr) const;
     void               clearEventCommandError(const KAEvent&, KAEvent::CmdErr) const;
     ProcData*          findCommandProcess(const QString& eventId) const;
+    void               addCommandProcess(ProcData*);
+    void               removeCommandProcess(ProcData*);
+    bool               commandSlotAvailable() const;
+    void               startQueuedCommands();
+    bool               startCommandProcess(ProcData*);
+    static bool        commandLateCancelled(const ProcData&);
 
     static KAlarmApp*  mInstance;               // the one and only KAlarmApp instance
     static int         mActiveCount;            // number of active instances without main windows
     static int         mFatalError;             // a fatal error has occurred - just wait to exit
+    static bool        mHeadless;               // running without displaying any windows
     static QString     mFatalMessage;           // fatal error message to output
     QString            mCommandOption;          // command option used on command line
     bool               mInitialised {false};    // initialisation complete: ready to process execution queue
@@ -276,7 +293,14 @@ private:
     int                mArchivedPurgeDays {-1}; // how long to keep archived alarms, 0 = don't keep, -1 = keep indefinitely
     int                mPurgeDaysQueued {-1};   // >= 0 to purge the archive calendar from KAlarmApp::processLoop()
     QList<ResourceId>  mPendingPurges;          // new resources which may need to be purged when populated
-    QList<ProcData*>   mCommandProcesses;       // currently active command alarm processes
+    QHash<ShellProcess*, ProcData*> mCommandProcesses; // command alarm processes, running or waiting to start
+    QMultiHash<QString, ProcData*> mCommandEvents;     // command alarm processes, indexed by event ID
+    QMap<quint64, ProcData*> mCommandBacklog;   // command alarm processes waiting to start, by queue order
+    quint64            mCommandBacklogLast {0}; // key of the last command added to mCommandBacklog
+    qint64             mCommandWaitTotal {0};   // total time in milliseconds that started commands waited in backlog
+    qint64             mCommandWaitMax {0};     // longest time in milliseconds that a command waited in backlog
+    int                mCommandWaitCount {0};   // number of commands which have been started from backlog
+    int                mXtermCommandCount {0};  // number of command processes executing in terminal windows
     QQueue<ActionQEntry> mActionQueue;          // queued commands and actions
     QList<MessageWindow*> mRestoredWindows;     // message windows restored at startup, waiting to be displayed
     int                mEditingCmdLineAlarm {0}; // whether currently editing alarm specified on command line
@@ -291,6 +315,7 @@ private:
     bool               mWindowFocusBroken;      // keyboard focus transfer between windows doesn't work
     bool               mResourcesTimedOut {false}; // timeout has expired for populating resources
     bool               mNotificationsInhibited {false};  // Freedesktop notifications are inhibited
+    bool               mNotificationsAvailable {false};  // the Freedesktop notifications service exists
 };
 
 inline KAlarmApp* theApp()  { return KAlarmApp::instance(); }
@@ -0,0 +1,198 @@
+/*
+   This file is part of kalarmcal library, which provides access to KAlarm
+   calendar data.
+
+   SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+   SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "calendargenerator.h"
+
+#include "icalstreamwriter.h"
+using namespace KAlarmCal;
+
+#include <KCalendarCore/Event>
+using namespace KCalendarCore;
+
+#include <QBitArray>
+#include <QFile>
+
+namespace
+{
+const int BATCH = 500;      // number of events to write together
+const QColor bgColour(20, 70, 140);
+const QColor fgColour(130, 110, 240);
+}
+
+/******************************************************************************
+* Set options from a string of the form "key=value,key=value".
+*/
+bool CalendarGenerator::setOptions(const QString& options)
+{
+    const QStringList items = options.split(QLatin1Char(','), Qt::SkipEmptyParts);
+    for (const QString& item : items)
+    {
+        const QStringList keyValue = item.split(QLatin1Char('='));
+        if (keyValue.count() != 2)
+            return false;
+        bool ok;
+        const int value = keyValue[1].trimmed().toInt(&ok);
+        if (!ok  ||  value < 0)
+            return false;
+        const QString key = keyValue[0].trimmed();
+        if (key == QLatin1String("count"))
+            count = value;
+        else if (key == QLatin1String("seed"))
+            seed = value;
+        else
+        {
+            if (value > 100)
+                return false;
+            if (key == QLatin1String("recur"))
+                recurPercent = value;
+            else if (key == QLatin1String("reminder"))
+                reminderPercent = value;
+            else if (key == QLatin1String("defer"))
+                deferPercent = value;
+            else if (key == QLatin1String("archived"))
+                archivedPercent = value;
+            else if (key == QLatin1String("template"))
+                templatePercent = value;
+            else if (key == QLatin1String("command"))
+                commandPercent = value;
+            else if (key == QLatin1String("email"))
+                emailPercent = value;
+            else if (key == QLatin1String("audio"))
+                audioPercent = value;
+            else
+                return false;
+        }
+    }
+    return archivedPercent + templatePercent <= 100
+       &&  commandPercent + emailPercent + audioPercent <= 100;
+}
+
+/******************************************************************************
+* Write a calendar file containing 'count' generated alarms.
+*/
+bool CalendarGenerator::write(const QString& fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    QRandomGenerator random(seed);
+    ICalStreamWriter writer(&file);
+    Event::List batch;
+    for (int i = 0;  i < count;  ++i)
+    {
+        const KAEvent event = createEvent(i, random);
+        Event::Ptr kcalEvent(new Event);
+        if (!event.updateKCalEvent(kcalEvent, KAEvent::UidAction::Set))
+            return false;
+        batch += kcalEvent;
+        if (batch.count() >= BATCH)
+        {
+            if (!writer.writeEvents(batch))
+                return false;
+            batch.clear();
+        }
+    }
+    if (!batch.isEmpty()  &&  !writer.writeEvents(batch))
+        return false;
+    return writer.finish();
+}
+
+/******************************************************************************
+* Generate one alarm.
+* The same number of random values is always used, so that changing one option
+* does not change the alarms' other properties.
+*/
+KAEvent CalendarGenerator::createEvent(int index, QRandomGenerator& random) const
+{
+    const int category = random.bounded(100);
+    const int action   = random.bounded(100);
+    const int startSecs = random.bounded(86400);
+    const int archivedDays = random.bounded(1, 365);
+    const bool recurs  = random.bounded(100) < recurPercent;
+    const int recurType = random.bounded(5);
+    const int recurFreq = random.bounded(1, 25);
+    const bool reminder = random.bounded(100) < reminderPercent;
+    const int reminderMinutes = 5 * random.bounded(1, 13);
+    const bool defer   = random.bounded(100) < deferPercent;
+    const int deferMinutes = random.bounded(5, 120);
+
+    CalEvent::Type type = CalEvent::ACTIVE;
+    if (category < archivedPercent)
+        type = CalEvent::ARCHIVED;
+    else if (category < archivedPercent + templatePercent)
+        type = CalEvent::TEMPLATE;
+
+    const QString number = QString::number(index);
+    KAEvent::SubAction subAction = KAEvent::SubAction::Message;
+    QString text = QStringLiteral("Message ") + number;
+    if (action < commandPercent)
+    {
+        subAction = KAEvent::SubAction::Command;
+        text = (command.isEmpty() ? QStringLiteral("true") : command) + QLatin1Char(' ') + number;
+    }
+    else if (action < commandPercent + emailPercent)
+    {
+        subAction = KAEvent::SubAction::Email;
+        text = QStringLiteral("Email message ") + number;
+    }
+    else if (action < commandPercent + emailPercent + audioPercent)
+    {
+        subAction = KAEvent::SubAction::Audio;
+        text = QStringLiteral("/usr/share/sounds/alarm-%1.ogg").arg(index % 10);
+    }
+
+    QDate date = startDate;
+    if (type == CalEvent::ARCHIVED)
+        date = date.addDays(-archivedDays);
+    const KADateTime start = KADateTime(date, QTime(0, 0), timeZone).addSecs(startSecs);
+
+    KAEvent event(start, QString(), text, bgColour, fgColour, QFont(), subAction, 0, KAEvent::Flags(), true);
+    event.setEventId(QStringLiteral("loadtest-") + number);
+    if (subAction == KAEvent::SubAction::Email)
+        event.setEmail(0, {Person(QStringLiteral("Recipient ") + number, QStringLiteral("recipient%1@example.com").arg(index))},
+                       QStringLiteral("Subject ") + number, QStringList());
+    if (recurs)
+    {
+        switch (recurType)
+        {
+            case 0:
+                event.setRecurMinutely(5 * recurFreq, 0, KADateTime());
+                break;
+            case 1:
+                event.setRecurDaily(1, QBitArray(7, true), 0, QDate());
+                break;
+            case 2:
+            {
+                QBitArray days(7);
+                days.setBit(date.dayOfWeek() - 1);
+                event.setRecurWeekly(1, days, 0, QDate());
+                break;
+            }
+            case 3:
+                event.setRecurMonthlyByDate(1, {date.day()}, 0, QDate());
+                break;
+            default:
+                event.setRecurAnnualByDate(1, {date.month()}, date.day(), KARecurrence::Feb29_Mar1, 0, QDate());
+                break;
+        }
+    }
+    if (type == CalEvent::ACTIVE  &&  reminder)
+        event.setReminder(reminderMinutes, false);
+    if (type == CalEvent::TEMPLATE)
+        event.setTemplate(QStringLiteral("Template ") + number);
+    else if (type == CalEvent::ARCHIVED)
+        event.setCategory(CalEvent::ARCHIVED);
+    event.endChanges();
+
+    if (type == CalEvent::ACTIVE  &&  defer)
+        event.defer(DateTime(start.addSecs(deferMinutes * 60)), false);
+    return event;
+}
+
+// vim: et sw=4:
@@ -0,0 +1,73 @@
+/*
+   This file is part of kalarmcal library, which provides access to KAlarm
+   calendar data.
+
+   SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+   SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "kaevent.h"
+
+#include <QDate>
+#include <QRandomGenerator>
+#include <QTimeZone>
+
+/**
+ * Generates synthetic KAlarm calendars for load testing.
+ *
+ * The alarms generated depend only on the options, so that the same calendar
+ * is always generated for the same options. Active alarms start during the
+ * day given by startDate.
+ *
+ * Options may be set from a string of the form "count=50000,recur=60,seed=3",
+ * containing any of the following keys. Percentages apply to all alarms,
+ * except where stated.
+ *   count     - number of alarms
+ *   seed      - random number seed
+ *   recur     - percentage of active alarms which recur
+ *   reminder  - percentage of active alarms with a reminder
+ *   defer     - percentage of active alarms which are deferred
+ *   archived  - percentage of archived alarms
+ *   template  - percentage of alarm templates
+ *   command   - percentage of command alarms
+ *   email     - percentage of email alarms
+ *   audio     - percentage of audio alarms (the remainder are display alarms)
+ */
+class CalendarGenerator
+{
+public:
+    int       count {10000};
+    quint32   seed {1};
+    int       recurPercent {40};
+    int       reminderPercent {20};
+    int       deferPercent {5};
+    int       archivedPercent {10};
+    int       templatePercent {2};
+    int       commandPercent {20};
+    int       emailPercent {10};
+    int       audioPercent {5};
+    QDate     startDate;        // the day on which active alarms start
+    QTimeZone timeZone {QTimeZone::utc()};
+    QString   command;          // command to execute in command alarms
+
+    /** Set options from a string of comma separated key=value pairs.
+     *  @return  true if successful, false if the string is invalid.
+     */
+    bool setOptions(const QString& options);
+
+    /** Write a calendar file containing the generated alarms.
+     *  @return  true if successful, false if the file could not be written.
+     */
+    bool write(const QString& fileName) const;
+
+    /** Generate one alarm.
+     *  @param index   index of the alarm, used as its ID.
+     *  @param random  random number generator, seeded from @c seed.
+     */
+    KAlarmCal::KAEvent createEvent(int index, QRandomGenerator& random) const;
+};
+
+// vim: et sw=4:
@@ -0,0 +1,264 @@
+/*
+   This file is part of kalarmcal library, which provides access to KAlarm
+   calendar data.
+
+   SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+   SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "calendarloadtest.h"
+
+#include "calendargenerator.h"
+#include "heapusage.h"
+#include "icalstreamreader.h"
+#include "icalstreamwriter.h"
+#include "kacalendar.h"
+#include "kaevent.h"
+using namespace KAlarmCal;
+
+#include <KCalendarCore/FileStorage>
+#include <KCalendarCore/ICalFormat>
+#include <KCalendarCore/MemoryCalendar>
+using namespace KCalendarCore;
+
+#include <QFile>
+#include <QFont>
+#include <QHash>
+#include <QMultiHash>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(CalendarLoadTest)
+
+namespace
+{
+const int COUNT = 100000;   // number of events in the calendar
+const int BATCH = 500;      // number of events to parse together
+QTemporaryDir* tempDir = nullptr;
+QString calendarFile;
+
+/******************************************************************************
+* Load the calendar file by parsing it a batch at a time, and converting each
+* batch directly to KAEvents.
+*/
+bool readDirect(QHash<QString, KAEvent>& events)
+{
+    QFile file(calendarFile);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    ICalStreamReader reader(&file);
+    while (!reader.atEnd())
+    {
+        Event::List kcalEvents;
+        if (!reader.readEvents(BATCH, kcalEvents))
+            return false;
+        for (const Event::Ptr& kcalEvent : std::as_const(kcalEvents))
+            events[kcalEvent->uid()] = KAEvent(kcalEvent);
+    }
+    return true;
+}
+
+/******************************************************************************
+* Load the whole calendar file into a MemoryCalendar, and then convert its
+* events to KAEvents.
+*/
+bool readMemoryCalendar(MemoryCalendar::Ptr& calendar, QHash<QString, KAEvent>& events)
+{
+    calendar.reset(new MemoryCalendar(QTimeZone::utc()));
+    FileStorage::Ptr storage(new FileStorage(calendar, calendarFile, new ICalFormat));
+    if (!storage->load())
+        return false;
+    QString versionString;
+    KACalendar::updateVersion(storage, versionString);
+    const Event::List kcalEvents = calendar->rawEvents();
+    for (const Event::Ptr& kcalEvent : kcalEvents)
+        events[kcalEvent->uid()] = KAEvent(kcalEvent);
+    return true;
+}
+
+/******************************************************************************
+* Load a calendar file in the same way as SingleFileResource, keeping one
+* KAEvent per UID. Events which have a RECURRENCE-ID, or which have the same
+* UID as an event already loaded, are kept unchanged in 'others'.
+*/
+bool readKeepingOthers(const QString& fileName, QHash<QString, KAEvent>& events, QMultiHash<QString, Event::Ptr>& others)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    ICalStreamReader reader(&file);
+    while (!reader.atEnd())
+    {
+        Event::List kcalEvents;
+        if (!reader.readEvents(BATCH, kcalEvents))
+            return false;
+        for (const Event::Ptr& kcalEvent : std::as_const(kcalEvents))
+        {
+            const QString uid = kcalEvent->uid();
+            if (kcalEvent->hasRecurrenceId()  ||  events.contains(uid))
+                others.insert(uid, kcalEvent);
+            else
+                events[uid] = KAEvent(kcalEvent);
+        }
+    }
+    return true;
+}
+
+/******************************************************************************
+* Write KAEvents, and unchanged KCalendarCore events, to a calendar file.
+*/
+bool writeWithOthers(const QString& fileName, const QHash<QString, KAEvent>& events, const QMultiHash<QString, Event::Ptr>& others)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    ICalStreamWriter writer(&file);
+    Event::List kcalEvents;
+    for (const KAEvent& event : events)
+    {
+        Event::Ptr kcalEvent(new Event);
+        if (!event.updateKCalEvent(kcalEvent, KAEvent::UidAction::Set))
+            return false;
+        kcalEvents += kcalEvent;
+    }
+    for (const Event::Ptr& kcalEvent : others)
+        kcalEvents += kcalEvent;
+    return writer.writeEvents(kcalEvents)  &&  writer.finish();
+}
+
+/******************************************************************************
+* Report the heap memory retained by a loaded calendar.
+*/
+void reportMemory(const char* name, qint64 before)
+{
+    const qint64 after = heapUsed();
+    if (before >= 0)
+        qInfo("%s: %lld bytes retained per event", name, (after - before) / COUNT);
+}
+}
+
+void CalendarLoadTest::initTestCase()
+{
+    KAEvent::setDefaultFont(QFont(QStringLiteral("Helvetica"), 10));
+    tempDir = new QTemporaryDir;
+    QVERIFY(tempDir->isValid());
+    calendarFile = tempDir->filePath(QStringLiteral("calendar.ics"));
+    CalendarGenerator generator;
+    generator.count     = COUNT;
+    generator.startDate = QDate(2030, 1, 7);
+    QVERIFY(generator.write(calendarFile));
+}
+
+void CalendarLoadTest::cleanupTestCase()
+{
+    delete tempDir;
+    tempDir = nullptr;
+}
+
+// Load the calendar without holding it in a MemoryCalendar, as
+// SingleFileResource does.
+void CalendarLoadTest::loadDirect()
+{
+    {
+        const qint64 before = heapUsed();
+        QHash<QString, KAEvent> events;
+        QVERIFY(readDirect(events));
+        reportMemory("Direct load", before);
+        QCOMPARE(events.count(), COUNT);
+        QVERIFY(events.value(QStringLiteral("loadtest-0")).isValid());
+        QVERIFY(events.value(QStringLiteral("loadtest-%1").arg(COUNT - 1)).isValid());
+    }
+
+    QBENCHMARK
+    {
+        QHash<QString, KAEvent> events;
+        readDirect(events);
+    }
+}
+
+// Load the calendar into a MemoryCalendar, keeping both it and the KAEvents.
+void CalendarLoadTest::loadMemoryCalendar()
+{
+    {
+        const qint64 before = heapUsed();
+        MemoryCalendar::Ptr calendar;
+        QHash<QString, KAEvent> events;
+        QVERIFY(readMemoryCalendar(calendar, events));
+        reportMemory("MemoryCalendar load", before);
+        QCOMPARE(events.count(), COUNT);
+        QVERIFY(events.value(QStringLiteral("loadtest-0")).isValid());
+    }
+
+    QBENCHMARK
+    {
+        MemoryCalendar::Ptr calendar;
+        QHash<QString, KAEvent> events;
+        readMemoryCalendar(calendar, events);
+    }
+}
+
+// Check that VEVENTs which share a UID all survive a load and save, both
+// for an instance of a recurring event and for a duplicated event.
+void CalendarLoadTest::sameUidRoundTrip()
+{
+    CalendarGenerator generator;
+    generator.startDate    = QDate(2030, 1, 7);
+    generator.recurPercent = 100;
+    generator.archivedPercent = 0;
+    generator.templatePercent = 0;
+    QRandomGenerator random(generator.seed);
+    Event::Ptr master(new Event);
+    QVERIFY(generator.createEvent(0, random).updateKCalEvent(master, KAEvent::UidAction::Set));
+    QVERIFY(master->recurs());
+    const QString uid = master->uid();
+
+    Event::Ptr instance(master->clone());
+    instance->clearRecurrence();
+    instance->setRecurrenceId(master->dtStart().addDays(1));
+    instance->setSummary(QStringLiteral("Changed instance"));
+    Event::Ptr duplicate(master->clone());
+    duplicate->setSummary(QStringLiteral("Duplicate"));
+
+    const QString inFile = tempDir->filePath(QStringLiteral("sameuid.ics"));
+    {
+        QFile file(inFile);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        ICalStreamWriter writer(&file);
+        QVERIFY(writer.writeEvents({master, instance, duplicate}));
+        QVERIFY(writer.finish());
+    }
+
+    QHash<QString, KAEvent> events;
+    QMultiHash<QString, Event::Ptr> others;
+    QVERIFY(readKeepingOthers(inFile, events, others));
+    QCOMPARE(events.count(), 1);
+    QCOMPARE(others.count(), 2);
+    const QString outFile = tempDir->filePath(QStringLiteral("sameuid-saved.ics"));
+    QVERIFY(writeWithOthers(outFile, events, others));
+
+    QFile file(outFile);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    ICalStreamReader reader(&file);
+    Event::List saved;
+    QVERIFY(reader.readEvents(10, saved));
+    QCOMPARE(saved.count(), 3);
+    QStringList summaries;
+    int instances = 0;
+    for (const Event::Ptr& event : std::as_const(saved))
+    {
+        QCOMPARE(event->uid(), uid);
+        summaries += event->summary();
+        if (event->hasRecurrenceId())
+        {
+            ++instances;
+            QCOMPARE(event->recurrenceId(), instance->recurrenceId());
+        }
+    }
+    QCOMPARE(instances, 1);
+    QVERIFY(summaries.contains(QStringLiteral("Changed instance")));
+    QVERIFY(summaries.contains(QStringLiteral("Duplicate")));
+}
+
+// vim: et sw=4:
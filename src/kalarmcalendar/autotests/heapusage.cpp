@@ -0,0 +1,67 @@
+/*
+   This file is part of kalarmcal library, which provides access to KAlarm
+   calendar data.
+
+   SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+   SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "heapusage.h"
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+thread_local qint64 allocationCount = 0;
+}
+
+/******************************************************************************
+* Replacements for the global operator new and delete, to count allocations.
+* The array forms call these by default.
+*/
+void* operator new(std::size_t size)
+{
+    ++allocationCount;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+/******************************************************************************
+* Return the number of bytes currently allocated on the heap, or -1 if unknown.
+*/
+qint64 heapUsed()
+{
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+    const struct mallinfo2 info = mallinfo2();
+    return static_cast<qint64>(info.uordblks + info.hblkhd);
+#else
+    return -1;
+#endif
+}
+
+/******************************************************************************
+* Return the number of allocations made by operator new in the current thread.
+*/
+qint64 heapAllocations()
+{
+    return allocationCount;
+}
+
+// vim: et sw=4:
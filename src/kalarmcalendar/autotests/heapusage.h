@@ -0,0 +1,25 @@
+/*
+   This file is part of kalarmcal library, which provides access to KAlarm
+   calendar data.
+
+   SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+   SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QtGlobal>
+
+/** Return the number of bytes currently allocated on the heap, or -1 if this
+ *  is not available on this platform.
+ */
+qint64 heapUsed();
+
+/** Return the number of allocations made by operator new in the current
+ *  thread. Note that Qt containers allocate their data with malloc(), which
+ *  is not counted.
+ */
+qint64 heapAllocations();
+
+// vim: et sw=4:
@@ -0,0 +1,117 @@
+/*
+   This file is part of kalarmcal library, which provides access to KAlarm
+   calendar data.
+
+   SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+   SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "holidaystest.h"
+
+#include "holidays.h"
+using namespace KAlarmCal;
+
+#include <KHolidays/HolidayRegion>
+
+#include <QTest>
+
+QTEST_GUILESS_MAIN(HolidaysTest)
+
+namespace
+{
+const QString REGION = QStringLiteral("gb-eng_en-gb");
+const int DAYS = 2 * 366;    // number of days from today to check
+
+/******************************************************************************
+* Determine whether a date is a non-working holiday, directly from KHolidays.
+*/
+bool expectedHoliday(const KHolidays::HolidayRegion& region, const QDate& date)
+{
+    const KHolidays::Holiday::List hols = region.rawHolidaysWithAstroSeasons(date);
+    for (const KHolidays::Holiday& h : hols)
+        if (h.dayType() == KHolidays::Holiday::NonWorkday)
+            return true;
+    return false;
+}
+
+/******************************************************************************
+* Return the next Christmas Day, which is a non-working holiday in the region.
+*/
+QDate nextChristmas()
+{
+    const QDate today = QDate::currentDate();
+    const QDate christmas(today.year(), 12, 25);
+    return (christmas >= today) ? christmas : QDate(today.year() + 1, 12, 25);
+}
+}
+
+void HolidaysTest::initTestCase()
+{
+    if (!KHolidays::HolidayRegion(REGION).isValid())
+        QSKIP("Holiday data for gb-eng_en-gb is not installed");
+}
+
+// isHoliday() must give the same results before and after the non-working
+// holidays have been calculated in the background.
+void HolidaysTest::isHoliday()
+{
+    const KHolidays::HolidayRegion region(REGION);
+    const QDate today = QDate::currentDate();
+    Holidays holidays(REGION);
+    QVERIFY(holidays.isValid());
+    const bool readyAtStart = holidays.nonWorkingDaysReady();
+    for (int i = 0;  i < DAYS;  ++i)
+    {
+        const QDate date = today.addDays(i);
+        QCOMPARE(holidays.isHoliday(date), expectedHoliday(region, date));
+        QCOMPARE(holidays.isHoliday(date), holidays.holidayType(date) == Holidays::NonWorking);
+    }
+    if (readyAtStart)
+        qInfo("Non-working holidays were calculated before the first check");
+
+    QTRY_VERIFY_WITH_TIMEOUT(holidays.nonWorkingDaysReady(), 30000);
+    for (int i = 0;  i < DAYS;  ++i)
+    {
+        const QDate date = today.addDays(i);
+        QCOMPARE(holidays.isHoliday(date), expectedHoliday(region, date));
+    }
+    QVERIFY(holidays.isHoliday(nextChristmas()));
+}
+
+// nextNonHoliday() must return the first date on or after the given date which
+// is not a non-working holiday, both inside and beyond the calculated period.
+void HolidaysTest::nextNonHoliday()
+{
+    Holidays holidays(REGION);
+    holidays.setCacheYears(1);
+    QTRY_VERIFY_WITH_TIMEOUT(holidays.nonWorkingDaysReady(), 30000);
+    const QDate today = QDate::currentDate();
+    for (int i = 0;  i < 3 * 366;  i += 3)
+    {
+        const QDate date = today.addDays(i);
+        QDate expected = date;
+        while (holidays.holidayType(expected) == Holidays::NonWorking)
+            expected = expected.addDays(1);
+        QCOMPARE(holidays.nextNonHoliday(date), expected);
+    }
+
+    // Christmas Day and Boxing Day are both non-working holidays.
+    const QDate christmas = nextChristmas();
+    QVERIFY(holidays.nextNonHoliday(christmas) > christmas.addDays(1));
+}
+
+// Dates before yesterday are never holidays, whichever method is used.
+void HolidaysTest::pastDates()
+{
+    Holidays holidays(REGION);
+    QTRY_VERIFY_WITH_TIMEOUT(holidays.nonWorkingDaysReady(), 30000);
+    const QDate lastChristmas = nextChristmas().addYears(-2);   // always before yesterday
+    QCOMPARE(holidays.holidayType(lastChristmas), Holidays::None);
+    QVERIFY(!holidays.isHoliday(lastChristmas));
+    QCOMPARE(holidays.nextNonHoliday(lastChristmas), lastChristmas);
+}
+
+#include "moc_holidaystest.cpp"
+
+// vim: et sw=4:
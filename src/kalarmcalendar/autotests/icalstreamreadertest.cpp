@@ -0,0 +1,456 @@
+/*
+   This file is part of kalarmcal library, which provides access to KAlarm
+   calendar data.
+
+   SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+   SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "icalstreamreadertest.h"
+
+#include "calendargenerator.h"
+#include "icalstreamreader.h"
+#include "icalstreamwriter.h"
+#include "kacalendar.h"
+#include "kaevent.h"
+using namespace KAlarmCal;
+
+#include <KCalendarCore/Event>
+using namespace KCalendarCore;
+
+#include <QCryptographicHash>
+#include <QSet>
+#include <QTemporaryFile>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(ICalStreamReaderTest)
+
+namespace
+{
+const QByteArray TIMEZONE =
+    "BEGIN:VTIMEZONE\r\n"
+    "TZID:Europe/Berlin\r\n"
+    "BEGIN:STANDARD\r\n"
+    "DTSTART:19701025T030000\r\n"
+    "RRULE:FREQ=YEARLY;BYDAY=-1SU;BYMONTH=10\r\n"
+    "TZOFFSETFROM:+0200\r\n"
+    "TZOFFSETTO:+0100\r\n"
+    "END:STANDARD\r\n"
+    "BEGIN:DAYLIGHT\r\n"
+    "DTSTART:19700329T020000\r\n"
+    "RRULE:FREQ=YEARLY;BYDAY=-1SU;BYMONTH=3\r\n"
+    "TZOFFSETFROM:+0100\r\n"
+    "TZOFFSETTO:+0200\r\n"
+    "END:DAYLIGHT\r\n"
+    "END:VTIMEZONE\r\n";
+
+/******************************************************************************
+* Generate a calendar file containing 'count' alarms of various types, in the
+* current KAlarm format.
+*/
+bool generateCalendar(QTemporaryFile& file, int count)
+{
+    if (!file.open())
+        return false;
+    CalendarGenerator generator;
+    generator.count     = count;
+    generator.startDate = QDate(2030, 1, 1);
+    generator.timeZone  = QTimeZone("Europe/Berlin");
+    return generator.write(file.fileName())  &&  file.seek(0);
+}
+
+/******************************************************************************
+* Generate a calendar file containing 'count' display alarms, with the given
+* PRODID and KAlarm version. This is written by hand, so that old and foreign
+* calendars can be generated. The time zone definition is written after the
+* first few events, and the file does not end in a newline, to check that these
+* are handled.
+*/
+bool writeCalendar(QTemporaryFile& file, int count, const QByteArray& prodId, const QByteArray& version)
+{
+    if (!file.open())
+        return false;
+    QByteArray text = "BEGIN:VCALENDAR\r\n"
+                      "PRODID:" + prodId + "\r\n"
+                      "VERSION:2.0\r\n";
+    if (!version.isEmpty())
+        text += "X-KDE-KALARM-VERSION:" + version + "\r\n";
+    for (int i = 0;  i < count;  ++i)
+    {
+        if (i == 3)
+            text += TIMEZONE;
+        const QByteArray n = QByteArray::number(i);
+        text += "BEGIN:VEVENT\r\n"
+                "DTSTAMP:20230101T000000Z\r\n"
+                "CREATED:20230101T000000Z\r\n"
+                "UID:event-" + n + "\r\n"
+                "X-KDE-KALARM-TYPE:ACTIVE\r\n"
+                "DTSTART;TZID=Europe/Berlin:20300101T090000\r\n"
+                "BEGIN:VALARM\r\n"
+                "ACTION:DISPLAY\r\n"
+                "TRIGGER;VALUE=DURATION:PT0S\r\n"
+                "DESCRIPTION:Message " + n + "\r\n"
+                "END:VALARM\r\n"
+                "END:VEVENT\r\n";
+        if (text.size() > 65536)
+        {
+            file.write(text);
+            text.clear();
+        }
+    }
+    text += "END:VCALENDAR";
+    file.write(text);
+    file.flush();
+    return file.seek(0);
+}
+}
+
+//////////////////////////////////////////////////////
+// Reading a large calendar in batches
+//////////////////////////////////////////////////////
+
+void ICalStreamReaderTest::readLargeCalendar()
+{
+    const int COUNT = 20000;
+    const int BATCH = 1000;
+    QTemporaryFile file;
+    QVERIFY(generateCalendar(file, COUNT));
+
+    ICalStreamReader reader(&file);
+    QSet<QString> uids;
+    int batches = 0;
+    while (!reader.atEnd())
+    {
+        Event::List events;
+        QVERIFY(reader.readEvents(BATCH, events));
+        QVERIFY(events.count() <= BATCH);
+        for (const Event::Ptr& event : std::as_const(events))
+        {
+            uids.insert(event->uid());
+            QCOMPARE(event->dtStart().timeZone(), QTimeZone("Europe/Berlin"));
+            QVERIFY(!event->alarms().isEmpty());
+        }
+        if (!events.isEmpty())
+        {
+            QVERIFY(KAEvent(events.constFirst()).isValid());
+            ++batches;
+        }
+    }
+    QCOMPARE(uids.count(), COUNT);
+    QCOMPARE(batches, COUNT / BATCH);
+    QCOMPARE(reader.version(), static_cast<int>(KACalendar::CurrentFormat));
+}
+
+void ICalStreamReaderTest::readOldVersion()
+{
+    QTemporaryFile file;
+    QVERIFY(writeCalendar(file, 10, "-//K Desktop Environment//NONSGML KAlarm 2.2.0//EN", "2.2.0"));
+
+    ICalStreamReader reader(&file);
+    Event::List events;
+    QVERIFY(reader.readEvents(100, events));
+    QVERIFY(reader.atEnd());
+    QCOMPARE(events.count(), 10);
+    QCOMPARE(reader.versionString(), QStringLiteral("2.2.0"));
+    QVERIFY(reader.version() > 0);
+    QVERIFY(reader.version() < KAEvent::currentCalendarVersion());
+
+    // The version found from the first batch applies to later batches.
+    QVERIFY(file.seek(0));
+    ICalStreamReader reader2(&file);
+    int count = 0;
+    while (!reader2.atEnd())
+    {
+        Event::List batch;
+        QVERIFY(reader2.readEvents(3, batch));
+        for (const Event::Ptr& event : std::as_const(batch))
+            QVERIFY(KAEvent(event).isValid());
+        count += batch.count();
+        if (!batch.isEmpty())
+            QCOMPARE(reader2.version(), reader.version());
+    }
+    QCOMPARE(count, 10);
+
+    // If the version is already known, it is not read from the calendar.
+    QVERIFY(file.seek(0));
+    ICalStreamReader reader3(&file);
+    QList<QByteArray> texts;
+    reader3.readEventTexts(texts);
+    QCOMPARE(texts.count(), 10);
+    reader3.setFileVersion(KACalendar::CurrentFormat);
+    Event::List events;
+    QVERIFY(reader3.parseEvents(texts.constFirst(), events));
+    QCOMPARE(events.count(), 1);
+    QCOMPARE(reader3.version(), static_cast<int>(KACalendar::CurrentFormat));
+    QVERIFY(reader3.versionString().isEmpty());
+}
+
+void ICalStreamReaderTest::readForeignCalendar()
+{
+    QTemporaryFile file;
+    QVERIFY(writeCalendar(file, 5, "-//Other Program//EN", QByteArray()));
+
+    ICalStreamReader reader(&file);
+    Event::List events;
+    QVERIFY(reader.readEvents(2, events));
+    QCOMPARE(events.count(), 2);
+    QCOMPARE(reader.version(), static_cast<int>(KACalendar::IncompatibleFormat));
+    QVERIFY(reader.readEvents(10, events));
+    QCOMPARE(events.count(), 5);
+    QVERIFY(reader.atEnd());
+}
+
+//////////////////////////////////////////////////////
+// Reading event texts without parsing
+//////////////////////////////////////////////////////
+
+void ICalStreamReaderTest::readEventTexts()
+{
+    const int COUNT = 10;
+    QTemporaryFile file;
+    QVERIFY(generateCalendar(file, COUNT));
+
+    ICalStreamReader reader(&file);
+    QList<QByteArray> texts;
+    reader.readEventTexts(texts);
+    QVERIFY(reader.atEnd());
+    QCOMPARE(texts.count(), COUNT);
+    QVERIFY(reader.header().contains("BEGIN:VTIMEZONE"));
+    for (int i = 0;  i < COUNT;  ++i)
+    {
+        QVERIFY(texts[i].startsWith("BEGIN:VEVENT"));
+        QCOMPARE(ICalStreamReader::eventUid(texts[i]), QStringLiteral("loadtest-%1").arg(i));
+    }
+
+    // Parse only some of the events.
+    Event::List events;
+    QVERIFY(reader.parseEvents(texts[2] + texts[7], events));
+    QCOMPARE(events.count(), 2);
+    QSet<QString> uids;
+    for (const Event::Ptr& event : std::as_const(events))
+    {
+        uids.insert(event->uid());
+        QCOMPARE(event->dtStart().timeZone(), QTimeZone("Europe/Berlin"));
+    }
+    QCOMPARE(uids, QSet<QString>({QStringLiteral("loadtest-2"), QStringLiteral("loadtest-7")}));
+
+    // A folded UID line, and a UID in a nested component, are handled.
+    const QByteArray text = "BEGIN:VEVENT\r\n"
+                            "BEGIN:VALARM\r\n"
+                            "UID:alarm-uid\r\n"
+                            "END:VALARM\r\n"
+                            "uid:folded\r\n"
+                            " -uid\r\n"
+                            "END:VEVENT\r\n";
+    QCOMPARE(ICalStreamReader::eventUid(text), QStringLiteral("folded-uid"));
+    QVERIFY(ICalStreamReader::eventUid("BEGIN:VEVENT\r\nEND:VEVENT\r\n").isEmpty());
+}
+
+//////////////////////////////////////////////////////
+// Folded lines which look like component delimiters
+//////////////////////////////////////////////////////
+
+void ICalStreamReaderTest::readFoldedLines()
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write("BEGIN:VCALENDAR\r\n"
+               "PRODID:-//K Desktop Environment//NONSGML KAlarm 3.7.0//EN\r\n"
+               "VERSION:2.0\r\n"
+               "X-KDE-KALARM-VERSION:" + KAEvent::currentCalendarVersionString() + "\r\n"
+               "BEGIN:VEVENT\r\n"
+               "DTSTAMP:20230101T000000Z\r\n"
+               "UID:event-0\r\n"
+               "DTSTART:20300101T090000Z\r\n"
+               "DESCRIPTION:Text folded before \r\n"
+               " END:VEVENT and \r\n"
+               "\tBEGIN:VALARM\r\n"
+               "END:VEVENT\r\n"
+               "BEGIN:VEVENT\r\n"
+               "DTSTAMP:20230101T000000Z\r\n"
+               "UID:event-1\r\n"
+               "DTSTART:20300101T100000Z\r\n"
+               "END:VEVENT\r\n"
+               "END:VCALENDAR\r\n");
+    file.flush();
+    QVERIFY(file.seek(0));
+
+    ICalStreamReader reader(&file);
+    QList<QByteArray> texts;
+    reader.readEventTexts(texts);
+    QCOMPARE(texts.count(), 2);
+    QVERIFY(texts[0].contains(" END:VEVENT and \r\n\tBEGIN:VALARM\r\n"));
+    QCOMPARE(ICalStreamReader::eventUid(texts[1]), QStringLiteral("event-1"));
+
+    Event::List events;
+    QVERIFY(reader.parseEvents(texts[0] + texts[1], events));
+    QCOMPARE(events.count(), 2);
+    for (const Event::Ptr& event : std::as_const(events))
+    {
+        if (event->uid() == QLatin1String("event-0"))
+            QCOMPARE(event->description(), QStringLiteral("Text folded before END:VEVENT and BEGIN:VALARM"));
+        else
+            QCOMPARE(event->uid(), QStringLiteral("event-1"));
+    }
+}
+
+//////////////////////////////////////////////////////
+// Writing a calendar in batches
+//////////////////////////////////////////////////////
+
+void ICalStreamReaderTest::writeCalendarBatches()
+{
+    const int COUNT = 2000;
+    const int BATCH = 300;
+    QTemporaryFile inFile;
+    QVERIFY(generateCalendar(inFile, COUNT));
+
+    // Copy the events to a new file, one batch at a time.
+    QTemporaryFile outFile;
+    QVERIFY(outFile.open());
+    ICalStreamReader reader(&inFile);
+    ICalStreamWriter writer(&outFile);
+    while (!reader.atEnd())
+    {
+        Event::List events;
+        QVERIFY(reader.readEvents(BATCH, events));
+        QVERIFY(writer.writeEvents(events));
+    }
+    QVERIFY(writer.finish());
+    outFile.flush();
+
+    // The calendar properties and time zone must each be written only once.
+    const QByteArray text = outFile.readAll();
+    QVERIFY(text.startsWith("BEGIN:VCALENDAR"));
+    QVERIFY(text.trimmed().endsWith("END:VCALENDAR"));
+    QCOMPARE(text.count("BEGIN:VCALENDAR"), 1);
+    QCOMPARE(text.count("X-KDE-KALARM-VERSION:"), 1);
+    QCOMPARE(text.count("BEGIN:VTIMEZONE"), 1);
+    QCOMPARE(text.count("BEGIN:VEVENT"), COUNT);
+
+    QVERIFY(outFile.seek(0));
+    ICalStreamReader reader2(&outFile);
+    QSet<QString> uids;
+    while (!reader2.atEnd())
+    {
+        Event::List events;
+        QVERIFY(reader2.readEvents(BATCH, events));
+        for (const Event::Ptr& event : std::as_const(events))
+        {
+            uids.insert(event->uid());
+            QCOMPARE(event->dtStart().timeZone(), QTimeZone("Europe/Berlin"));
+        }
+    }
+    QCOMPARE(uids.count(), COUNT);
+}
+
+// Long texts are folded when written. A continuation line which starts with
+// END: or BEGIN: must not be taken as the end or start of a component.
+void ICalStreamReaderTest::writeFoldedLines()
+{
+    Event::List events;
+    QStringList descriptions;
+    for (int pad = 40;  pad < 100;  ++pad)
+    {
+        const QString description = QString(pad, QLatin1Char('x')) + QStringLiteral("END:VEVENT BEGIN:VALARM END:VCALENDAR");
+        Event::Ptr event(new Event);
+        event->setUid(QStringLiteral("event-%1").arg(pad));
+        event->setDtStart(QDateTime(QDate(2030,1,1), QTime(9,0,0), QTimeZone::utc()));
+        event->setDescription(description);
+        events += event;
+        descriptions += description;
+    }
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    ICalStreamWriter writer(&file);
+    QVERIFY(writer.writeEvents(events));
+    QVERIFY(writer.finish());
+    file.flush();
+
+    QVERIFY(file.seek(0));
+    const QByteArray text = file.readAll();
+    QCOMPARE(text.count("\nBEGIN:VEVENT"), events.count());
+    QCOMPARE(text.count("\nEND:VEVENT"), events.count());
+    QVERIFY(text.trimmed().endsWith("END:VCALENDAR"));
+
+    QVERIFY(file.seek(0));
+    ICalStreamReader reader(&file);
+    Event::List readEvents;
+    QVERIFY(reader.readEvents(1000, readEvents));
+    QCOMPARE(readEvents.count(), events.count());
+    for (const Event::Ptr& event : std::as_const(readEvents))
+    {
+        const int pad = event->uid().mid(6).toInt();
+        QCOMPARE(event->description(), descriptions.at(pad - 40));
+    }
+}
+
+// Components and calendar properties read from an existing calendar must be
+// written back unaltered, including those which KCalendarCore doesn't handle.
+void ICalStreamReaderTest::writeComponentsVerbatim()
+{
+    const QByteArray todo =
+        "BEGIN:VTODO\r\n"
+        "UID:todo-1\r\n"
+        "SUMMARY:Something to do\r\n"
+        "END:VTODO\r\n";
+    const QByteArray event =
+        "BEGIN:VEVENT\r\n"
+        "UID:event-1\r\n"
+        "DTSTART;TZID=Europe/Berlin:20300101T090000\r\n"
+        "X-OTHER-PROGRAM-DATA:kept\r\n"
+        "ATTACH;FMTTYPE=text/plain:https://example.com/notes.txt\r\n"
+        "END:VEVENT\r\n";
+    QTemporaryFile inFile;
+    QVERIFY(inFile.open());
+    inFile.write("BEGIN:VCALENDAR\r\n"
+                 "PRODID:-//K Desktop Environment//NONSGML KAlarm 3.7.0//EN\r\n"
+                 "VERSION:2.0\r\n"
+                 "X-KDE-KALARM-VERSION:" + KAEvent::currentCalendarVersionString() + "\r\n"
+                 "X-WR-CALNAME:My\r\n"
+                 " alarms\r\n"
+                 + TIMEZONE + todo + event +
+                 "END:VCALENDAR\r\n");
+    inFile.flush();
+    QVERIFY(inFile.seek(0));
+
+    ICalStreamReader reader(&inFile);
+    QByteArray eventText;
+    QVERIFY(reader.readEventText(eventText));
+    QCOMPARE(eventText, event);
+
+    QTemporaryFile outFile;
+    QVERIFY(outFile.open());
+    ICalStreamWriter writer(&outFile);
+    writer.setProperties(reader.properties());
+    QVERIFY(writer.writeComponents(reader.components()));
+    QVERIFY(writer.writeComponents(eventText));
+    QVERIFY(writer.writeComponents(TIMEZONE));   // a duplicate time zone must be skipped
+    QVERIFY(writer.finish());
+    outFile.flush();
+
+    QVERIFY(outFile.seek(0));
+    const QByteArray text = outFile.readAll();
+    QCOMPARE(text.count("PRODID:"), 1);
+    QCOMPARE(text.count("X-KDE-KALARM-VERSION:"), 1);
+    QVERIFY(text.contains("X-WR-CALNAME:My\r\n alarms\r\n"));
+    QVERIFY(text.indexOf("X-WR-CALNAME:") < text.indexOf("BEGIN:VTIMEZONE"));
+    QCOMPARE(text.count("BEGIN:VTIMEZONE"), 1);
+    QVERIFY(text.contains(todo));
+    QVERIFY(text.contains(event));
+    QVERIFY(text.trimmed().endsWith("END:VCALENDAR"));
+
+    // The hashes recorded while writing must match those of the file as read.
+    QCOMPARE(writer.fileHash(), QCryptographicHash::hash(text, QCryptographicHash::Md5));
+    QVERIFY(outFile.seek(0));
+    ICalStreamReader reader2(&outFile);
+    QByteArray eventText2;
+    QVERIFY(reader2.readEventText(eventText2));
+    QCOMPARE(eventText2, event);
+    QVERIFY(!reader2.readEventText(eventText2));
+    QCOMPARE(writer.header(), reader2.header());
+}
+
+// vim: et sw=4:
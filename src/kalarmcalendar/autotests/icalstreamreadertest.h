@@ -0,0 +1,28 @@
+/*
+   This file is part of kalarmcal library, which provides access to KAlarm
+   calendar data.
+
+   SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+   SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+class ICalStreamReaderTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void readLargeCalendar();
+    void readOldVersion();
+    void readForeignCalendar();
+    void readEventTexts();
+    void readFoldedLines();
+    void writeCalendarBatches();
+    void writeFoldedLines();
+    void writeComponentsVerbatim();
+};
+
+// vim: et sw=4:
@@ -0,0 +1,237 @@
+/*
+   This file is part of kalarmcal library, which provides access to KAlarm
+   calendar data.
+
+   SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+   SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "kadatetimebenchmark.h"
+
+#include "heapusage.h"
+#include "kaevent.h"
+using namespace KAlarmCal;
+
+#include <QBitArray>
+#include <QHash>
+#include <QTest>
+#include <QTimeZone>
+
+QTEST_GUILESS_MAIN(KADateTimeBenchmark)
+
+namespace
+{
+const int BENCHMARK_COUNT = 1000;
+const QTimeZone benchmarkZone("Europe/London");
+
+/******************************************************************************
+* Return a list of date/time values spread over about three months.
+*/
+QList<KADateTime> benchmarkValues()
+{
+    QList<KADateTime> values;
+    values.reserve(BENCHMARK_COUNT);
+    const KADateTime dt(QDate(2023, 1, 1), QTime(9, 0, 0), benchmarkZone);
+    for (int i = 0;  i < BENCHMARK_COUNT;  ++i)
+        values += dt.addSecs(i * 7919);
+    return values;
+}
+
+QList<KADateTime::Compact> compactValues(const QList<KADateTime>& values)
+{
+    QList<KADateTime::Compact> compacts;
+    compacts.reserve(values.count());
+    for (const KADateTime& dt : values)
+        compacts += KADateTime::Compact(dt);
+    return compacts;
+}
+
+/******************************************************************************
+* Return a list of recurring alarms, with start times spread as for
+* benchmarkValues().
+*/
+QList<KAEvent> benchmarkEvents()
+{
+    const QList<KADateTime> starts = benchmarkValues();
+    QList<KAEvent> events;
+    events.reserve(starts.count());
+    for (int i = 0;  i < starts.count();  ++i)
+    {
+        KAEvent event(starts[i], QString(), QStringLiteral("Benchmark message"), Qt::white, Qt::black, QFont(),
+                      KAEvent::SubAction::Message, 0, {}, true);
+        event.setRecurDaily(7, QBitArray(7, true), 0, QDate());
+        event.setEventId(QStringLiteral("benchmark-event-%1").arg(i));
+        event.endChanges();
+        events += event;
+    }
+    return events;
+}
+
+/******************************************************************************
+* Run one benchmark pass, and report the number of heap allocations it made.
+*/
+template <typename F>
+qint64 countAllocations(const F& pass)
+{
+    const qint64 before = heapAllocations();
+    pass();
+    const qint64 allocations = heapAllocations() - before;
+    qInfo("%s: %lld allocations per %d values", QTest::currentDataTag(), allocations, BENCHMARK_COUNT);
+    return allocations;
+}
+
+/******************************************************************************
+* Fill a date filter cache with the next occurrence of each event after 'from',
+* as AlarmListModel::filterAcceptsRow() does, and then benchmark a filter pass
+* which checks every cached occurrence against 'now'.
+* 'passed' is set to the number of cached occurrences which have passed.
+*/
+template <typename T>
+void runDateFilterCache(const QList<KAEvent>& events, const KADateTime& from, const KADateTime& now, bool mustNotAllocate, int& passed)
+{
+    QHash<QString, T> cache;
+    cache.reserve(events.count());
+    const qint64 heapBefore = heapUsed();
+    for (const KAEvent& event : events)
+    {
+        DateTime next;
+        event.nextOccurrence(from, next, KAEvent::Repeats::Return);
+        cache[event.id()] = T(next.effectiveKDateTime());
+    }
+    const qint64 heapAfter = heapUsed();
+    if (heapBefore >= 0  &&  heapAfter >= 0)
+        qInfo("%s: cache holds %lld heap bytes for %lld events", QTest::currentDataTag(), heapAfter - heapBefore, qint64(events.count()));
+
+    const T cacheNow(now);
+    auto pass = [&]() {
+        passed = 0;
+        for (const KAEvent& event : events)
+        {
+            const auto it = cache.constFind(event.id());
+            if (it != cache.constEnd()  &&  it.value() < cacheNow)
+                ++passed;
+        }
+    };
+    const qint64 allocations = countAllocations(pass);
+    if (mustNotAllocate)
+        QCOMPARE(allocations, qint64(0));
+    QBENCHMARK {
+        pass();
+    }
+}
+}
+
+void KADateTimeBenchmark::dateFilterCache_data()
+{
+    QTest::addColumn<bool>("compact");
+    QTest::newRow("KADateTime") << false;
+    QTest::newRow("Compact") << true;
+}
+
+void KADateTimeBenchmark::dateFilterCache()
+{
+    QFETCH(bool, compact);
+    const QList<KAEvent> events = benchmarkEvents();
+    const KADateTime from(QDate(2023, 2, 1), QTime(0, 0, 0), benchmarkZone);
+    const KADateTime now = from.addDays(3);
+
+    int expected = 0;
+    for (const KAEvent& event : events)
+    {
+        DateTime next;
+        event.nextOccurrence(from, next, KAEvent::Repeats::Return);
+        if (next.effectiveKDateTime() < now)
+            ++expected;
+    }
+    QVERIFY(expected > 0  &&  expected < events.count());
+
+    int passed = 0;
+    if (compact)
+        runDateFilterCache<KADateTime::Compact>(events, from, now, true, passed);
+    else
+        runDateFilterCache<KADateTime>(events, from, now, false, passed);
+    QCOMPARE(passed, expected);
+}
+
+void KADateTimeBenchmark::compare_data()
+{
+    dateFilterCache_data();
+}
+
+void KADateTimeBenchmark::compare()
+{
+    QFETCH(bool, compact);
+    const QList<KADateTime> values = benchmarkValues();
+    int earlier = 0;
+    if (compact)
+    {
+        const QList<KADateTime::Compact> compacts = compactValues(values);
+        auto pass = [&]() {
+            earlier = 0;
+            for (int i = 1;  i < compacts.count();  ++i)
+                if (compacts[i - 1] < compacts[i])
+                    ++earlier;
+        };
+        QCOMPARE(countAllocations(pass), qint64(0));
+        QBENCHMARK {
+            pass();
+        }
+    }
+    else
+    {
+        auto pass = [&]() {
+            earlier = 0;
+            for (int i = 1;  i < values.count();  ++i)
+                if (values[i - 1] < values[i])
+                    ++earlier;
+        };
+        countAllocations(pass);
+        QBENCHMARK {
+            pass();
+        }
+    }
+    QCOMPARE(earlier, BENCHMARK_COUNT - 1);
+}
+
+void KADateTimeBenchmark::addSecs_data()
+{
+    dateFilterCache_data();
+}
+
+void KADateTimeBenchmark::addSecs()
+{
+    QFETCH(bool, compact);
+    const QList<KADateTime> values = benchmarkValues();
+    if (compact)
+    {
+        const QList<KADateTime::Compact> compacts = compactValues(values);
+        QList<KADateTime::Compact> results(compacts.count());
+        auto pass = [&]() {
+            for (int i = 0;  i < compacts.count();  ++i)
+                results[i] = compacts[i].addSecs(3600);
+        };
+        QCOMPARE(countAllocations(pass), qint64(0));
+        QBENCHMARK {
+            pass();
+        }
+        QCOMPARE(results.first().toDateTime(), values.first().addSecs(3600));
+    }
+    else
+    {
+        QList<KADateTime> results(values.count());
+        auto pass = [&]() {
+            for (int i = 0;  i < values.count();  ++i)
+                results[i] = values[i].addSecs(3600);
+        };
+        countAllocations(pass);
+        QBENCHMARK {
+            pass();
+        }
+        QCOMPARE(results.first(), values.first().addSecs(3600));
+    }
+}
+
+#include "moc_kadatetimebenchmark.cpp"
+
+// vim: et sw=4:
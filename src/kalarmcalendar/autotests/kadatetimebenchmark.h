@@ -0,0 +1,35 @@
+/*
+   This file is part of kalarmcal library, which provides access to KAlarm
+   calendar data.
+
+   SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+   SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+/**
+ * Benchmarks comparing KADateTime with KADateTime::Compact.
+ *
+ * Compact is only used for AlarmListModel's date filter cache, so the main
+ * benchmark mirrors that cache for a container of KAEvents. Each benchmark
+ * also reports the heap allocations made by one pass. Run it with the
+ * kalarmcalendar_benchmark target, which writes kadatetimebenchmark.xml in
+ * the build directory.
+ */
+class KADateTimeBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void dateFilterCache_data();
+    void dateFilterCache();
+    void compare_data();
+    void compare();
+    void addSecs_data();
+    void addSecs();
+};
+
+// vim: et sw=4:
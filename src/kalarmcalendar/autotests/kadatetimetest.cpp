@@ -3844,6 +3844,90 @@ void KADateTimeTest::misc()
     ::tzset();
 }
 
+////////////////////////////////////////////////////////////////////////
+// KADateTime::Compact
+////////////////////////////////////////////////////////////////////////
+
+void KADateTimeTest::compact()
+{
+    QTimeZone london("Europe/London");
+    QTimeZone cairo("Africa/Cairo");
+
+    QByteArray originalZone = qgetenv("TZ");   // save the original local time zone
+    qputenv("TZ", ":America/Los_Angeles");
+    ::tzset();
+
+    QVERIFY(!KADateTime::Compact().isValid());
+    QVERIFY(!KADateTime::Compact(KADateTime()).isValid());
+    QVERIFY(!KADateTime::Compact().toDateTime().isValid());
+
+    // Round trip conversions
+    const KADateTime values[] = {
+        KADateTime(QDate(2004, 3, 1), QTime(3, 45, 2), KADateTime::UTC),
+        KADateTime(QDate(2004, 3, 1), QTime(3, 45, 2), KADateTime::Spec::OffsetFromUTC(-5400)),
+        KADateTime(QDate(2004, 3, 1), QTime(3, 45, 2), cairo),
+        KADateTime(QDate(2004, 3, 1), QTime(3, 45, 2), KADateTime::LocalZone),
+        KADateTime(QDate(2004, 3, 1), london),
+        KADateTime(QDate(2004, 3, 1), KADateTime::LocalZone),
+    };
+    for (const KADateTime& dt : values) {
+        const KADateTime::Compact c(dt);
+        QVERIFY(c.isValid());
+        QCOMPARE(c.isDateOnly(), dt.isDateOnly());
+        QCOMPARE(c.timeType(), dt.timeType());
+        const KADateTime result = c.toDateTime();
+        QCOMPARE(result, dt);
+        QCOMPARE(result.timeSpec(), dt.timeSpec());
+        QCOMPARE(result.date(), dt.date());
+        QCOMPARE(result.time(), dt.time());
+        QCOMPARE(result.isDateOnly(), dt.isDateOnly());
+    }
+
+    // Second occurrence of a time during a daylight saving time shift
+    KADateTime second(QDate(2005, 10, 30), QTime(1, 30, 0), london);
+    second.setSecondOccurrence(true);
+    KADateTime::Compact csecond(second);
+    QVERIFY(csecond.toDateTime().isSecondOccurrence());
+    QCOMPARE(csecond.toMSecsSinceEpoch(), second.toSecsSinceEpoch() * 1000);
+
+    // Comparisons
+    const KADateTime::Compact c1(KADateTime(QDate(2004, 3, 1), QTime(3, 45, 2), cairo));
+    const KADateTime::Compact c2(KADateTime(QDate(2004, 3, 1), QTime(3, 45, 3), london));
+    const KADateTime::Compact c3(KADateTime(QDate(2004, 3, 1), QTime(1, 45, 2), KADateTime::UTC));
+    QVERIFY(c1 < c2);
+    QVERIFY(!(c2 < c1));
+    QVERIFY(c1 == c3);
+    QVERIFY(c1 <= c3);
+    QVERIFY(c2 > c3);
+    QCOMPARE(c1.secsTo(c2), qint64(7201));
+
+    // Date-only comparisons are the same as for KADateTime
+    const KADateTime d1(QDate(2004, 3, 1), cairo);
+    const KADateTime d2(QDate(2004, 3, 2), cairo);
+    const KADateTime t1(QDate(2004, 3, 1), QTime(23, 59, 59, 999), cairo);
+    QCOMPARE(KADateTime::Compact(d1) < KADateTime::Compact(d2), d1 < d2);
+    QCOMPARE(KADateTime::Compact(t1) < KADateTime::Compact(d2), t1 < d2);
+    QCOMPARE(KADateTime::Compact(d1) < KADateTime::Compact(t1), d1 < t1);
+    QCOMPARE(KADateTime::Compact(d1) == KADateTime::Compact(t1), d1 == t1);
+    QCOMPARE(KADateTime::Compact(d1).secsTo(KADateTime::Compact(d2)), d1.secsTo(d2));
+
+    // Addition
+    const KADateTime dt(QDate(2005, 3, 27), QTime(0, 30, 0), london);
+    QCOMPARE(KADateTime::Compact(dt).addSecs(3600).toDateTime(), dt.addSecs(3600));
+    QCOMPARE(KADateTime::Compact(dt).addSecs(-86400).toDateTime(), dt.addSecs(-86400));
+    QCOMPARE(KADateTime::Compact(dt).addMSecs(1500).toDateTime(), dt.addMSecs(1500));
+    QCOMPARE(KADateTime::Compact(d1).addSecs(86400 * 3).toDateTime(), d1.addSecs(86400 * 3));
+    QVERIFY(KADateTime::Compact(d1).addSecs(86400 * 3).isDateOnly());
+
+    // Restore the original local time zone
+    if (originalZone.isEmpty()) {
+        unsetenv("TZ");
+    } else {
+        qputenv("TZ", originalZone);
+    }
+    ::tzset();
+}
+
 #include "moc_kadatetimetest.cpp"
 
 // vim: et sw=4:
@@ -41,5 +41,6 @@ private Q_SLOTS:
 #endif
     void stream();
     void misc();
+    void compact();
 };
 
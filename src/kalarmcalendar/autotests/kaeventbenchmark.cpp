@@ -0,0 +1,348 @@
+/*
+   This file is part of kalarmcal library, which provides access to KAlarm
+   calendar data.
+
+   SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+   SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "kaeventbenchmark.h"
+
+#include "holidays.h"
+#include "kaevent.h"
+#include "karecurrence.h"
+using namespace KAlarmCal;
+
+#include <KCalendarCore/Event>
+using namespace KCalendarCore;
+
+#include <QBitArray>
+#include <QTest>
+#include <QTimeZone>
+
+QTEST_GUILESS_MAIN(KAEventBenchmark)
+
+namespace
+{
+// Recurrence types to benchmark.
+enum Recur
+{
+    Minutely,          // every 15 minutes
+    DailyExceptions,   // daily, with every third day excluded
+    MonthlyByPos,      // last Friday of each month
+    AnnualFeb29,       // 29 February, on 1 March in non-leap years
+    WorkHoursOnly,     // hourly, only during working hours and not on holidays
+    RecurCount
+};
+const char* const RECUR_NAMES[RecurCount] = { "minutely", "daily-exceptions", "monthly-by-pos", "annual-feb29", "work-hours-only" };
+
+const QByteArray ZONES[] = { "UTC", "Europe/London", "America/New_York", "Asia/Kolkata" };
+
+// The benchmark dates are in next year, so that they are always in the future,
+// since holiday data is only available from today onwards. They are set by
+// initTestCase().
+int benchmarkYear = 0;
+int benchmarkLeapYear = 0;   // the first leap year not before benchmarkYear
+const QString HOLIDAY_REGION = QStringLiteral("gb-eng_en-gb");
+
+const QColor bgColour(20, 70, 140);
+const QColor fgColour(130, 110, 240);
+QBitArray workDays(7);
+
+/******************************************************************************
+* Add data columns and rows for each combination of recurrence type and time
+* zone.
+*/
+void addRecurrenceData()
+{
+    QTest::addColumn<int>("recur");
+    QTest::addColumn<QByteArray>("zone");
+    for (int recur = 0;  recur < RecurCount;  ++recur)
+        for (const QByteArray& zone : ZONES)
+            QTest::addRow("%s %s", RECUR_NAMES[recur], zone.constData()) << recur << zone;
+}
+
+/******************************************************************************
+* Create a recurring display alarm.
+*/
+KAEvent createEvent(int recur, const QByteArray& zone)
+{
+    QDate date(benchmarkYear, 1, 2);
+    QTime time(9, 0);
+    KAEvent::Flags flags;
+    switch (recur)
+    {
+        case AnnualFeb29:
+            date = QDate(benchmarkLeapYear, 2, 29);
+            break;
+        case WorkHoursOnly:
+            time = QTime(20, 0);    // start outside working hours
+            flags = KAEvent::WORK_TIME_ONLY | KAEvent::EXCL_HOLIDAYS;
+            break;
+        default:
+            break;
+    }
+
+    KAEvent event(KADateTime(date, time, QTimeZone(zone)), QString(), QStringLiteral("Benchmark message"),
+                  bgColour, fgColour, QFont(), KAEvent::SubAction::Message, 0, flags, true);
+    switch (recur)
+    {
+        case Minutely:
+            event.setRecurMinutely(15, 0, KADateTime());
+            break;
+        case DailyExceptions:
+            event.setRecurDaily(1, QBitArray(7, true), 0, QDate());
+            for (int i = 3;  i < 1000;  i += 3)
+                event.recurrence()->addExDate(date.addDays(i));
+            break;
+        case MonthlyByPos:
+        {
+            KAEvent::MonthPos pos;
+            pos.weeknum = -1;
+            pos.days.setBit(4);   // Friday
+            event.setRecurMonthlyByPos(1, {pos}, 0, QDate());
+            break;
+        }
+        case AnnualFeb29:
+            event.setRecurAnnualByDate(1, {2}, 29, KARecurrence::Feb29_Mar1, 0, QDate());
+            break;
+        case WorkHoursOnly:
+            event.setRecurMinutely(60, 0, KADateTime());
+            break;
+    }
+    event.setEventId(QStringLiteral("benchmark-event"));
+    event.endChanges();
+    return event;
+}
+
+/******************************************************************************
+* Return the time after which to find occurrences of an event: far enough after
+* its start that the recurrence has to be evaluated.
+*/
+KADateTime afterStart(const KAEvent& event)
+{
+    return event.startDateTime().effectiveKDateTime().addDays(200);
+}
+}
+
+void KAEventBenchmark::initTestCase()
+{
+    KAEvent::setDefaultFont(QFont(QStringLiteral("Helvetica"), 10));
+    // Always use the same holiday region, so that results are comparable.
+    static Holidays holidays(HOLIDAY_REGION);
+    if (!holidays.isValid())
+        QSKIP("Holiday data for gb-eng_en-gb is not installed");
+    KAEvent::setHolidays(holidays);
+    benchmarkYear = QDate::currentDate().year() + 1;
+    benchmarkLeapYear = benchmarkYear;
+    while (!QDate::isLeapYear(benchmarkLeapYear))
+        ++benchmarkLeapYear;
+    workDays.fill(true, 0, 5);   // Monday to Friday
+    KAEvent::setWorkTime(workDays, QTime(9, 0), QTime(17, 0), KADateTime::LocalZone);
+}
+
+void KAEventBenchmark::nextOccurrence_data()
+{
+    addRecurrenceData();
+}
+
+void KAEventBenchmark::nextOccurrence()
+{
+    QFETCH(int, recur);
+    QFETCH(QByteArray, zone);
+    const KAEvent event = createEvent(recur, zone);
+    const KADateTime after = afterStart(event);
+    DateTime result;
+    QBENCHMARK
+    {
+        event.nextOccurrence(after, result, KAEvent::Repeats::Ignore);
+    }
+    QVERIFY(result.isValid());
+}
+
+void KAEventBenchmark::setNextOccurrence_data()
+{
+    addRecurrenceData();
+}
+
+// Note that this includes the time taken to copy the event's data, since each
+// iteration must start from the same state.
+void KAEventBenchmark::setNextOccurrence()
+{
+    QFETCH(int, recur);
+    QFETCH(QByteArray, zone);
+    const KAEvent event = createEvent(recur, zone);
+    const KADateTime after = afterStart(event);
+    QBENCHMARK
+    {
+        KAEvent copy(event);
+        copy.setNextOccurrence(after);
+    }
+}
+
+void KAEventBenchmark::calcTriggerTimes_data()
+{
+    addRecurrenceData();
+}
+
+// Each iteration changes the working hours, so that the next trigger times must
+// be recalculated taking account of working hours and holidays.
+void KAEventBenchmark::calcTriggerTimes()
+{
+    QFETCH(int, recur);
+    QFETCH(QByteArray, zone);
+    KAEvent event = createEvent(recur, zone);
+    event.setWorkTimeOnly(true);
+    event.setExcludeHolidays(true);
+    const KADateTime::Spec spec(QTimeZone(zone));
+    bool alternate = false;
+    DateTime result;
+    QBENCHMARK
+    {
+        alternate = !alternate;
+        KAEvent::setWorkTime(workDays, QTime(9, 0), QTime(alternate ? 18 : 17, 0), spec);
+        result = event.nextTrigger(KAEvent::Trigger::Work);
+    }
+    KAEvent::setWorkTime(workDays, QTime(9, 0), QTime(17, 0), KADateTime::LocalZone);
+    QVERIFY(result.isValid());
+}
+
+void KAEventBenchmark::recurrenceNextDateTime_data()
+{
+    addRecurrenceData();
+}
+
+void KAEventBenchmark::recurrenceNextDateTime()
+{
+    QFETCH(int, recur);
+    QFETCH(QByteArray, zone);
+    const KAEvent event = createEvent(recur, zone);
+    const KARecurrence* recurrence = event.recurrence();
+    QVERIFY(recurrence);
+    const KADateTime after = afterStart(event);
+    KADateTime result;
+    QBENCHMARK
+    {
+        result = recurrence->getNextDateTime(after);
+    }
+    QVERIFY(result.isValid());
+}
+
+void KAEventBenchmark::createFromKCalEvent_data()
+{
+    addRecurrenceData();
+}
+
+void KAEventBenchmark::createFromKCalEvent()
+{
+    QFETCH(int, recur);
+    QFETCH(QByteArray, zone);
+    const KAEvent event = createEvent(recur, zone);
+    Event::Ptr kcalEvent(new Event);
+    QVERIFY(event.updateKCalEvent(kcalEvent, KAEvent::UidAction::Set));
+    QBENCHMARK
+    {
+        const KAEvent newEvent(kcalEvent);
+        Q_UNUSED(newEvent)
+    }
+}
+
+void KAEventBenchmark::updateKCalEvent_data()
+{
+    addRecurrenceData();
+}
+
+// Each iteration writes the event into a new KCalendarCore::Event, as when a
+// calendar is saved.
+void KAEventBenchmark::updateKCalEvent()
+{
+    QFETCH(int, recur);
+    QFETCH(QByteArray, zone);
+    const KAEvent event = createEvent(recur, zone);
+    QBENCHMARK
+    {
+        Event::Ptr kcalEvent(new Event);
+        event.updateKCalEvent(kcalEvent, KAEvent::UidAction::Set);
+    }
+}
+
+void KAEventBenchmark::dateTimeFromString_data()
+{
+    QTest::addColumn<int>("format");
+    QTest::addColumn<QByteArray>("zone");
+    const struct { KADateTime::TimeFormat format; const char* name; } formats[] = {
+        { KADateTime::ISODate,    "iso" },
+        { KADateTime::RFCDate,    "rfc" },
+        { KADateTime::QtTextDate, "qttext" }
+    };
+    for (const auto& f : formats)
+        for (const QByteArray& zone : ZONES)
+            QTest::addRow("%s %s", f.name, zone.constData()) << static_cast<int>(f.format) << zone;
+}
+
+void KAEventBenchmark::dateTimeFromString()
+{
+    QFETCH(int, format);
+    QFETCH(QByteArray, zone);
+    const auto fmt = static_cast<KADateTime::TimeFormat>(format);
+    const QString str = KADateTime(QDate(2023,7,14), QTime(13,25,41), QTimeZone(zone)).toString(fmt);
+    KADateTime result;
+    QBENCHMARK
+    {
+        result = KADateTime::fromString(str, fmt);
+    }
+    QVERIFY(result.isValid());
+}
+
+void KAEventBenchmark::dateTimeToString_data()
+{
+    dateTimeFromString_data();
+}
+
+void KAEventBenchmark::dateTimeToString()
+{
+    QFETCH(int, format);
+    QFETCH(QByteArray, zone);
+    const auto fmt = static_cast<KADateTime::TimeFormat>(format);
+    const KADateTime dt(QDate(2023,7,14), QTime(13,25,41), QTimeZone(zone));
+    QString result;
+    QBENCHMARK
+    {
+        result = dt.toString(fmt);
+    }
+    QVERIFY(!result.isEmpty());
+}
+
+void KAEventBenchmark::dateTimeCompare_data()
+{
+    QTest::addColumn<QByteArray>("zone1");
+    QTest::addColumn<QByteArray>("zone2");
+    QTest::addColumn<bool>("dateOnly");
+    QTest::newRow("same zone") << QByteArray("Europe/London") << QByteArray("Europe/London") << false;
+    QTest::newRow("utc") << QByteArray("UTC") << QByteArray("UTC") << false;
+    QTest::newRow("different zones") << QByteArray("Europe/London") << QByteArray("America/New_York") << false;
+    QTest::newRow("zone and utc") << QByteArray("Asia/Kolkata") << QByteArray("UTC") << false;
+    QTest::newRow("date-only") << QByteArray("Europe/London") << QByteArray("America/New_York") << true;
+}
+
+void KAEventBenchmark::dateTimeCompare()
+{
+    QFETCH(QByteArray, zone1);
+    QFETCH(QByteArray, zone2);
+    QFETCH(bool, dateOnly);
+    const KADateTime dt1(QDate(2023,7,14), QTime(13,25,41), QTimeZone(zone1));
+    KADateTime dt2(QDate(2023,7,14), QTime(9,25,41), QTimeZone(zone2));
+    if (dateOnly)
+        dt2.setDateOnly(true);
+    KADateTime::Comparison result = KADateTime::Equal;
+    QBENCHMARK
+    {
+        result = dt1.compare(dt2);
+    }
+    QVERIFY(result != KADateTime::Equal);
+}
+
+#include "moc_kaeventbenchmark.cpp"
+
+// vim: et sw=4:
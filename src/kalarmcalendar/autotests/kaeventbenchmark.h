@@ -0,0 +1,49 @@
+/*
+   This file is part of kalarmcal library, which provides access to KAlarm
+   calendar data.
+
+   SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+   SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+/**
+ * Benchmarks for the alarm scheduling functions which are called most often.
+ *
+ * Each recurrence benchmark is run for a range of recurrence types and time
+ * zones. To record results which can be compared between builds, use the
+ * standard QTest output options, e.g.
+ *     kaeventbenchmark -o results.xml,xml
+ * or build the kalarmcalendar_benchmark target, which writes
+ * kaeventbenchmark.xml in the build directory.
+ */
+class KAEventBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void nextOccurrence_data();
+    void nextOccurrence();
+    void setNextOccurrence_data();
+    void setNextOccurrence();
+    void calcTriggerTimes_data();
+    void calcTriggerTimes();
+    void recurrenceNextDateTime_data();
+    void recurrenceNextDateTime();
+    void createFromKCalEvent_data();
+    void createFromKCalEvent();
+    void updateKCalEvent_data();
+    void updateKCalEvent();
+    void dateTimeFromString_data();
+    void dateTimeFromString();
+    void dateTimeToString_data();
+    void dateTimeToString();
+    void dateTimeCompare_data();
+    void dateTimeCompare();
+};
+
+// vim: et sw=4:
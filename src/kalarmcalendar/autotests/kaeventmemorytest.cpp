@@ -0,0 +1,207 @@
+/*
+   This file is part of kalarmcal library, which provides access to KAlarm
+   calendar data.
+
+   SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+   SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "kaeventmemorytest.h"
+
+#include "heapusage.h"
+#include "kaevent.h"
+using namespace KAlarmCal;
+
+#include <KCalendarCore/Event>
+using namespace KCalendarCore;
+
+#include <QBitArray>
+#include <QTest>
+
+#include <functional>
+
+QTEST_GUILESS_MAIN(KAEventMemoryTest)
+
+namespace
+{
+const int COUNT = 10000;   // number of events in each calendar
+// Upper limit for the heap used by a KAEvent. This is well above the size of a
+// KAEvent's data, but catches regressions such as failing to share font data
+// between events.
+const qint64 MAX_BYTES_PER_EVENT = 4096;
+// Upper limit for the heap retained by KAEvent's shared font and string pools,
+// after all the events which used them have been deleted.
+const qint64 MAX_POOL_BYTES = 512 * 1024;
+
+/******************************************************************************
+* Create calendar events from KAEvents, as they would be read from a calendar.
+*/
+Event::List createCalendar(const std::function<KAEvent(int)>& create)
+{
+    Event::List events;
+    events.reserve(COUNT);
+    for (int i = 0;  i < COUNT;  ++i)
+    {
+        KAEvent event = create(i);
+        event.setEventId(QStringLiteral("event-%1").arg(i));
+        Event::Ptr kcalEvent(new Event);
+        event.updateKCalEvent(kcalEvent, KAEvent::UidAction::Set);
+        events += kcalEvent;
+    }
+    return events;
+}
+
+/******************************************************************************
+* Convert calendar events to KAEvents, and report the heap memory used per
+* KAEvent.
+*/
+void reportMemory(const char* name, const Event::List& kcalEvents)
+{
+    QList<KAEvent> events;
+    events.reserve(kcalEvents.count());
+    const qint64 before = heapUsed();
+    for (const Event::Ptr& kcalEvent : kcalEvents)
+        events += KAEvent(kcalEvent);
+    const qint64 after = heapUsed();
+
+    QCOMPARE(events.count(), COUNT);
+    QVERIFY(events.constFirst().isValid());
+    QVERIFY(events.constLast().isValid());
+    if (before < 0)
+        QSKIP("Heap usage is not available on this platform");
+    const qint64 perEvent = (after - before) / events.count();
+    qInfo("%s: %lld bytes per event", name, perEvent);
+    QVERIFY2(perEvent <= MAX_BYTES_PER_EVENT, qPrintable(QStringLiteral("%1 bytes per event").arg(perEvent)));
+}
+
+const KADateTime startTime(QDate(2030,1,1), QTime(9,0,0), QTimeZone("Europe/Berlin"));
+const QColor bgColour(20, 70, 140);
+const QColor fgColour(130, 110, 240);
+}
+
+void KAEventMemoryTest::initTestCase()
+{
+    KAEvent::setDefaultFont(QFont(QStringLiteral("Helvetica"), 10));
+}
+
+// Plain display alarms, using the default font, some recurring.
+void KAEventMemoryTest::displayAlarms()
+{
+    const Event::List kcalEvents = createCalendar([](int i)
+    {
+        KAEvent event(startTime.addSecs(i * 60), QString(), QStringLiteral("Message %1").arg(i),
+                      bgColour, fgColour, QFont(), KAEvent::SubAction::Message, 0, KAEvent::DEFAULT_FONT);
+        if (i % 4 == 0)
+        {
+            QBitArray days(7);
+            days.fill(true);
+            event.setRecurDaily(1, days, 0, QDate());
+        }
+        return event;
+    });
+    reportMemory("Display alarms", kcalEvents);
+}
+
+// Display alarms which all use the same non-default font.
+void KAEventMemoryTest::customFontAlarms()
+{
+    const Event::List kcalEvents = createCalendar([](int i)
+    {
+        return KAEvent(startTime.addSecs(i * 60), QString(), QStringLiteral("Message %1").arg(i),
+                       bgColour, fgColour, QFont(QStringLiteral("Courier"), 14, QFont::Bold),
+                       KAEvent::SubAction::Message, 5, KAEvent::CONFIRM_ACK);
+    });
+    reportMemory("Custom font alarms", kcalEvents);
+}
+
+// A mixture of display, command, email and audio alarms.
+void KAEventMemoryTest::mixedAlarms()
+{
+    const Event::List kcalEvents = createCalendar([](int i)
+    {
+        const QString text = QStringLiteral("Text %1").arg(i);
+        switch (i % 4)
+        {
+            case 0:
+            {
+                KAEvent event(startTime.addSecs(i * 60), QString(), text, bgColour, fgColour, QFont(),
+                              KAEvent::SubAction::Message, 0, KAEvent::DEFAULT_FONT | KAEvent::BEEP);
+                event.setActions(QStringLiteral("pre-command"), QStringLiteral("post-command"), KAEvent::CancelOnPreActError);
+                return event;
+            }
+            case 1:
+            {
+                KAEvent event(startTime.addSecs(i * 60), QString(), QStringLiteral("echo %1").arg(i), bgColour, fgColour, QFont(),
+                              KAEvent::SubAction::Command, 0, KAEvent::DEFAULT_FONT);
+                event.setLogFile(QStringLiteral("/tmp/kalarm.log"));
+                return event;
+            }
+            case 2:
+            {
+                KAEvent event(startTime.addSecs(i * 60), QString(), text, bgColour, fgColour, QFont(),
+                              KAEvent::SubAction::Email, 0, KAEvent::DEFAULT_FONT);
+                event.setEmail(0, {Person(QStringLiteral("Someone"), QStringLiteral("someone@example.com"))},
+                               QStringLiteral("Subject %1").arg(i), {});
+                return event;
+            }
+            default:
+            {
+                KAEvent event(startTime.addSecs(i * 60), QString(), QStringLiteral("/tmp/sound.ogg"), bgColour, fgColour, QFont(),
+                              KAEvent::SubAction::Audio, 0, KAEvent::DEFAULT_FONT);
+                event.setAudioFile(QStringLiteral("/tmp/sound.ogg"), 0.7f, -1, 0);
+                return event;
+            }
+        }
+    });
+    reportMemory("Mixed alarms", kcalEvents);
+}
+
+// Alarm templates.
+void KAEventMemoryTest::templates()
+{
+    const Event::List kcalEvents = createCalendar([](int i)
+    {
+        KAEvent event(KADateTime(), QString(), QStringLiteral("Template text %1").arg(i),
+                      bgColour, fgColour, QFont(), KAEvent::SubAction::Message, 0, KAEvent::DEFAULT_FONT);
+        event.setTemplate(QStringLiteral("Template %1").arg(i));
+        return event;
+    });
+    reportMemory("Templates", kcalEvents);
+}
+
+// Alarms which each have a different font or log file. Once the events are
+// deleted, the memory retained to share fonts and log file names must be
+// limited, however many different values have been used.
+void KAEventMemoryTest::sharedDataBounded()
+{
+    const Event::List kcalEvents = createCalendar([](int i)
+    {
+        if (i % 2)
+        {
+            KAEvent event(startTime.addSecs(i * 60), QString(), QStringLiteral("echo %1").arg(i), bgColour, fgColour, QFont(),
+                          KAEvent::SubAction::Command, 0, KAEvent::DEFAULT_FONT);
+            event.setLogFile(QStringLiteral("/tmp/kalarm-%1.log").arg(i));
+            return event;
+        }
+        return KAEvent(startTime.addSecs(i * 60), QString(), QStringLiteral("Message %1").arg(i),
+                       bgColour, fgColour, QFont(QStringLiteral("Font %1").arg(i), 10),
+                       KAEvent::SubAction::Message, 0, KAEvent::Flags());
+    });
+
+    const qint64 before = heapUsed();
+    {
+        QList<KAEvent> events;
+        events.reserve(kcalEvents.count());
+        for (const Event::Ptr& kcalEvent : kcalEvents)
+            events += KAEvent(kcalEvent);
+        QCOMPARE(events.count(), COUNT);
+    }
+    const qint64 after = heapUsed();
+    if (before < 0)
+        QSKIP("Heap usage is not available on this platform");
+    qInfo("Shared data: %lld bytes retained after deleting events", after - before);
+    QVERIFY2(after - before <= MAX_POOL_BYTES, qPrintable(QStringLiteral("%1 bytes retained").arg(after - before)));
+}
+
+// vim: et sw=4:
@@ -0,0 +1,26 @@
+/*
+   This file is part of kalarmcal library, which provides access to KAlarm
+   calendar data.
+
+   SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+   SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+class KAEventMemoryTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void displayAlarms();
+    void customFontAlarms();
+    void mixedAlarms();
+    void templates();
+    void sharedDataBounded();
+};
+
+// vim: et sw=4:
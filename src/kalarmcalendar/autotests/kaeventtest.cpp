@@ -1275,6 +1275,53 @@ void KAEventTest::toKCalEvent()
     }
 }
 
+void KAEventTest::updateKCalEvent()
+{
+    // Check that unchanged alarms and recurrence are not rewritten.
+    const KADateTime dt(QDate(2010,5,13), QTime(3, 45, 0), QTimeZone("Europe/London"));
+    KAEvent event(dt, QStringLiteral("name"), QStringLiteral("message"), Qt::black, Qt::white, QFont(), KAEvent::SubAction::Message, 0, KAEvent::DEFAULT_FONT);
+    event.setEventId(QStringLiteral("fa74ec931"));
+    event.setCategory(CalEvent::ACTIVE);
+    event.setRecurDaily(1, QBitArray(7, true), -1, QDate());
+    Event::Ptr kcalevent(new Event);
+    QVERIFY(event.updateKCalEvent(kcalevent, KAEvent::UidAction::Set, true));
+    QCOMPARE(kcalevent->alarms().size(), 1);
+    const Alarm::Ptr alarm = kcalevent->alarms().at(0);
+    const RecurrenceRule* rrule = kcalevent->recurrence()->defaultRRuleConst();
+    QVERIFY(rrule);
+    const QString nextRecur = kcalevent->customProperty("KALARM", "NEXTRECUR");
+
+    QVERIFY(event.updateKCalEvent(kcalevent, KAEvent::UidAction::Set, true));
+    QCOMPARE(kcalevent->alarms().at(0), alarm);
+    QCOMPARE(kcalevent->recurrence()->defaultRRuleConst(), rrule);
+
+    // Only the next recurrence changes.
+    event.setNextOccurrence(dt.addDays(1));
+    QVERIFY(event.updateKCalEvent(kcalevent, KAEvent::UidAction::Set, true));
+    QCOMPARE(kcalevent->alarms().at(0), alarm);
+    QCOMPARE(kcalevent->recurrence()->defaultRRuleConst(), rrule);
+    QVERIFY(kcalevent->customProperty("KALARM", "NEXTRECUR") != nextRecur);
+
+    // A reminder is added.
+    event.setReminder(15, false);
+    QVERIFY(event.updateKCalEvent(kcalevent, KAEvent::UidAction::Set, true));
+    QCOMPARE(kcalevent->alarms().size(), 2);
+    QVERIFY(kcalevent->alarms().at(0) != alarm);
+    QCOMPARE(kcalevent->recurrence()->defaultRRuleConst(), rrule);
+
+    // The recurrence changes.
+    event.setRecurDaily(2, QBitArray(7, true), -1, QDate());
+    QVERIFY(event.updateKCalEvent(kcalevent, KAEvent::UidAction::Set, true));
+    QCOMPARE(kcalevent->recurrence()->frequency(), 2);
+
+    // A new event with the same data has the same alarms and recurrence.
+    Event::Ptr kcalevent2(new Event);
+    QVERIFY(event.updateKCalEvent(kcalevent2, KAEvent::UidAction::Set, true));
+    QVERIFY(*kcalevent->recurrence() == *kcalevent2->recurrence());
+    QCOMPARE(kcalevent->alarms().size(), kcalevent2->alarms().size());
+    QVERIFY(*kcalevent->alarms().at(0) == *kcalevent2->alarms().at(0));
+}
+
 void KAEventTest::setNextOccurrence()
 {
     // Test setNextOccurrence() going from before to after a shift from daylight savings
@@ -1305,6 +1352,34 @@ void KAEventTest::setNextOccurrence()
     QVERIFY(!next3.isSecondOccurrence());
 }
 
+void KAEventTest::fingerprint()
+{
+    // Events created from the same calendar data have the same fingerprint.
+    const KADateTime dt(QDate(2010, 5, 13), QTime(3, 45, 0), QTimeZone("Europe/London"));
+    KAEvent event(dt, QStringLiteral("name"), QStringLiteral("text"), Qt::black, Qt::white, QFont(), KAEvent::SubAction::Message, 0, KAEvent::DEFAULT_FONT);
+    event.setRecurDaily(1, QBitArray(7, true), -1, QDate());
+    Event::Ptr kcalevent(new Event);
+    QVERIFY(event.updateKCalEvent(kcalevent, KAEvent::UidAction::Set));
+    const KAEvent event1(kcalevent);
+    QVERIFY(event1.fingerprint() != 0);
+    Event::Ptr copy(kcalevent->clone());
+    QCOMPARE(KAEvent(copy).fingerprint(), event1.fingerprint());
+
+    // A change of time zone which leaves the UTC start time unchanged alters
+    // the fingerprint.
+    Event::Ptr rezoned(kcalevent->clone());
+    rezoned->setDtStart(kcalevent->dtStart().toTimeZone(QTimeZone("Europe/Paris")));
+    QCOMPARE(rezoned->dtStart(), kcalevent->dtStart());
+    const KAEvent event2(rezoned);
+    QCOMPARE(event2.startDateTime().timeZone(), QTimeZone("Europe/Paris"));
+    QVERIFY(event2.fingerprint() != event1.fingerprint());
+
+    // Likewise for a change from a time zone to UTC.
+    Event::Ptr utc(kcalevent->clone());
+    utc->setDtStart(kcalevent->dtStart().toUTC());
+    QVERIFY(KAEvent(utc).fingerprint() != event1.fingerprint());
+}
+
 #include "moc_kaeventtest.cpp"
 
 // vim: et sw=4:
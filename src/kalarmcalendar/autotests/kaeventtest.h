@@ -19,6 +19,8 @@ private Q_SLOTS:
     void flags();
     void fromKCalEvent();
     void toKCalEvent();
+    void updateKCalEvent();
     void setNextOccurrence();
+    void fingerprint();
 };
 
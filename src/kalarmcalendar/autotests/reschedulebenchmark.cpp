@@ -0,0 +1,182 @@
+/*
+   This file is part of kalarmcal library, which provides access to KAlarm
+   calendar data.
+
+   SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+   SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "reschedulebenchmark.h"
+
+#include "calendargenerator.h"
+#include "icalstreamreader.h"
+#include "kaevent.h"
+using namespace KAlarmCal;
+
+#include <KCalendarCore/Event>
+using namespace KCalendarCore;
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMultiMap>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <algorithm>
+
+QTEST_GUILESS_MAIN(RescheduleBenchmark)
+
+namespace
+{
+const int BATCH = 500;      // number of events to parse together
+QTemporaryDir* tempDir = nullptr;
+CalendarGenerator generator;
+QList<KAEvent> activeEvents;
+
+/******************************************************************************
+* Return the time as seconds since the epoch, for use as a queue key.
+*/
+qint64 queueKey(const DateTime& dt)
+{
+    return dt.effectiveKDateTime().toSecsSinceEpoch();
+}
+}
+
+/******************************************************************************
+* Generate a calendar file and load its active alarms.
+*/
+void RescheduleBenchmark::initTestCase()
+{
+    KAEvent::setDefaultFont(QFont(QStringLiteral("Helvetica"), 10));
+    tempDir = new QTemporaryDir;
+    QVERIFY(tempDir->isValid());
+
+    // Start on the first Monday of next year, so that the alarms are always
+    // in the future.
+    const QDate newYear(QDate::currentDate().year() + 1, 1, 1);
+    generator.startDate = newYear.addDays((8 - newYear.dayOfWeek()) % 7);
+    generator.timeZone  = QTimeZone("Europe/London");
+    const QString options = qEnvironmentVariable("KALARM_BENCHMARK_CALENDAR");
+    QVERIFY2(generator.setOptions(options), "Invalid KALARM_BENCHMARK_CALENDAR options");
+
+    const QString calendarFile = tempDir->filePath(QStringLiteral("reschedule.ics"));
+    QVERIFY(generator.write(calendarFile));
+    QFile file(calendarFile);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    ICalStreamReader reader(&file);
+    while (!reader.atEnd())
+    {
+        Event::List kcalEvents;
+        QVERIFY(reader.readEvents(BATCH, kcalEvents));
+        for (const Event::Ptr& kcalEvent : std::as_const(kcalEvents))
+        {
+            const KAEvent event(kcalEvent);
+            QVERIFY(event.isValid());
+            if (event.category() == CalEvent::ACTIVE)
+                activeEvents += event;
+        }
+    }
+    QVERIFY(!activeEvents.isEmpty());
+    qInfo("Loaded %lld active alarms out of %d", static_cast<qint64>(activeEvents.count()), generator.count);
+}
+
+void RescheduleBenchmark::cleanupTestCase()
+{
+    activeEvents.clear();
+    delete tempDir;
+    tempDir = nullptr;
+}
+
+/******************************************************************************
+* Find the next trigger time of every active alarm.
+*/
+void RescheduleBenchmark::nextTrigger()
+{
+    int valid = 0;
+    QBENCHMARK
+    {
+        valid = 0;
+        for (const KAEvent& event : std::as_const(activeEvents))
+            if (event.nextTrigger(KAEvent::Trigger::All).isValid())
+                ++valid;
+    }
+    QVERIFY(valid > 0);
+}
+
+/******************************************************************************
+* Step through a day, rescheduling each alarm when it becomes due, and report
+* the distribution of the time taken by each reschedule. Each reschedule
+* consists of the KAEvent calls which KAlarmApp::rescheduleAlarm() makes,
+* followed by nextTrigger() to find the alarm's next due time.
+*/
+void RescheduleBenchmark::rescheduleDay()
+{
+    QList<KAEvent> events = activeEvents;
+    const KADateTime dayStart(generator.startDate, QTime(0, 0), generator.timeZone);
+    const qint64 dayEnd = dayStart.addDays(1).toSecsSinceEpoch();
+
+    QMultiMap<qint64, int> queue;    // next trigger time, index into events
+    for (int i = 0, count = events.count();  i < count;  ++i)
+    {
+        const DateTime next = events.at(i).nextTrigger(KAEvent::Trigger::All);
+        if (next.isValid()  &&  queueKey(next) < dayEnd)
+            queue.insert(queueKey(next), i);
+    }
+
+    int notDue = 0;
+    QList<qint64> rescheduleTimes;
+    QElapsedTimer timer;
+    while (!queue.isEmpty())
+    {
+        const qint64 key = queue.firstKey();
+        const int index = queue.take(key);
+        KADateTime now(dayStart);
+        now.setSecsSinceEpoch(key);
+
+        // Find the first alarm which is due.
+        KAEvent& event = events[index];
+        KAAlarm alarm;
+        for (KAAlarm a = event.firstAlarm();  a.isValid();  a = event.nextAlarm(a))
+        {
+            if (a.dateTime(true).effectiveKDateTime() <= now)
+            {
+                alarm = a;
+                break;
+            }
+        }
+        if (!alarm.isValid())
+        {
+            ++notDue;
+            continue;
+        }
+
+        timer.start();
+        bool done = false;
+        if (alarm.isReminder()  ||  alarm.deferred())
+            event.removeExpiredAlarm(alarm.type());
+        else if (!event.recurs()  ||  event.setNextOccurrence(now) == KAEvent::OccurType::None)
+            done = true;
+        DateTime next;
+        if (!done)
+            next = event.nextTrigger(KAEvent::Trigger::All);
+        rescheduleTimes += timer.nsecsElapsed();
+        if (next.isValid()  &&  queueKey(next) > key  &&  queueKey(next) < dayEnd)
+            queue.insert(queueKey(next), index);
+    }
+
+    QVERIFY(!rescheduleTimes.isEmpty());
+    std::sort(rescheduleTimes.begin(), rescheduleTimes.end());
+    qint64 total = 0;
+    for (qint64 t : std::as_const(rescheduleTimes))
+        total += t;
+    const qsizetype count = rescheduleTimes.count();
+    qInfo("Rescheduled %lld triggers in a day (%d not due): %lld ms in total",
+          static_cast<qint64>(count), notDue, total / 1000000);
+    qInfo("Time per reschedule: mean %lld us, median %lld us, 99%% %lld us, max %lld us",
+          total / count / 1000, rescheduleTimes.at(count / 2) / 1000, rescheduleTimes.at(count * 99 / 100) / 1000, rescheduleTimes.last() / 1000);
+}
+
+#include "moc_reschedulebenchmark.cpp"
+
+// vim: et sw=4:
@@ -0,0 +1,35 @@
+/*
+   This file is part of kalarmcal library, which provides access to KAlarm
+   calendar data.
+
+   SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+   SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+/**
+ * Micro-benchmark of KAEvent's rescheduling functions, nextTrigger() and
+ * setNextOccurrence(), for the mix of alarms in a synthetic calendar.
+ *
+ * This only measures the KAEvent calls. It does not exercise KAlarmApp's
+ * action queue, timers, resources or alarm actions.
+ *
+ * The calendar may be configured by setting the environment variable
+ * KALARM_BENCHMARK_CALENDAR to a CalendarGenerator option string, e.g.
+ *     KALARM_BENCHMARK_CALENDAR=count=200000,recur=60 reschedulebenchmark
+ */
+class RescheduleBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void nextTrigger();
+    void rescheduleDay();
+};
+
+// vim: et sw=4:
@@ -12,9 +12,40 @@
 
 #include <KHolidays/HolidayRegion>
 
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+
 namespace KAlarmCal
 {
 
+/*=============================================================================
+* Bit array containing one bit per day, set for non-working holidays, for the
+* whole cache period. It is calculated in a separate thread, since evaluating
+* holiday data for many years can take a significant time.
+* The calculation is done a year at a time, so that if the data is deleted
+* before it completes, the thread can be stopped without a long wait.
+*/
+struct Holidays::NonWorkingDays
+{
+    ~NonWorkingDays()
+    {
+        if (thread)
+        {
+            thread->requestInterruption();
+            thread->wait();
+            delete thread;
+        }
+    }
+
+    QDate             startDate;       // date of first bit
+    int               count {0};       // number of days
+    QBitArray         bits;            // one bit per day, set if non-working holiday
+    std::atomic<bool> ready {false};   // true once 'bits' has been calculated
+    QThread*          thread {nullptr};
+};
+
 Holidays::Holidays(const KHolidays::HolidayRegion& holidayRegion)
 {
     initialise(holidayRegion.regionCode());
@@ -34,6 +65,7 @@ void Holidays::setRegion(const KHolidays::HolidayRegion& holidayRegion)
         return;
     mTypes.clear();
     mNames.clear();
+    mNonWorkingDays.reset();
     initialise(holidayRegion.regionCode());
 }
 
@@ -46,6 +78,7 @@ void Holidays::setRegion(const QString& regionCode)
         return;
     mTypes.clear();
     mNames.clear();
+    mNonWorkingDays.reset();
     initialise(regionCode);
 }
 
@@ -63,9 +96,68 @@ void Holidays::initialise(const QString& regionCode)
         // Initially cache holiday data up to a year from today
         const int COUNT = 366;
         extendCache(mCacheStartDate.addDays(COUNT - 1));
+
+        calcNonWorkingDays();
     }
 }
 
+/******************************************************************************
+* Start calculating the non-working holidays for the whole cache period, in a
+* separate thread.
+*/
+void Holidays::calcNonWorkingDays()
+{
+    auto* data = new NonWorkingDays;
+    mNonWorkingDays.reset(data);
+    data->startDate = mCacheStartDate;
+    const QDate endDate(QDate::currentDate().year() + mCacheYears, 12, 31);
+    data->count = mCacheStartDate.daysTo(endDate) + 1;
+    const QString regionCode = mRegion->regionCode();
+    data->thread = QThread::create([data, regionCode, endDate]()
+    {
+        // Use a separate region instance, to avoid accessing the main one from
+        // two threads at once.
+        const KHolidays::HolidayRegion region(regionCode);
+        QBitArray bits(data->count);
+        for (QDate from = data->startDate;  from <= endDate;  from = QDate(from.year() + 1, 1, 1))
+        {
+            if (QThread::currentThread()->isInterruptionRequested())
+                return;
+            const KHolidays::Holiday::List hols = region.rawHolidaysWithAstroSeasons(from, QDate(from.year(), 12, 31));
+            for (const KHolidays::Holiday& h : hols)
+            {
+                if (h.dayType() == KHolidays::Holiday::NonWorkday)
+                {
+                    const int end = std::min<qint64>(data->startDate.daysTo(h.observedEndDate()), data->count - 1);
+                    for (int offset = std::max<qint64>(data->startDate.daysTo(h.observedStartDate()), 0);  offset <= end;  ++offset)
+                        bits.setBit(offset);
+                }
+            }
+        }
+        data->bits = bits;
+        data->ready.store(true, std::memory_order_release);
+    });
+    data->thread->start();
+}
+
+/******************************************************************************
+* Return the non-working holiday bit array, if it has been calculated.
+*/
+const Holidays::NonWorkingDays* Holidays::nonWorkingDays() const
+{
+    const NonWorkingDays* data = mNonWorkingDays.data();
+    return (data  &&  data->ready.load(std::memory_order_acquire)) ? data : nullptr;
+}
+
+/******************************************************************************
+* Return whether the non-working holidays for the whole cache period have been
+* calculated.
+*/
+bool Holidays::nonWorkingDaysReady() const
+{
+    return nonWorkingDays();
+}
+
 /******************************************************************************
 * Return the holiday region code.
 */
@@ -87,9 +179,43 @@ bool Holidays::isValid() const
 */
 bool Holidays::isHoliday(const QDate& date) const
 {
+    if (date < QDate::currentDate().addDays(-1))
+        return false;    // the same rule as in holidayType()
+    if (const NonWorkingDays* data = nonWorkingDays())
+    {
+        const qint64 offset = data->startDate.daysTo(date);
+        if (offset >= 0  &&  offset < data->count)
+            return data->bits.testBit(offset);
+    }
     return holidayType(date) == NonWorking;
 }
 
+/******************************************************************************
+* Find the first date on or after a given date which is not a non-working
+* holiday.
+*/
+QDate Holidays::nextNonHoliday(const QDate& date) const
+{
+    if (date < QDate::currentDate().addDays(-1))
+        return date;     // past dates are never holidays
+    QDate d = date;
+    if (const NonWorkingDays* data = nonWorkingDays())
+    {
+        qint64 offset = data->startDate.daysTo(date);
+        if (offset >= 0)
+        {
+            while (offset < data->count  &&  data->bits.testBit(offset))
+                ++offset;
+            d = data->startDate.addDays(offset);
+        }
+    }
+    // Check any dates which are outside the bit array, but give up after a
+    // year in case of a pathological holiday definition.
+    for (int i = 0;  i < 366  &&  isHoliday(d);  ++i)
+        d = d.addDays(1);
+    return d;
+}
+
 /******************************************************************************
 * Determine the holiday type for a date.
 */
@@ -140,7 +266,11 @@ QStringList Holidays::holidayNames(const QDate& date) const
 */
 void Holidays::setCacheYears(int years)
 {
+    if (years == mCacheYears)
+        return;
     mCacheYears = years;
+    if (isValid())
+        calcNonWorkingDays();
 }
 
 /******************************************************************************
@@ -67,11 +67,19 @@ public:
     bool isValid() const;
 
     /** Determine whether a date is a non-working holiday.
+     *  Within the cached period, this is a single bit test.
      *  @param date  date to check; must be today or later.
      *  @return whether a holiday, or false if date is earlier than today.
      */
     bool isHoliday(const QDate& date) const;
 
+    /** Find the first date, on or after a given date, which is not a
+     *  non-working holiday.
+     *  @param date  date to start from; must be today or later.
+     *  @return first date which is not a non-working holiday.
+     */
+    QDate nextNonHoliday(const QDate& date) const;
+
     /** Determine the holiday type for a date.
      *  @param date  date to check; must be today or later.
      *  @return holiday type, or None if date is earlier than today.
@@ -84,16 +92,27 @@ public:
      */
     QStringList holidayNames(const QDate& date) const;
 
+    /** Return whether the non-working holidays for the whole cache period have
+     *  been calculated. Until then, isHoliday() and nextNonHoliday() use the
+     *  slower holiday type cache.
+     */
+    bool nonWorkingDaysReady() const;
+
     /** Set the maximum cache size. The preset maximum size is 10 years. Only call
      *  this if the maximum size needs to be changed.
      */
     void setCacheYears(int years);
 
 private:
+    struct NonWorkingDays;
+
     void initialise(const QString& regionCode);
     void extendCache(const QDate& end) const;
+    void calcNonWorkingDays();
+    const NonWorkingDays* nonWorkingDays() const;
 
     QSharedPointer<const KHolidays::HolidayRegion> mRegion;
+    QSharedPointer<NonWorkingDays> mNonWorkingDays;   // non-working holidays for the whole cache period
 
     QDate         mCacheStartDate;   // start date for cached data arrays
     mutable QDate mNoCacheDate;      // first date past end of cached data arrays
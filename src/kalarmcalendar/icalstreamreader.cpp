@@ -0,0 +1,259 @@
+/*
+ *  icalstreamreader.cpp  -  incremental reader for iCalendar files
+ *  This file is part of kalarmcalendar library, which provides access to KAlarm
+ *  calendar data.
+ *  Program:  kalarm
+ *  SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *
+ *  SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "icalstreamreader.h"
+
+#include "kacalendar.h"
+#include "kalarmcal_debug.h"
+
+#include <KCalendarCore/ICalFormat>
+#include <KCalendarCore/MemoryCalendar>
+
+#include <QIODevice>
+
+using namespace KCalendarCore;
+
+namespace
+{
+const QByteArray BEGIN_PREFIX("BEGIN:");
+const QByteArray END_PREFIX("END:");
+const QByteArray VCALENDAR("VCALENDAR");
+const QByteArray VEVENT("VEVENT");
+}
+
+namespace KAlarmCal
+{
+
+ICalStreamReader::ICalStreamReader(QIODevice* device, const QTimeZone& timeZone)
+    : mDevice(device)
+    , mTimeZone(timeZone)
+    , mVersion(KACalendar::IncompatibleFormat)
+{
+}
+
+/******************************************************************************
+* Read up to 'maxCount' further events from the device, and convert them to the
+* current KAlarm format.
+* Lines are read until enough VEVENT components have been found, and then the
+* events are parsed together with the calendar's properties and non-event
+* components (which are needed to interpret the events' time zones).
+*/
+bool ICalStreamReader::readEvents(int maxCount, Event::List& events)
+{
+    QByteArray batch;
+    QByteArray event;
+    int count = 0;
+    while (count < maxCount  &&  readEventText(event))
+    {
+        batch += event;
+        ++count;
+    }
+
+    if (!count)
+        return true;
+    return parseEvents(batch, events);
+}
+
+/******************************************************************************
+* Read all the remaining VEVENT components from the device, without parsing
+* them.
+*/
+void ICalStreamReader::readEventTexts(QList<QByteArray>& events)
+{
+    QByteArray event;
+    while (readEventText(event))
+        events += event;
+}
+
+/******************************************************************************
+* Read lines from the device until a complete VEVENT component has been read.
+* Calendar properties and other components are stored as they are found.
+* Folded continuation lines (starting with a space or tab) are treated as
+* content, so that text which happens to start with BEGIN: or END: after
+* folding does not end a component.
+* Reply = false if the end of the device was reached first.
+*/
+bool ICalStreamReader::readEventText(QByteArray& event)
+{
+    while (!mDevice->atEnd())
+    {
+        QByteArray line = mDevice->readLine();
+        if (!line.endsWith('\n'))
+            line += "\r\n";
+        // Folded continuation lines are content, never component delimiters.
+        const bool continuation = line.startsWith(' ')  ||  line.startsWith('\t');
+        const QByteArray key = continuation ? QByteArray() : line.trimmed().toUpper();
+        const bool begin = key.startsWith(BEGIN_PREFIX);
+        const bool end   = key.startsWith(END_PREFIX);
+
+        switch (mSection)
+        {
+            case Section::Outside:
+                if (begin  &&  key.mid(BEGIN_PREFIX.size()) == VCALENDAR)
+                {
+                    // Start of a new calendar: discard the previous calendar's data.
+                    mProperties.clear();
+                    mComponents.clear();
+                    mVersionRead = false;
+                    mSection = Section::Calendar;
+                }
+                break;
+
+            case Section::Calendar:
+                if (end  &&  key.mid(END_PREFIX.size()) == VCALENDAR)
+                    mSection = Section::Outside;
+                else if (begin)
+                {
+                    mComponentDepth = 1;
+                    if (key.mid(BEGIN_PREFIX.size()) == VEVENT)
+                    {
+                        mEvent = line;
+                        mSection = Section::Event;
+                    }
+                    else
+                    {
+                        mComponents += line;
+                        mSection = Section::Component;
+                    }
+                }
+                else
+                    mProperties += line;
+                break;
+
+            case Section::Event:
+                mEvent += line;
+                if (begin)
+                    ++mComponentDepth;
+                else if (end  &&  !--mComponentDepth)
+                {
+                    event = mEvent;
+                    mEvent.clear();
+                    mSection = Section::Calendar;
+                    return true;
+                }
+                break;
+
+            case Section::Component:
+                mComponents += line;
+                if (begin)
+                    ++mComponentDepth;
+                else if (end  &&  !--mComponentDepth)
+                    mSection = Section::Calendar;
+                break;
+        }
+    }
+    return false;
+}
+
+/******************************************************************************
+* Return whether the whole calendar has been read.
+*/
+bool ICalStreamReader::atEnd() const
+{
+    return mDevice->atEnd();
+}
+
+/******************************************************************************
+* Set the KAlarm version which wrote the calendar, when it is already known.
+*/
+void ICalStreamReader::setFileVersion(int version)
+{
+    mFileVersion = version;
+    mVersionRead = true;
+}
+
+/******************************************************************************
+* Parse a batch of VEVENT components, convert them to the current KAlarm
+* format, and append them to a list.
+* The calendar's KAlarm version is only checked for the first batch, since all
+* batches share the same calendar properties. If the calendar is in the current
+* format, no conversion is done.
+*/
+bool ICalStreamReader::parseEvents(const QByteArray& events, Event::List& list)
+{
+    QByteArray text;
+    text.reserve(mProperties.size() + mComponents.size() + events.size() + 40);
+    text += "BEGIN:VCALENDAR\r\n";
+    text += mProperties;
+    text += mComponents;
+    text += events;
+    text += "END:VCALENDAR\r\n";
+
+    MemoryCalendar::Ptr calendar(new MemoryCalendar(mTimeZone));
+    ICalFormat format;
+    if (!format.fromRawString(calendar, text))
+    {
+        qCWarning(KALARMCAL_LOG) << "ICalStreamReader::parseEvents: Error parsing calendar events";
+        return false;
+    }
+    if (!mVersionRead)
+    {
+        mFileVersion = KACalendar::readVersion(calendar, mVersionString);
+        mVersionRead = true;
+    }
+    mVersion = KACalendar::convertVersion(calendar, mFileVersion);
+    list += calendar->rawEvents();
+    return true;
+}
+
+/******************************************************************************
+* Return the calendar's properties and non-event components which have been
+* read so far.
+*/
+QByteArray ICalStreamReader::header() const
+{
+    return mProperties + mComponents;
+}
+
+/******************************************************************************
+* Extract the UID from the text of a VEVENT component, without parsing it.
+* Folded lines are unfolded, and properties of nested components (e.g. VALARM)
+* are ignored.
+*/
+QString ICalStreamReader::eventUid(const QByteArray& event)
+{
+    auto startsWith = [](const QByteArray& line, const char* prefix, int length)
+    {
+        return line.size() >= length  &&  !qstrnicmp(line.constData(), prefix, length);
+    };
+
+    QByteArray uid;
+    bool inUid = false;
+    int depth = 0;
+    const QList<QByteArray> lines = event.split('\n');
+    for (QByteArray line : lines)
+    {
+        if (line.endsWith('\r'))
+            line.chop(1);
+        if (line.startsWith(' ')  ||  line.startsWith('\t'))
+        {
+            if (inUid)
+                uid += line.mid(1);   // continuation of a folded line
+            continue;
+        }
+        if (inUid)
+            break;
+        if (startsWith(line, "BEGIN:", 6))
+            ++depth;
+        else if (startsWith(line, "END:", 4))
+            --depth;
+        else if (depth == 1  &&  (startsWith(line, "UID:", 4)  ||  startsWith(line, "UID;", 4)))
+        {
+            const int colon = line.indexOf(':');
+            uid = line.mid(colon + 1);
+            inUid = true;
+        }
+    }
+    return QString::fromUtf8(uid);
+}
+
+} // namespace KAlarmCal
+
+// vim: et sw=4:
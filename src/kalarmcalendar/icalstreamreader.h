@@ -0,0 +1,138 @@
+/*
+ *  icalstreamreader.h  -  incremental reader for iCalendar files
+ *  This file is part of kalarmcalendar library, which provides access to KAlarm
+ *  calendar data.
+ *  Program:  kalarm
+ *  SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *
+ *  SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#pragma once
+
+#include "kalarmcal_export.h"
+
+#include <KCalendarCore/Event>
+
+#include <QByteArray>
+#include <QList>
+#include <QTimeZone>
+
+class QIODevice;
+
+namespace KAlarmCal
+{
+
+/**
+ * Class to read the events in an iCalendar file a few at a time, so that
+ * very large calendar files can be read without holding the whole calendar
+ * in memory.
+ *
+ * The file is split into VEVENT components, which are parsed in batches
+ * along with the calendar's properties and time zone definitions. Each batch
+ * of events is converted to the current KAlarm format if necessary.
+ *
+ * This class does not use the event loop, so it may be used in any thread.
+ */
+class KALARMCAL_EXPORT ICalStreamReader
+{
+public:
+    /** Constructor.
+     *  @param device    device to read the calendar from. It must already be
+     *                   open, and must remain valid while this instance exists.
+     *  @param timeZone  the time zone for the calendar.
+     */
+    explicit ICalStreamReader(QIODevice* device, const QTimeZone& timeZone = QTimeZone::utc());
+
+    /** Read the next batch of events from the device.
+     *  @param maxCount  maximum number of events to read.
+     *  @param events    the events read are appended to this list.
+     *  @return  true if successful, false if a parse error occurred.
+     */
+    bool readEvents(int maxCount, KCalendarCore::Event::List& events);
+
+    /** Read all the remaining VEVENT components from the device, as raw text
+     *  without parsing them. The text of each component may later be parsed
+     *  by parseEvents().
+     *  @param events  the text of each VEVENT component is appended to this list.
+     */
+    void readEventTexts(QList<QByteArray>& events);
+
+    /** Read the next VEVENT component from the device, as raw text without
+     *  parsing it.
+     *  @param event  receives the text of the VEVENT component.
+     *  @return  true if a component was read, false if the end of the device
+     *           was reached first.
+     */
+    bool readEventText(QByteArray& event);
+
+    /** Parse the text of one or more VEVENT components, and convert them to
+     *  the current KAlarm format. The calendar properties and time zone
+     *  definitions which have already been read from the device are used.
+     *  @param events  the concatenated text of the VEVENT components.
+     *  @param list    the events parsed are appended to this list.
+     *  @return  true if successful, false if a parse error occurred.
+     */
+    bool parseEvents(const QByteArray& events, KCalendarCore::Event::List& list);
+
+    /** Return the text of the calendar's properties and non-event components
+     *  which have been read so far.
+     */
+    QByteArray header() const;
+
+    /** Return the text of the calendar's properties which have been read so far. */
+    QByteArray properties() const   { return mProperties; }
+
+    /** Return the text of the calendar's non-event components (e.g. to-dos
+     *  and time zones) which have been read so far.
+     */
+    QByteArray components() const   { return mComponents; }
+
+    /** Return the UID contained in the text of a VEVENT component, without
+     *  parsing the component.
+     *  @return  UID, or empty if none was found.
+     */
+    static QString eventUid(const QByteArray& event);
+
+    /** Return whether the whole calendar has been read. */
+    bool atEnd() const;
+
+    /** Return the KAlarm format version of the calendar, as returned by
+     *  KACalendar::updateVersion(). This is only valid once some events have
+     *  been read.
+     */
+    int version() const       { return mVersion; }
+
+    /** Return the calendar's KAlarm version string. This is only valid once
+     *  some events have been read.
+     */
+    QString versionString() const   { return mVersionString; }
+
+    /** Set the KAlarm version which wrote the calendar, when it is already
+     *  known, so that parseEvents() does not need to read it from the events.
+     *  This applies until the start of the next calendar in the device is read.
+     *  versionString() is not set.
+     *  @param version  KAlarm version of the calendar, as returned by
+     *                  KACalendar::readVersion().
+     */
+    void setFileVersion(int version);
+
+private:
+    enum class Section { Outside, Calendar, Event, Component };
+
+    QIODevice* mDevice;
+    QTimeZone  mTimeZone;
+    QByteArray mProperties;        // calendar properties
+    QByteArray mComponents;        // calendar components other than VEVENT (e.g. time zones)
+    QByteArray mEvent;             // the VEVENT currently being read
+    QString    mVersionString;     // the calendar's KAlarm version string
+    Section    mSection {Section::Outside};
+    int        mComponentDepth {0};  // nesting depth within the current component
+    int        mVersion;           // the calendar's KAlarm format version
+    int        mFileVersion {0};   // the KAlarm version which wrote the calendar
+    bool       mVersionRead {false};  // mFileVersion has been read from the calendar
+};
+
+} // namespace KAlarmCal
+
+// vim: et sw=4:
@@ -0,0 +1,252 @@
+/*
+ *  icalstreamwriter.cpp  -  incremental writer for iCalendar files
+ *  This file is part of kalarmcalendar library, which provides access to KAlarm
+ *  calendar data.
+ *  Program:  kalarm
+ *  SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *
+ *  SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "icalstreamwriter.h"
+
+#include "kacalendar.h"
+#include "kalarmcal_debug.h"
+
+#include <KCalendarCore/ICalFormat>
+#include <KCalendarCore/MemoryCalendar>
+
+#include <QIODevice>
+
+using namespace KCalendarCore;
+
+namespace
+{
+const QByteArray BEGIN_PREFIX("BEGIN:");
+const QByteArray END_PREFIX("END:");
+const QByteArray TZID_PREFIX("TZID:");
+const QByteArray VCALENDAR("VCALENDAR");
+const QByteArray VEVENT("VEVENT");
+const QByteArray VTIMEZONE("VTIMEZONE");
+
+/******************************************************************************
+* Return the name of a property, given its upper case text.
+*/
+QByteArray propertyName(const QByteArray& key)
+{
+    qsizetype i = 0;
+    while (i < key.size()  &&  key[i] != ':'  &&  key[i] != ';')
+        ++i;
+    return key.left(i);
+}
+}
+
+namespace KAlarmCal
+{
+
+ICalStreamWriter::ICalStreamWriter(QIODevice* device)
+    : mDevice(device)
+{
+}
+
+/******************************************************************************
+* Set additional calendar properties to write.
+*/
+void ICalStreamWriter::setProperties(const QByteArray& properties)
+{
+    mExtraProperties = properties;
+}
+
+/******************************************************************************
+* Set a function to be called with the text of each VEVENT written.
+*/
+void ICalStreamWriter::setEventWrittenHandler(const std::function<void(const QByteArray&)>& handler)
+{
+    mEventWritten = handler;
+}
+
+/******************************************************************************
+* Serialise a batch of events, and write them to the device.
+* The batch is serialised as a complete calendar, from which the calendar
+* properties are written only for the first batch, and time zone definitions
+* are written only if they have not already been written.
+*/
+bool ICalStreamWriter::writeEvents(const Event::List& events)
+{
+    if (mError)
+        return false;
+    MemoryCalendar::Ptr calendar(new MemoryCalendar(QTimeZone::utc()));
+    KACalendar::setKAlarmVersion(calendar);
+    for (const Event::Ptr& event : events)
+        calendar->addEvent(event);
+    ICalFormat format;
+    return writeText(format.toString(calendar).toUtf8());
+}
+
+/******************************************************************************
+* Write already serialised components verbatim, after the calendar properties
+* if they have not yet been written.
+*/
+bool ICalStreamWriter::writeComponents(const QByteArray& components)
+{
+    if (mError)
+        return false;
+    if (!mStarted  &&  !writeEvents({}))
+        return false;
+    return writeText(components);
+}
+
+/******************************************************************************
+* Write the text of a calendar, or of top level components, to the device.
+* The calendar properties are written only if nothing has yet been written, and
+* time zone definitions are written only if they have not already been written.
+*/
+bool ICalStreamWriter::writeText(const QByteArray& text)
+{
+    QByteArray output;
+    QByteArray component;    // the top level component currently being processed
+    QByteArray componentType;
+    QByteArray tzid;
+    QSet<QByteArray> propertyNames;   // names of calendar properties written
+    bool inProperties = !mStarted;    // calendar properties are being written
+    int depth = 0;           // nesting depth within VCALENDAR
+    for (qsizetype start = 0;  start < text.size();  )
+    {
+        qsizetype end = text.indexOf('\n', start);
+        end = (end < 0) ? text.size() : end + 1;
+        QByteArray line = text.mid(start, end - start);
+        start = end;
+        if (!line.endsWith('\n'))
+            line += "\r\n";
+        // Folded continuation lines are content, never component delimiters.
+        const bool continuation = line.startsWith(' ')  ||  line.startsWith('\t');
+        const QByteArray key = continuation ? QByteArray() : line.trimmed().toUpper();
+
+        if (key.startsWith(BEGIN_PREFIX))
+        {
+            if (key.mid(BEGIN_PREFIX.size()) == VCALENDAR)
+            {
+                if (!mStarted)
+                    output += line;
+                continue;
+            }
+            if (inProperties)
+            {
+                // Properties must precede components.
+                const QByteArray extra = extraProperties(propertyNames);
+                output += extra;
+                mProperties += extra;
+                inProperties = false;
+            }
+            if (!depth++)
+            {
+                componentType = key.mid(BEGIN_PREFIX.size());
+                component.clear();
+                tzid.clear();
+            }
+            component += line;
+        }
+        else if (key.startsWith(END_PREFIX))
+        {
+            if (!depth)
+                continue;    // END:VCALENDAR
+            component += line;
+            if (!--depth)
+            {
+                // Write the component, unless it is a time zone which has
+                // already been written.
+                if (componentType == VEVENT)
+                {
+                    output += component;
+                    if (mEventWritten)
+                        mEventWritten(component);
+                }
+                else if (componentType != VTIMEZONE  ||  !mTimeZones.contains(tzid))
+                {
+                    if (componentType == VTIMEZONE)
+                        mTimeZones.insert(tzid);
+                    output += component;
+                    mComponents += component;
+                }
+            }
+        }
+        else if (depth)
+        {
+            component += line;
+            if (depth == 1  &&  componentType == VTIMEZONE  &&  key.startsWith(TZID_PREFIX))
+                tzid = line.trimmed().mid(TZID_PREFIX.size());
+        }
+        else if (inProperties)
+        {
+            // Calendar property, or a continuation of one.
+            output += line;
+            mProperties += line;
+            if (!continuation)
+                propertyNames.insert(propertyName(key));
+        }
+    }
+    if (inProperties)
+    {
+        const QByteArray extra = extraProperties(propertyNames);
+        output += extra;
+        mProperties += extra;
+    }
+    mStarted = true;
+    return write(output);
+}
+
+/******************************************************************************
+* Return the additional calendar properties whose names are not in a list of
+* properties which have already been written.
+*/
+QByteArray ICalStreamWriter::extraProperties(const QSet<QByteArray>& written) const
+{
+    QByteArray result;
+    bool include = false;
+    for (qsizetype start = 0;  start < mExtraProperties.size();  )
+    {
+        qsizetype end = mExtraProperties.indexOf('\n', start);
+        end = (end < 0) ? mExtraProperties.size() : end + 1;
+        QByteArray line = mExtraProperties.mid(start, end - start);
+        start = end;
+        if (!line.endsWith('\n'))
+            line += "\r\n";
+        // A continuation line belongs to the same property as the line before.
+        if (!line.startsWith(' ')  &&  !line.startsWith('\t'))
+            include = !written.contains(propertyName(line.trimmed().toUpper()));
+        if (include)
+            result += line;
+    }
+    return result;
+}
+
+/******************************************************************************
+* Finish writing the calendar.
+*/
+bool ICalStreamWriter::finish()
+{
+    if (!mStarted  &&  !writeEvents({}))
+        return false;
+    return write("END:VCALENDAR\r\n");
+}
+
+/******************************************************************************
+* Write data to the device.
+*/
+bool ICalStreamWriter::write(const QByteArray& data)
+{
+    if (mError)
+        return false;
+    mFileHash.addData(data);
+    if (mDevice->write(data) != data.size())
+    {
+        qCWarning(KALARMCAL_LOG) << "ICalStreamWriter::write: Error writing calendar:" << mDevice->errorString();
+        mError = true;
+        return false;
+    }
+    return true;
+}
+
+} // namespace KAlarmCal
+
+// vim: et sw=4:
@@ -0,0 +1,113 @@
+/*
+ *  icalstreamwriter.h  -  incremental writer for iCalendar files
+ *  This file is part of kalarmcalendar library, which provides access to KAlarm
+ *  calendar data.
+ *  Program:  kalarm
+ *  SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *
+ *  SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#pragma once
+
+#include "kalarmcal_export.h"
+
+#include <KCalendarCore/Event>
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QSet>
+
+#include <functional>
+
+class QIODevice;
+
+namespace KAlarmCal
+{
+
+/**
+ * Class to write events to an iCalendar file a few at a time, so that very
+ * large calendar files can be written without holding the whole calendar in
+ * memory.
+ *
+ * Each batch of events is serialised separately. The calendar properties,
+ * including the current KAlarm version, are written before the first batch,
+ * and each time zone definition is written only once.
+ *
+ * Components which have already been serialised, e.g. unchanged events and
+ * to-dos read from an existing calendar by ICalStreamReader, may be written
+ * verbatim, so that properties which KCalendarCore does not understand are
+ * preserved.
+ *
+ * This class does not use the event loop, so it may be used in any thread.
+ */
+class KALARMCAL_EXPORT ICalStreamWriter
+{
+public:
+    /** Constructor.
+     *  @param device  device to write the calendar to. It must already be
+     *                 open, and must remain valid while this instance exists.
+     */
+    explicit ICalStreamWriter(QIODevice* device);
+
+    /** Set additional calendar properties to write, e.g. those read from an
+     *  existing calendar by ICalStreamReader::properties(). Properties which
+     *  the writer sets itself (e.g. PRODID and the KAlarm version) are not
+     *  duplicated. This must be called before anything is written.
+     *  @param properties  the text of the properties.
+     */
+    void setProperties(const QByteArray& properties);
+
+    /** Set a function to be called with the text of each VEVENT component as
+     *  it is written. This allows the events to be identified when the file
+     *  is next read, without needing to read the file now.
+     */
+    void setEventWrittenHandler(const std::function<void(const QByteArray&)>& handler);
+
+    /** Write a batch of events to the device.
+     *  @param events  the events to write.
+     *  @return  true if successful, false if a write error occurred.
+     */
+    bool writeEvents(const KCalendarCore::Event::List& events);
+
+    /** Write already serialised top level components (e.g. VEVENT, VTODO,
+     *  VTIMEZONE) to the device without altering them. Time zone definitions
+     *  which have already been written are skipped.
+     *  @param components  the text of the components.
+     *  @return  true if successful, false if a write error occurred.
+     */
+    bool writeComponents(const QByteArray& components);
+
+    /** Finish writing the calendar. No further events may be written.
+     *  @return  true if successful, false if a write error occurred.
+     */
+    bool finish();
+
+    /** Return the text of the calendar properties and non-event components
+     *  which have been written, in the form returned by
+     *  ICalStreamReader::header() when the calendar is read.
+     */
+    QByteArray header() const    { return mProperties + mComponents; }
+
+    /** Return the MD5 hash of all the data written to the device. */
+    QByteArray fileHash() const  { return mFileHash.result(); }
+
+private:
+    bool       writeText(const QByteArray& text);
+    QByteArray extraProperties(const QSet<QByteArray>& written) const;
+    bool       write(const QByteArray& data);
+
+    QIODevice*         mDevice;
+    QByteArray         mExtraProperties;   // additional calendar properties to write
+    QByteArray         mProperties;        // calendar properties which have been written
+    QByteArray         mComponents;        // non-event components which have been written
+    std::function<void(const QByteArray&)> mEventWritten;  // called for each VEVENT written
+    QCryptographicHash mFileHash {QCryptographicHash::Md5};  // hash of all data written
+    QSet<QByteArray>   mTimeZones;         // IDs of time zones which have been written
+    bool               mStarted {false};   // the calendar properties have been written
+    bool               mError {false};     // a write error has occurred
+};
+
+} // namespace KAlarmCal
+
+// vim: et sw=4:
@@ -39,6 +39,8 @@ class Private
 {
 public:
     static int readKAlarmVersion(const FileStorage::Ptr&, QString& subVersion, QString& versionString);
+    static int readKAlarmVersion(const Calendar::Ptr&, bool empty, QString& subVersion, QString& versionString);
+    static int convertVersion(const Calendar::Ptr&, int version);
 
     static QByteArray mIcalProductId;
 };
@@ -81,18 +83,39 @@ int updateVersion(const FileStorage::Ptr& fileStorage, QString& versionString)
 {
     QString subVersion;
     const int version = Private::readKAlarmVersion(fileStorage, subVersion, versionString);
-    if (version == CurrentFormat)
-        return CurrentFormat;    // calendar is in the current KAlarm format
-    if (version == IncompatibleFormat  ||  version > KAEvent::currentCalendarVersion())
-        return IncompatibleFormat;    // calendar was created by another program, or an unknown version of KAlarm
+    return Private::convertVersion(fileStorage->calendar(), version);
+}
 
-    // Calendar was created by an earlier version of KAlarm.
-    // Convert events to current KAlarm format for when/if the calendar is saved.
-    qCDebug(KALARMCAL_LOG) << "KAlarm version" << version;
-    KAEvent::convertKCalEvents(fileStorage->calendar(), version);
-    // Set the new calendar version.
-    setKAlarmVersion(fileStorage->calendar());
-    return version;
+/******************************************************************************
+* Check the version of KAlarm which wrote a calendar held in memory, and convert
+* it to the current KAlarm format if possible.
+*/
+int updateVersion(const Calendar::Ptr& calendar, QString& versionString)
+{
+    QString subVersion;
+    const bool empty = calendar->rawEvents().isEmpty();
+    const int version = Private::readKAlarmVersion(calendar, empty, subVersion, versionString);
+    return Private::convertVersion(calendar, version);
+}
+
+/******************************************************************************
+* Check the version of KAlarm which wrote a calendar held in memory, without
+* converting it.
+*/
+int readVersion(const Calendar::Ptr& calendar, QString& versionString)
+{
+    QString subVersion;
+    const bool empty = calendar->rawEvents().isEmpty();
+    return Private::readKAlarmVersion(calendar, empty, subVersion, versionString);
+}
+
+/******************************************************************************
+* Convert a calendar held in memory to the current KAlarm format, given the
+* KAlarm version which wrote it.
+*/
+int convertVersion(const Calendar::Ptr& calendar, int version)
+{
+    return Private::convertVersion(calendar, version);
 }
 
 } // namespace KACalendar
@@ -105,25 +128,31 @@ int updateVersion(const FileStorage::Ptr& fileStorage, QString& versionString)
 *       = version number if created by another KAlarm version.
 */
 int Private::readKAlarmVersion(const FileStorage::Ptr& fileStorage, QString& subVersion, QString& versionString)
+{
+    qCDebug(KALARMCAL_LOG) << "File=" << fileStorage->fileName();
+    // An empty calendar file can be written to freely.
+    const QFileInfo fi(fileStorage->fileName());
+    return readKAlarmVersion(fileStorage->calendar(), !fi.size(), subVersion, versionString);
+}
+
+/******************************************************************************
+* Return the KAlarm version which wrote a calendar.
+* 'empty' indicates whether the calendar's source is empty, in which case it
+* is treated as being in the current format if it has no product ID.
+*/
+int Private::readKAlarmVersion(const Calendar::Ptr& calendar, bool empty, QString& subVersion, QString& versionString)
 {
     subVersion.clear();
-    Calendar::Ptr calendar = fileStorage->calendar();
     versionString = calendar->customProperty(KACalendar::APPNAME, VERSION_PROPERTY);
-    qCDebug(KALARMCAL_LOG) << "File=" << fileStorage->fileName() << ", version=" << versionString;
+    qCDebug(KALARMCAL_LOG) << "Version=" << versionString;
 
     if (versionString.isEmpty())
     {
         // Pre-KAlarm 1.4 defined the KAlarm version number in the PRODID field.
         // If another application has written to the file, this may not be present.
         const QString prodid = calendar->productId();
-        if (prodid.isEmpty())
-        {
-            // Check whether the calendar file is empty, in which case
-            // it can be written to freely.
-            const QFileInfo fi(fileStorage->fileName());
-            if (!fi.size())
-                return KACalendar::CurrentFormat;
-        }
+        if (prodid.isEmpty()  &&  empty)
+            return KACalendar::CurrentFormat;
 
         // Find the KAlarm identifier
         QString progname = QStringLiteral(" KAlarm ");
@@ -156,6 +185,27 @@ int Private::readKAlarmVersion(const FileStorage::Ptr& fileStorage, QString& sub
     return KAlarmCal::getVersionNumber(versionString, &subVersion);
 }
 
+/******************************************************************************
+* Convert a calendar to the current KAlarm format, given the KAlarm version
+* which wrote it.
+* Reply = the compatibility of the calendar, as for KACalendar::updateVersion().
+*/
+int Private::convertVersion(const Calendar::Ptr& calendar, int version)
+{
+    if (version == KACalendar::CurrentFormat)
+        return KACalendar::CurrentFormat;    // calendar is in the current KAlarm format
+    if (version == KACalendar::IncompatibleFormat  ||  version > KAEvent::currentCalendarVersion())
+        return KACalendar::IncompatibleFormat;    // calendar was created by another program, or an unknown version of KAlarm
+
+    // Calendar was created by an earlier version of KAlarm.
+    // Convert events to current KAlarm format for when/if the calendar is saved.
+    qCDebug(KALARMCAL_LOG) << "KAlarm version" << version;
+    KAEvent::convertKCalEvents(calendar, version);
+    // Set the new calendar version.
+    KACalendar::setKAlarmVersion(calendar);
+    return version;
+}
+
 //=============================================================================
 
 namespace CalEvent
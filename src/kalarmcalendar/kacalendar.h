@@ -82,6 +82,40 @@ enum
  */
 KALARMCAL_EXPORT int updateVersion(const KCalendarCore::FileStorage::Ptr&, QString& versionString);
 
+/** Check the version of KAlarm which wrote a calendar which has been read into
+ *  memory other than from a file (e.g. part of a calendar file which is being
+ *  read incrementally), and convert it to the current KAlarm format if possible.
+ *
+ *  @param calendar       calendar to check and convert
+ *  @param versionString  receives calendar's KAlarm version as a string
+ *  @return as for the FileStorage overload; a calendar containing no events
+ *          and with no product ID is treated as being in the current format.
+ */
+KALARMCAL_EXPORT int updateVersion(const KCalendarCore::Calendar::Ptr& calendar, QString& versionString);
+
+/** Check the version of KAlarm which wrote a calendar held in memory, without
+ *  converting it. This allows the version of a calendar which is read in parts
+ *  to be found just once, and then each part to be converted by
+ *  convertVersion().
+ *
+ *  @param calendar       calendar to check
+ *  @param versionString  receives calendar's KAlarm version as a string
+ *  @return CurrentFormat if the calendar is in the current KAlarm format;
+ *          IncompatibleFormat calendar is not a KAlarm format;
+ *          otherwise the KAlarm version which wrote the calendar
+ */
+KALARMCAL_EXPORT int readVersion(const KCalendarCore::Calendar::Ptr& calendar, QString& versionString);
+
+/** Convert the events in a calendar held in memory to the current KAlarm
+ *  format, given the KAlarm version which wrote it. Nothing is done if the
+ *  calendar is already in the current format.
+ *
+ *  @param calendar  calendar to convert
+ *  @param version   KAlarm version of the calendar, as returned by readVersion()
+ *  @return as for updateVersion().
+ */
+KALARMCAL_EXPORT int convertVersion(const KCalendarCore::Calendar::Ptr& calendar, int version);
+
 /** Set the KAlarm version custom property for a calendar. */
 KALARMCAL_EXPORT void setKAlarmVersion(const KCalendarCore::Calendar::Ptr&);
 
@@ -18,9 +18,12 @@
 #include <QSharedData>
 #include <QDataStream>
 #include <QLocale>
+#include <QHash>
+#include <QMutex>
 #include <QDebug>
 
 #include <limits>
+#include <type_traits>
 
 namespace
 {
@@ -2788,6 +2791,160 @@ QDataStream& operator>>(QDataStream& s, KADateTime& kdt)
     return s;
 }
 
+/*----------------------------------------------------------------------------*/
+
+static_assert(sizeof(KADateTime::Compact) <= 16, "KADateTime::Compact is too large");
+static_assert(std::is_trivially_copyable<KADateTime::Compact>::value, "KADateTime::Compact must be trivially copyable");
+
+namespace
+{
+
+// Table of the time zones used by KADateTime::Compact instances.
+// Time zones are never removed, so that indexes remain valid.
+struct CompactZones
+{
+    QMutex                 mutex;
+    QList<QTimeZone>       zones;
+    QHash<QByteArray, int> indexes;   // time zone ID -> index into 'zones'
+};
+
+CompactZones& compactZones()
+{
+    static CompactZones zones;
+    return zones;
+}
+
+}
+
+KADateTime::Compact::Compact(const KADateTime& dt)
+{
+    if (!dt.isValid())
+        return;
+    mType = dt.d->specType;
+    switch (mType)
+    {
+        case OffsetFromUTC:
+            mSpec = dt.utcOffset();
+            break;
+        case TimeZone:
+        {
+            const QTimeZone tz = dt.timeZone();
+            CompactZones& table = compactZones();
+            const QMutexLocker locker(&table.mutex);
+            auto it = table.indexes.constFind(tz.id());
+            if (it == table.indexes.constEnd())
+            {
+                it = table.indexes.insert(tz.id(), table.zones.count());
+                table.zones += tz;
+            }
+            mSpec = it.value();
+            break;
+        }
+        default:
+            break;
+    }
+    if (dt.d->dateOnly())
+    {
+        mFlags = DateOnly;
+        mValue = dt.d->date().toJulianDay();
+    }
+    else
+    {
+        QTimeZone local;
+        mValue = dt.d->toUtc(local).toMSecsSinceEpoch();
+    }
+}
+
+KADateTime::Spec KADateTime::Compact::spec() const
+{
+    switch (mType)
+    {
+        case UTC:
+            return Spec::UTC();
+        case OffsetFromUTC:
+            return Spec::OffsetFromUTC(mSpec);
+        case TimeZone:
+        {
+            CompactZones& table = compactZones();
+            const QMutexLocker locker(&table.mutex);
+            return Spec(table.zones.value(mSpec));
+        }
+        case LocalZone:
+            return Spec::LocalZone();
+        default:
+            return {};
+    }
+}
+
+KADateTime KADateTime::Compact::toDateTime() const
+{
+    if (mType == Invalid)
+        return {};
+    if (mFlags & DateOnly)
+        return KADateTime(QDate::fromJulianDay(mValue), spec());
+    const KADateTime utc(QDateTime::fromMSecsSinceEpoch(mValue, Qt::UTC), Spec::UTC());
+    return (mType == UTC) ? utc : utc.toTimeSpec(spec());
+}
+
+qint64 KADateTime::Compact::toMSecsSinceEpoch() const
+{
+    if (mType == Invalid)
+        return std::numeric_limits<qint64>::min();
+    if (mFlags & DateOnly)
+    {
+        QTimeZone local;
+        return toDateTime().d->toUtc(local).toMSecsSinceEpoch();
+    }
+    return mValue;
+}
+
+KADateTime::Compact KADateTime::Compact::addMSecs(qint64 msecs) const
+{
+    if (mType == Invalid)
+        return {};
+    Compact result(*this);
+    result.mValue += (mFlags & DateOnly) ? msecs / 86400000 : msecs;
+    return result;
+}
+
+qint64 KADateTime::Compact::secsTo(const Compact& other) const
+{
+    if (mType == Invalid  ||  other.mType == Invalid)
+        return 0;
+    if (isSimpleComparison(other))
+        return (mFlags & DateOnly) ? (other.mValue - mValue) * 86400 : (other.mValue - mValue) / 1000;
+    return toDateTime().secsTo(other.toDateTime());
+}
+
+bool KADateTime::Compact::operator==(const Compact& other) const
+{
+    if (isSimpleComparison(other))
+        return mValue == other.mValue;
+    return toDateTime() == other.toDateTime();
+}
+
+bool KADateTime::Compact::operator<(const Compact& other) const
+{
+    if (isSimpleComparison(other))
+        return mValue < other.mValue;
+    return toDateTime() < other.toDateTime();
+}
+
+/******************************************************************************
+* Return whether this value can be compared directly with another, without
+* converting to KADateTime. This is true if both are valid date/time values,
+* or if both are date-only values with the same time specification.
+*/
+bool KADateTime::Compact::isSimpleComparison(const Compact& other) const
+{
+    if (mType == Invalid  ||  other.mType == Invalid)
+        return false;
+    if (!(mFlags & DateOnly))
+        return !(other.mFlags & DateOnly);
+    return (other.mFlags & DateOnly)
+       &&  mType == other.mType  &&  mSpec == other.mSpec;
+}
+
 } // namespace KAlarmCal
 
 using KAlarmCal::KADateTime;
@@ -1464,6 +1464,88 @@ public:
      */
     static KADateTime realCurrentLocalDateTime();
 
+    /**
+     * @short A compact, trivially copyable representation of a KADateTime.
+     *
+     * Compact holds a date/time as a UTC instant in milliseconds, together
+     * with a small encoding of its time specification, in no more than 16
+     * bytes. It has no shared data, so copying and comparing it involve no
+     * reference counting, and storing it needs no separate heap allocation.
+     * It is suitable for caching large numbers of date/time values
+     * internally. Convert to and from KADateTime at API boundaries.
+     *
+     * Time zones are stored as an index into a table of the time zones which
+     * have been used. Date-only values are stored as the date, together with
+     * their time specification.
+     *
+     * @note Because a LocalZone date/time value is stored as a UTC instant, if
+     *       the system time zone changes, the instant is retained rather than
+     *       the local clock time, unlike KADateTime.
+     */
+    class KALARMCAL_EXPORT Compact
+    {
+    public:
+        /** Constructs an invalid value. */
+        Compact() = default;
+
+        /** Constructs a compact representation of a KADateTime. */
+        explicit Compact(const KADateTime& dt);
+
+        /** Returns the value as a KADateTime. */
+        KADateTime toDateTime() const;
+
+        /** Returns whether the value is valid. */
+        bool isValid() const    { return mType != Invalid; }
+
+        /** Returns whether the value is date-only. */
+        bool isDateOnly() const { return mFlags & DateOnly; }
+
+        /** Returns the time specification type. */
+        SpecType timeType() const  { return static_cast<SpecType>(mType); }
+
+        /** Returns the UTC time as milliseconds since 00:00:00 UTC 1st January
+         *  1970. For a date-only value, the start of its day is returned.
+         */
+        qint64 toMSecsSinceEpoch() const;
+
+        /** Returns the value with a number of milliseconds added.
+         *  A date-only value is adjusted by whole days, as for KADateTime::addMSecs().
+         */
+        Compact addMSecs(qint64 msecs) const;
+
+        /** Returns the value with a number of seconds added.
+         *  A date-only value is adjusted by whole days, as for KADateTime::addSecs().
+         */
+        Compact addSecs(qint64 secs) const  { return addMSecs(secs * 1000); }
+
+        /** Returns the number of seconds from this value to @p other. */
+        qint64 secsTo(const Compact& other) const;
+
+        /** Check whether this value is simultaneous with another.
+         *  The result is the same as for the equivalent KADateTime comparison.
+         */
+        bool operator==(const Compact& other) const;
+        bool operator!=(const Compact& other) const  { return !(*this == other); }
+
+        /** Check whether this value is earlier than another.
+         *  The result is the same as for the equivalent KADateTime comparison.
+         */
+        bool operator<(const Compact& other) const;
+        bool operator<=(const Compact& other) const  { return !(other < *this); }
+        bool operator>(const Compact& other) const   { return other < *this; }
+        bool operator>=(const Compact& other) const  { return !(*this < other); }
+
+    private:
+        enum Flag { DateOnly = 0x01 };
+        Spec spec() const;
+        bool isSimpleComparison(const Compact& other) const;
+
+        qint64  mValue {0};     // UTC milliseconds since epoch, or Julian day if date-only
+        qint32  mSpec {0};      // UTC offset in seconds, or time zone table index
+        quint8  mType {Invalid};  // SpecType
+        quint8  mFlags {0};
+    };
+
 private:
     QSharedDataPointer<KADateTimePrivate> d;
 };
@@ -1482,5 +1564,6 @@ KALARMCAL_EXPORT QDataStream& operator>>(QDataStream& in, KADateTime& dateTime);
 
 Q_DECLARE_METATYPE(KAlarmCal::KADateTime)
 Q_DECLARE_METATYPE(KAlarmCal::KADateTime::Spec)
+Q_DECLARE_TYPEINFO(KAlarmCal::KADateTime::Compact, Q_RELOCATABLE_TYPE);
 
 // vim: et sw=4:
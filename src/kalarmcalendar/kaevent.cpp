@@ -18,6 +18,10 @@
 
 #include <KLocalizedString>
 
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+
 using namespace KCalendarCore;
 
 namespace KAlarmCal
@@ -63,6 +67,68 @@ public:
 
 //=============================================================================
 
+// Holds an optional group of event properties, which is only allocated if any
+// property in the group has a non-default value. The data is shared between
+// copies of the event until one of them is changed.
+template <class T>
+class OptionalData
+{
+public:
+    const T* operator->() const  { return d ? d.constData() : &empty(); }
+    T&   edit()                  { if (!d) d = new T;  return *d; }
+    void set(const T& data)      { if (data == empty()) d.reset(); else d = new T(data); }
+    void clear()                 { d.reset(); }
+
+private:
+    static const T& empty()      { static const T e;  return e; }
+    QSharedDataPointer<T> d;
+};
+
+// Sound properties
+struct AudioData : public QSharedData
+{
+    QString file;                  // ATTACH: audio file to play
+    float   soundVolume{-1.0f};    // volume for sound file (range 0 - 1), or < 0 for unspecified
+    float   fadeVolume{-1.0f};     // initial volume for sound file (range 0 - 1), or < 0 for no fade
+    int     fadeSeconds{0};        // fade time (seconds) for sound file, or 0 if none
+    int     repeatSoundPause{-1};  // seconds to pause between sound file repetitions, or -1 if no repetition
+    bool operator==(const AudioData& o) const
+    { return file == o.file  &&  soundVolume == o.soundVolume  &&  fadeVolume == o.fadeVolume
+         &&  fadeSeconds == o.fadeSeconds  &&  repeatSoundPause == o.repeatSoundPause; }
+};
+
+// Pre- and post-alarm actions
+struct ActionData : public QSharedData
+{
+    QString preAction;             // command to execute before alarm is displayed
+    QString postAction;            // command to execute after alarm window is closed
+    KAEvent::ExtraActionOptions extraActionOptions;  // options for pre- or post-alarm actions
+    bool operator==(const ActionData& o) const
+    { return preAction == o.preAction  &&  postAction == o.postAction  &&  extraActionOptions == o.extraActionOptions; }
+};
+
+// Email properties
+struct EmailData : public QSharedData
+{
+    EmailAddressList addresses;    // ATTENDEE: addresses to send email to
+    QString          subject;      // SUMMARY: subject line of email
+    QStringList      attachments;  // ATTACH: email attachment file names
+    uint             fromIdentity{0};  // standard email identity uoid for 'From' field, or empty
+    bool operator==(const EmailData& o) const
+    { return fromIdentity == o.fromIdentity  &&  addresses == o.addresses  &&  subject == o.subject
+         &&  attachments == o.attachments; }
+};
+
+// Command alarm output properties
+struct CommandData : public QSharedData
+{
+    QString logFile;               // alarm output is to be logged to this URL
+    bool operator==(const CommandData& o) const
+    { return logFile == o.logFile; }
+};
+
+//=============================================================================
+
 class Q_DECL_HIDDEN KAEventPrivate : public QSharedData
 {
 public:
@@ -176,6 +242,8 @@ public:
     KAAlarm            firstAlarm() const;
     KAAlarm            nextAlarm(KAAlarm::Type) const;
     bool               updateKCalEvent(const KCalendarCore::Event::Ptr&, KAEvent::UidAction, bool setCustomProperties = true) const;
+    void               addKCalAlarms(const KCalendarCore::Event::Ptr&, QString& nextRecur, QString& repeat) const;
+    static bool        sameAlarms(const KCalendarCore::Alarm::List&, const KCalendarCore::Alarm::List&);
     DateTime           mainDateTime(bool withRepeats = false) const
     {
         return (withRepeats && mNextRepeat && mRepetition)
@@ -245,9 +313,6 @@ public:
                                            // saved resource ID (not the resource the event is in)
     QString            mName;              // name of the alarm
     QString            mText;              // message text, file URL, command, email body [or audio file for KAAlarm]
-    QString            mAudioFile;         // ATTACH: audio file to play
-    QString            mPreAction;         // command to execute before alarm is displayed
-    QString            mPostAction;        // command to execute after alarm window is closed
     DateTime           mStartDateTime;     // DTSTART and DTEND: start and end time for event
     KADateTime         mCreatedDateTime;   // CREATED: date event was created, or saved in archive calendar
     DateTime           mNextMainDateTime;  // next time to display the alarm, excluding repetitions
@@ -259,7 +324,6 @@ public:
     DateTime           mReminderAfterTime; // if mReminderActive true, time to trigger reminder AFTER the main alarm, or invalid if not pending
     ReminderType       mReminderActive{ReminderType::None}; // whether a reminder is due (before next, or after last, main alarm/recurrence)
     int                mDeferDefaultMinutes{0}; // default number of minutes for deferral dialog, or 0 to select time control
-    bool               mDeferDefaultDateOnly{false}; // select date-only by default in deferral dialog
     int                mRevision{0};           // SEQUENCE: revision number of the original alarm, or 0
     KARecurrence*      mRecurrence{nullptr};   // RECUR: recurrence specification, or 0 if none
     Repetition         mRepetition;            // sub-repetition count and interval
@@ -271,49 +335,46 @@ public:
     QColor             mBgColour;              // background colour of alarm message
     QColor             mFgColour;              // foreground colour of alarm message, or invalid for default
     QFont              mFont;                  // font of alarm message (ignored if mUseDefaultFont true)
-    uint               mEmailFromIdentity{0};  // standard email identity uoid for 'From' field, or empty
-    EmailAddressList   mEmailAddresses;        // ATTENDEE: addresses to send email to
-    QString            mEmailSubject;          // SUMMARY: subject line of email
-    QStringList        mEmailAttachments;      // ATTACH: email attachment file names
+    OptionalData<AudioData>   mAudio;          // sound properties
+    OptionalData<ActionData>  mExtraActions;   // pre- and post-alarm actions
+    OptionalData<EmailData>   mEmail;          // email properties
+    OptionalData<CommandData> mCommand;        // command output log file
     mutable QTime      mTriggerStartOfDay;     // start of day time used by calcTriggerTimes()
     mutable int        mChangeCount{0};        // >0 = inhibit calling calcTriggerTimes()
-    mutable bool       mTriggerChanged{false}; // true if need to recalculate trigger times
-    QString            mLogFile;               // alarm output is to be logged to this URL
-    float              mSoundVolume{-1.0f};    // volume for sound file (range 0 - 1), or < 0 for unspecified
-    float              mFadeVolume{-1.0f};     // initial volume for sound file (range 0 - 1), or < 0 for no fade
-    int                mFadeSeconds{0};        // fade time (seconds) for sound file, or 0 if none
-    int                mRepeatSoundPause{-1};  // seconds to pause between sound file repetitions, or -1 if no repetition
     int                mLateCancel{0};         // how many minutes late will cancel the alarm, or 0 for no cancellation
-    bool               mWakeFromSuspend{false}; // wake system from suspend when alarm is due
-    bool               mExcludeHolidays{false}; // don't trigger alarms on holidays
     mutable QString    mExcludeHolidayRegion;   // holiday region code used to exclude alarms on holidays (= mHolidays region when trigger calculated)
     mutable int        mWorkTimeOnly{0};         // non-zero to trigger alarm only during working hours (= mWorkTimeIndex when trigger calculated)
     KAEvent::SubAction mActionSubType;           // sub-action type for the event's main alarm
     CalEvent::Type     mCategory{CalEvent::EMPTY};   // event category (active, archived, template, ...)
-    KAEvent::ExtraActionOptions mExtraActionOptions; // options for pre- or post-alarm actions
     KACalendar::Compat mCompatibility{KACalendar::Current}; // event's storage format compatibility
-    bool               mReadOnly{false};         // event is read-only in its original calendar file
-    bool               mConfirmAck{false};       // alarm acknowledgement requires confirmation by user
-    bool               mUseDefaultFont;          // use default message font, not mFont
-    bool               mCommandScript{false};    // the command text is a script, not a shell command line
-    bool               mCommandXterm{false};     // command alarm is to be executed in a terminal window
-    bool               mCommandDisplay{false};   // command output is to be displayed in an alarm window
-    bool               mCommandHideError{false}; // don't show command execution errors to user
-    bool               mEmailBcc{false};         // blind copy the email to the user
-    bool               mBeep{false};             // whether to beep when the alarm is displayed
-    bool               mSpeak{false};            // whether to speak the message when the alarm is displayed
-    bool               mCopyToKOrganizer{false}; // KOrganizer should hold a copy of the event
-    bool               mReminderOnceOnly{false}; // the reminder is output only for the first recurrence
-    bool               mAutoClose{false};        // whether to close the alarm window after the late-cancel period
-    bool               mNotify{false};           // alarm should be shown by the notification system, not in a window
-    bool               mMainExpired;             // main alarm has expired (in which case a deferral alarm will exist)
-    bool               mRepeatAtLogin{false};    // whether to repeat the alarm at every login
-    bool               mArchiveRepeatAtLogin{false}; // if now archived, original event was repeat-at-login
-    bool               mArchive{false};          // event has triggered in the past, so archive it when closed
-    bool               mDisplaying{false};       // whether the alarm is currently being displayed (i.e. in displaying calendar)
-    bool               mDisplayingDefer{false};  // show Defer button (applies to displaying calendar only)
-    bool               mDisplayingEdit{false};   // show Edit button (applies to displaying calendar only)
-    bool               mEnabled;                 // false if event is disabled
+    size_t             mFingerprint{0};          // fingerprint of KCalendarCore::Event which the event was created from
+    // Boolean properties are stored as bit fields, to minimise memory use.
+    mutable bool       mTriggerChanged : 1 {false}; // true if need to recalculate trigger times
+    bool               mDeferDefaultDateOnly : 1 {false}; // select date-only by default in deferral dialog
+    bool               mWakeFromSuspend : 1 {false}; // wake system from suspend when alarm is due
+    bool               mExcludeHolidays : 1 {false}; // don't trigger alarms on holidays
+    bool               mReadOnly : 1 {false};         // event is read-only in its original calendar file
+    bool               mConfirmAck : 1 {false};       // alarm acknowledgement requires confirmation by user
+    bool               mUseDefaultFont : 1;           // use default message font, not mFont
+    bool               mCommandScript : 1 {false};    // the command text is a script, not a shell command line
+    bool               mCommandXterm : 1 {false};     // command alarm is to be executed in a terminal window
+    bool               mCommandDisplay : 1 {false};   // command output is to be displayed in an alarm window
+    bool               mCommandHideError : 1 {false}; // don't show command execution errors to user
+    bool               mEmailBcc : 1 {false};         // blind copy the email to the user
+    bool               mBeep : 1 {false};             // whether to beep when the alarm is displayed
+    bool               mSpeak : 1 {false};            // whether to speak the message when the alarm is displayed
+    bool               mCopyToKOrganizer : 1 {false}; // KOrganizer should hold a copy of the event
+    bool               mReminderOnceOnly : 1 {false}; // the reminder is output only for the first recurrence
+    bool               mAutoClose : 1 {false};        // whether to close the alarm window after the late-cancel period
+    bool               mNotify : 1 {false};           // alarm should be shown by the notification system, not in a window
+    bool               mMainExpired : 1;              // main alarm has expired (in which case a deferral alarm will exist)
+    bool               mRepeatAtLogin : 1 {false};    // whether to repeat the alarm at every login
+    bool               mArchiveRepeatAtLogin : 1 {false}; // if now archived, original event was repeat-at-login
+    bool               mArchive : 1 {false};          // event has triggered in the past, so archive it when closed
+    bool               mDisplaying : 1 {false};       // whether the alarm is currently being displayed (i.e. in displaying calendar)
+    bool               mDisplayingDefer : 1 {false};  // show Defer button (applies to displaying calendar only)
+    bool               mDisplayingEdit : 1 {false};   // show Edit button (applies to displaying calendar only)
+    bool               mEnabled : 1;                  // false if event is disabled
 
 public:
     static const QByteArray FLAGS_PROPERTY;
@@ -460,6 +521,10 @@ int              KAEventPrivate::mWorkTimeIndex = 1;
 
 static void setProcedureAlarm(const Alarm::Ptr&, const QString& commandLine);
 static QString reminderToString(int minutes);
+static QFont sharedFont(const QString& fontString);
+static size_t hashDateTime(size_t seed, const QDateTime&);
+static size_t eventFingerprint(const Event::Ptr&);
+static QString sharedString(const QString&);
 
 /*=============================================================================
 = Class KAEvent
@@ -532,7 +597,8 @@ KAEventPrivate::KAEventPrivate(const KADateTime& dateTime, const QString& name,
     }
     mText                   = (mActionSubType == KAEvent::SubAction::Command) ? text.trimmed()
                             : (mActionSubType == KAEvent::SubAction::Audio)   ? QString() : text;
-    mAudioFile              = (mActionSubType == KAEvent::SubAction::Audio) ? text : QString();
+    if (mActionSubType == KAEvent::SubAction::Audio)
+        mAudio.edit().file = text;
     set_deferral((flags & DEFERRAL) ? DeferType::Normal : DeferType::None);
     mRepeatAtLogin          = flags & KAEvent::REPEAT_AT_LOGIN;
     mConfirmAck             = flags & KAEvent::CONFIRM_ACK;
@@ -552,7 +618,8 @@ KAEventPrivate::KAEventPrivate(const KADateTime& dateTime, const QString& name,
     mReminderOnceOnly       = flags & KAEvent::REMINDER_ONCE;
     mAutoClose              = (flags & KAEvent::AUTO_CLOSE) && mLateCancel;
     mNotify                 = flags & KAEvent::NOTIFY;
-    mRepeatSoundPause       = (flags & KAEvent::REPEAT_SOUND) ? 0 : -1;
+    if (flags & KAEvent::REPEAT_SOUND)
+        mAudio.edit().repeatSoundPause = 0;
     mSpeak                  = (flags & KAEvent::SPEAK) && action != KAEvent::SubAction::Audio;
     mBeep                   = (flags & KAEvent::BEEP) && action != KAEvent::SubAction::Audio && !mSpeak;
     if (mRepeatAtLogin)
@@ -575,6 +642,7 @@ KAEvent::KAEvent(const KCalendarCore::Event::Ptr& event)
 }
 
 KAEventPrivate::KAEventPrivate(const KCalendarCore::Event::Ptr& event)
+    : mFingerprint(eventFingerprint(event))
 {
     startChanges();
     // Extract status from the event
@@ -726,7 +794,7 @@ KAEventPrivate::KAEventPrivate(const KCalendarCore::Event::Ptr& event)
         else if (prop == displayURL)
             mCommandDisplay = true;
         else
-            mLogFile = prop;
+            mCommand.edit().logFile = sharedString(prop);
     }
     prop = event->customProperty(KACalendar::APPNAME, REPEAT_PROPERTY);
     if (!prop.isEmpty())
@@ -790,13 +858,19 @@ KAEventPrivate::KAEventPrivate(const KCalendarCore::Event::Ptr& event)
                     break;
                 [[fallthrough]]; // Fall through to AUDIO_ALARM
             case AUDIO_ALARM:
-                mAudioFile   = data.cleanText;
-                mSpeak       = data.speak  &&  mAudioFile.isEmpty();
-                mBeep        = !mSpeak  &&  mAudioFile.isEmpty();
-                mSoundVolume = (!mBeep && !mSpeak) ? data.soundVolume : -1;
-                mFadeVolume  = (mSoundVolume >= 0  &&  data.fadeSeconds > 0) ? data.fadeVolume : -1;
-                mFadeSeconds = (mFadeVolume >= 0) ? data.fadeSeconds : 0;
-                mRepeatSoundPause = (!mBeep && !mSpeak) ? data.repeatSoundPause : -1;
+                mSpeak       = data.speak  &&  data.cleanText.isEmpty();
+                mBeep        = !mSpeak  &&  data.cleanText.isEmpty();
+                if (mBeep  ||  mSpeak)
+                    mAudio.clear();
+                else
+                {
+                    AudioData& audio = mAudio.edit();
+                    audio.file        = data.cleanText;
+                    audio.soundVolume = data.soundVolume;
+                    audio.fadeVolume  = (audio.soundVolume >= 0  &&  data.fadeSeconds > 0) ? data.fadeVolume : -1;
+                    audio.fadeSeconds = (audio.fadeVolume >= 0) ? data.fadeSeconds : 0;
+                    audio.repeatSoundPause = data.repeatSoundPause;
+                }
                 break;
             case AT_LOGIN_ALARM:
                 mRepeatAtLogin   = true;
@@ -846,11 +920,14 @@ KAEventPrivate::KAEventPrivate(const KCalendarCore::Event::Ptr& event)
                 break;
             }
             case PRE_ACTION_ALARM:
-                mPreAction          = data.cleanText;
-                mExtraActionOptions = data.extraActionOptions;
+            {
+                ActionData& actions = mExtraActions.edit();
+                actions.preAction          = data.cleanText;
+                actions.extraActionOptions = data.extraActionOptions;
                 break;
+            }
             case POST_ACTION_ALARM:
-                mPostAction = data.cleanText;
+                mExtraActions.edit().postAction = data.cleanText;
                 break;
             case INVALID_ALARM:
             default:
@@ -903,14 +980,18 @@ KAEventPrivate::KAEventPrivate(const KCalendarCore::Event::Ptr& event)
                             mFgColour = data.fgColour;
                             break;
                         case KAAlarm::Action::Email:
-                            mEmailFromIdentity = data.emailFromId;
-                            mEmailAddresses    = data.alarm->mailAddresses();
-                            mEmailSubject      = data.alarm->mailSubject();
-                            mEmailAttachments  = data.alarm->mailAttachments();
+                        {
+                            EmailData& email = mEmail.edit();
+                            email.fromIdentity = data.emailFromId;
+                            email.addresses    = data.alarm->mailAddresses();
+                            email.subject      = data.alarm->mailSubject();
+                            email.attachments  = data.alarm->mailAttachments();
                             break;
+                        }
                         case KAAlarm::Action::Audio:
                             // Already mostly handled above
-                            mRepeatSoundPause = data.repeatSoundPause;
+                            if (mAudio->repeatSoundPause != data.repeatSoundPause)
+                                mAudio.edit().repeatSoundPause = data.repeatSoundPause;
                             break;
                         default:
                             break;
@@ -1022,9 +1103,6 @@ void KAEventPrivate::copy(const KAEventPrivate& event)
     mResourceId              = event.mResourceId;
     mName                    = event.mName;
     mText                    = event.mText;
-    mAudioFile               = event.mAudioFile;
-    mPreAction               = event.mPreAction;
-    mPostAction              = event.mPostAction;
     mStartDateTime           = event.mStartDateTime;
     mCreatedDateTime         = event.mCreatedDateTime;
     mNextMainDateTime        = event.mNextMainDateTime;
@@ -1047,15 +1125,10 @@ void KAEventPrivate::copy(const KAEventPrivate& event)
     mBgColour                = event.mBgColour;
     mFgColour                = event.mFgColour;
     mFont                    = event.mFont;
-    mEmailFromIdentity       = event.mEmailFromIdentity;
-    mEmailAddresses          = event.mEmailAddresses;
-    mEmailSubject            = event.mEmailSubject;
-    mEmailAttachments        = event.mEmailAttachments;
-    mLogFile                 = event.mLogFile;
-    mSoundVolume             = event.mSoundVolume;
-    mFadeVolume              = event.mFadeVolume;
-    mFadeSeconds             = event.mFadeSeconds;
-    mRepeatSoundPause        = event.mRepeatSoundPause;
+    mAudio                   = event.mAudio;
+    mExtraActions            = event.mExtraActions;
+    mEmail                   = event.mEmail;
+    mCommand                 = event.mCommand;
     mLateCancel              = event.mLateCancel;
     mWakeFromSuspend         = event.mWakeFromSuspend;
     mExcludeHolidays         = event.mExcludeHolidays;
@@ -1063,8 +1136,8 @@ void KAEventPrivate::copy(const KAEventPrivate& event)
     mWorkTimeOnly            = event.mWorkTimeOnly;
     mActionSubType           = event.mActionSubType;
     mCategory                = event.mCategory;
-    mExtraActionOptions      = event.mExtraActionOptions;
     mCompatibility           = event.mCompatibility;
+    mFingerprint             = 0;    // a copy is only made in order to change it
     mReadOnly                = event.mReadOnly;
     mConfirmAck              = event.mConfirmAck;
     mUseDefaultFont          = event.mUseDefaultFont;
@@ -1200,12 +1273,11 @@ bool KAEventPrivate::updateKCalEvent(const Event::Ptr& ev, KAEvent::UidAction ui
         ev->setCustomProperty(KACalendar::APPNAME, LOG_PROPERTY, xtermURL);
     else if (mCommandDisplay)
         ev->setCustomProperty(KACalendar::APPNAME, LOG_PROPERTY, displayURL);
-    else if (!mLogFile.isEmpty())
-        ev->setCustomProperty(KACalendar::APPNAME, LOG_PROPERTY, mLogFile);
+    else if (!mCommand->logFile.isEmpty())
+        ev->setCustomProperty(KACalendar::APPNAME, LOG_PROPERTY, mCommand->logFile);
 
     ev->setCustomStatus(mEnabled ? QString() : DISABLED_STATUS);
     ev->setRevision(mRevision);
-    ev->clearAlarms();
 
     /* Always set DTSTART as date/time, and use the category "DATE" to indicate
      * a date-only event, instead of calling setAllDay(). This is necessary to
@@ -1218,11 +1290,75 @@ bool KAEventPrivate::updateKCalEvent(const Event::Ptr& ev, KAEvent::UidAction ui
      * (rather than relative to DTSTART or DTEND) can only be specified as a
      * UTC DATE-TIME value. So always use a time relative to DTSTART instead of
      * an absolute time.
+     * DTSTART is only set if it has changed, since setting it resets the
+     * event's cached recurrence data.
      */
-    ev->setDtStart(mStartDateTime.calendarDateTime());
+    const QDateTime dtStart = mStartDateTime.calendarDateTime();
+    const QDateTime evStart = ev->dtStart();
+    if (evStart != dtStart  ||  evStart.timeSpec() != dtStart.timeSpec()  ||  evStart.timeZone() != dtStart.timeZone())
+        ev->setDtStart(dtStart);
     ev->setAllDay(false);
     ev->setDtEnd(QDateTime());
 
+    // Set up the alarms. If the event already has alarms, they are only
+    // replaced if they differ from the new ones, so the new alarms are first
+    // built on a scratch event for comparison.
+    QString nextRecur;   // X-KDE-KALARM-NEXTRECUR property value
+    QString repeat;      // X-KDE-KALARM-REPEAT property value
+    if (ev->alarms().isEmpty())
+        addKCalAlarms(ev, nextRecur, repeat);
+    else
+    {
+        Event::Ptr newAlarms(new Event);
+        addKCalAlarms(newAlarms, nextRecur, repeat);
+        if (!sameAlarms(newAlarms->alarms(), ev->alarms()))
+        {
+            ev->clearAlarms();
+            addKCalAlarms(ev, nextRecur, repeat);
+        }
+    }
+    if (!nextRecur.isEmpty())
+        ev->setCustomProperty(KACalendar::APPNAME, NEXT_RECUR_PROPERTY, nextRecur);
+    if (!repeat.isEmpty())
+        ev->setCustomProperty(KACalendar::APPNAME, REPEAT_PROPERTY, repeat);
+
+    if (mRecurrence  &&  !ev->recurs())
+        mRecurrence->writeRecurrence(*ev->recurrence());
+    else if (mRecurrence)
+    {
+        // Only rewrite an existing recurrence if it has changed, to avoid
+        // resetting the event's cached recurrence data.
+        Recurrence recurrence;
+        mRecurrence->writeRecurrence(recurrence);
+        Recurrence* evRecurrence = ev->recurrence();
+        recurrence.recurrenceType();      // ensure that cached values are consistent
+        evRecurrence->recurrenceType();   // before comparing
+        if (!(recurrence == *evRecurrence))
+            mRecurrence->writeRecurrence(*evRecurrence);
+    }
+    else
+        ev->clearRecurrence();
+    if (mCreatedDateTime.isValid())
+        ev->setCreated(mCreatedDateTime.qDateTime());
+    ev->setReadOnly(readOnly);
+    ev->endUpdates();     // finally issue an update notification
+    return true;
+}
+
+/******************************************************************************
+* Add alarms to a KCalendarCore::Event, according to the KAEventPrivate data.
+* The values of the event's X-KDE-KALARM-NEXTRECUR and X-KDE-KALARM-REPEAT
+* properties are returned in 'nextRecur' and 'repeat'; they are empty if the
+* property is not required.
+*/
+void KAEventPrivate::addKCalAlarms(const Event::Ptr& ev, QString& nextRecur, QString& repeat) const
+{
+    // If it's an archived event, the event start date/time will be adjusted to its original
+    // value instead of its next occurrence, and the expired main alarm will be reinstated.
+    const bool archived = (mCategory == CalEvent::ARCHIVED);
+
+    nextRecur.clear();
+    repeat.clear();
     const DateTime dtMain = archived ? mStartDateTime : mNextMainDateTime;
     int      ancillaryType = 0;   // 0 = invalid, 1 = time, 2 = offset
     DateTime ancillaryTime;       // time for ancillary alarms (pre-action, extra audio, etc)
@@ -1237,8 +1373,7 @@ bool KAEventPrivate::updateKCalEvent(const Event::Ptr& ev, KAEvent::UidAction ui
         if (!archived  &&  checkRecur() != KARecurrence::NO_RECUR)
         {
             QDateTime dt = mNextMainDateTime.kDateTime().toTimeSpec(mStartDateTime.timeSpec()).qDateTime();
-            ev->setCustomProperty(KACalendar::APPNAME, NEXT_RECUR_PROPERTY,
-                                  QLocale::c().toString(dt, mNextMainDateTime.isDateOnly() ? QStringLiteral("yyyyMMdd") : QStringLiteral("yyyyMMddThhmmss")));
+            nextRecur = QLocale::c().toString(dt, mNextMainDateTime.isDateOnly() ? QStringLiteral("yyyyMMdd") : QStringLiteral("yyyyMMddThhmmss"));
         }
         // Add the main alarm
         initKCalAlarm(ev, 0, QStringList(), MAIN_ALARM);
@@ -1249,8 +1384,7 @@ bool KAEventPrivate::updateKCalEvent(const Event::Ptr& ev, KAEvent::UidAction ui
     {
         // Alarm repetition is normally held in the main alarm, but since
         // the main alarm has expired, store in a custom property.
-        const QString repparam = QStringLiteral("%1:%2").arg(mRepetition.intervalMinutes()).arg(mRepetition.count());
-        ev->setCustomProperty(KACalendar::APPNAME, REPEAT_PROPERTY, repparam);
+        repeat = QStringLiteral("%1:%2").arg(mRepetition.intervalMinutes()).arg(mRepetition.count());
     }
 
     // Add subsidiary alarms
@@ -1357,7 +1491,7 @@ bool KAEventPrivate::updateKCalEvent(const Event::Ptr& ev, KAEvent::UidAction ui
             ancillaryType = 1;
         }
     }
-    if ((mBeep  ||  mSpeak  ||  !mAudioFile.isEmpty())  &&  mActionSubType != KAEvent::SubAction::Audio)
+    if ((mBeep  ||  mSpeak  ||  !mAudio->file.isEmpty())  &&  mActionSubType != KAEvent::SubAction::Audio)
     {
         // A sound is specified
         if (ancillaryType == 2)
@@ -1365,7 +1499,7 @@ bool KAEventPrivate::updateKCalEvent(const Event::Ptr& ev, KAEvent::UidAction ui
         else
             initKCalAlarm(ev, ancillaryTime, QStringList(), AUDIO_ALARM);
     }
-    if (!mPreAction.isEmpty())
+    if (!mExtraActions->preAction.isEmpty())
     {
         // A pre-display action is specified
         if (ancillaryType == 2)
@@ -1373,7 +1507,7 @@ bool KAEventPrivate::updateKCalEvent(const Event::Ptr& ev, KAEvent::UidAction ui
         else
             initKCalAlarm(ev, ancillaryTime, QStringList(PRE_ACTION_TYPE), PRE_ACTION_ALARM);
     }
-    if (!mPostAction.isEmpty())
+    if (!mExtraActions->postAction.isEmpty())
     {
         // A post-display action is specified
         if (ancillaryType == 2)
@@ -1381,15 +1515,24 @@ bool KAEventPrivate::updateKCalEvent(const Event::Ptr& ev, KAEvent::UidAction ui
         else
             initKCalAlarm(ev, ancillaryTime, QStringList(POST_ACTION_TYPE), POST_ACTION_ALARM);
     }
+}
 
-    if (mRecurrence)
-        mRecurrence->writeRecurrence(*ev->recurrence());
-    else
-        ev->clearRecurrence();
-    if (mCreatedDateTime.isValid())
-        ev->setCreated(mCreatedDateTime.qDateTime());
-    ev->setReadOnly(readOnly);
-    ev->endUpdates();     // finally issue an update notification
+/******************************************************************************
+* Return whether two lists of alarms are identical, including their custom
+* properties.
+*/
+bool KAEventPrivate::sameAlarms(const Alarm::List& alarms1, const Alarm::List& alarms2)
+{
+    if (alarms1.count() != alarms2.count())
+        return false;
+    for (int i = 0, count = alarms1.count();  i < count;  ++i)
+    {
+        const Alarm::Ptr& alarm1 = alarms1[i];
+        const Alarm::Ptr& alarm2 = alarms2[i];
+        if (!(*alarm1 == *alarm2)
+        ||  alarm1->customProperties() != alarm2->customProperties())
+            return false;
+    }
     return true;
 }
 
@@ -1426,25 +1569,25 @@ Alarm::Ptr KAEventPrivate::initKCalAlarm(const KCalendarCore::Event::Ptr& event,
             setAudioAlarm(alarm);
             if (mSpeak)
                 flags << KAEventPrivate::SPEAK_FLAG;
-            if (mRepeatSoundPause >= 0)
+            if (mAudio->repeatSoundPause >= 0)
             {
                 // Alarm::setSnoozeTime() sets 5 seconds if duration parameter is zero,
                 // so repeat count = -1 represents 0 pause, -2 represents non-zero pause.
-                alarm->setRepeatCount(mRepeatSoundPause ? -2 : -1);
-                alarm->setSnoozeTime(Duration(mRepeatSoundPause, Duration::Seconds));
+                alarm->setRepeatCount(mAudio->repeatSoundPause ? -2 : -1);
+                alarm->setSnoozeTime(Duration(mAudio->repeatSoundPause, Duration::Seconds));
             }
             break;
         case PRE_ACTION_ALARM:
-            setProcedureAlarm(alarm, mPreAction);
-            if (mExtraActionOptions & KAEvent::ExecPreActOnDeferral)
+            setProcedureAlarm(alarm, mExtraActions->preAction);
+            if (mExtraActions->extraActionOptions & KAEvent::ExecPreActOnDeferral)
                 flags << KAEventPrivate::EXEC_ON_DEFERRAL_FLAG;
-            if (mExtraActionOptions & KAEvent::CancelOnPreActError)
+            if (mExtraActions->extraActionOptions & KAEvent::CancelOnPreActError)
                 flags << KAEventPrivate::CANCEL_ON_ERROR_FLAG;
-            if (mExtraActionOptions & KAEvent::DontShowPreActError)
+            if (mExtraActions->extraActionOptions & KAEvent::DontShowPreActError)
                 flags << KAEventPrivate::DONT_SHOW_ERROR_FLAG;
             break;
         case POST_ACTION_ALARM:
-            setProcedureAlarm(alarm, mPostAction);
+            setProcedureAlarm(alarm, mExtraActions->postAction);
             break;
         case MAIN_ALARM:
             alarm->setSnoozeTime(mRepetition.interval());
@@ -1483,17 +1626,17 @@ Alarm::Ptr KAEventPrivate::initKCalAlarm(const KCalendarCore::Event::Ptr& event,
                         flags += DONT_SHOW_ERROR_FLAG;
                     break;
                 case KAEvent::SubAction::Email:
-                    alarm->setEmailAlarm(mEmailSubject, mText, mEmailAddresses, mEmailAttachments);
-                    if (mEmailFromIdentity)
-                        flags << KAEventPrivate::EMAIL_ID_FLAG << QString::number(mEmailFromIdentity);
+                    alarm->setEmailAlarm(mEmail->subject, mText, mEmail->addresses, mEmail->attachments);
+                    if (mEmail->fromIdentity)
+                        flags << KAEventPrivate::EMAIL_ID_FLAG << QString::number(mEmail->fromIdentity);
                     break;
                 case KAEvent::SubAction::Audio:
                     setAudioAlarm(alarm);
-                    if (mRepeatSoundPause >= 0  &&  type == MAIN_ALARM)
+                    if (mAudio->repeatSoundPause >= 0  &&  type == MAIN_ALARM)
                     {
                         // Indicate repeating sound in the main alarm by a non-standard
                         // method, since it might have a sub-repetition too.
-                        alltypes << SOUND_REPEAT_TYPE << QString::number(mRepeatSoundPause);
+                        alltypes << SOUND_REPEAT_TYPE << QString::number(mAudio->repeatSoundPause);
                     }
                     break;
             }
@@ -1599,7 +1742,7 @@ KAEvent::Flags KAEventPrivate::flags() const
     KAEvent::Flags result{};
     if (mBeep)
         result |= KAEvent::BEEP;
-    if (mRepeatSoundPause >= 0)
+    if (mAudio->repeatSoundPause >= 0)
         result |= KAEvent::REPEAT_SOUND;
     if (mEmailBcc)
         result |= KAEvent::EMAIL_BCC;
@@ -1865,14 +2008,16 @@ bool KAEvent::commandHideError() const
 
 void KAEvent::setLogFile(const QString& logfile)
 {
-    d->mLogFile = logfile;
+    CommandData command;
+    command.logFile = sharedString(logfile);
+    d->mCommand.set(command);
     if (!logfile.isEmpty())
         d->mCommandDisplay = d->mCommandXterm = false;
 }
 
 QString KAEvent::logFile() const
 {
-    return d->mLogFile;
+    return d->mCommand->logFile;
 }
 
 bool KAEvent::confirmAck() const
@@ -1888,10 +2033,12 @@ bool KAEvent::copyToKOrganizer() const
 void KAEvent::setEmail(uint from, const KCalendarCore::Person::List& addresses, const QString& subject,
                        const QStringList& attachments)
 {
-    d->mEmailFromIdentity = from;
-    d->mEmailAddresses    = addresses;
-    d->mEmailSubject      = subject;
-    d->mEmailAttachments  = attachments;
+    EmailData email;
+    email.fromIdentity = from;
+    email.addresses    = addresses;
+    email.subject      = subject;
+    email.attachments  = attachments;
+    d->mEmail.set(email);
 }
 
 QString KAEvent::emailMessage() const
@@ -1901,22 +2048,22 @@ QString KAEvent::emailMessage() const
 
 uint KAEvent::emailFromId() const
 {
-    return d->mEmailFromIdentity;
+    return d->mEmail->fromIdentity;
 }
 
 KCalendarCore::Person::List KAEvent::emailAddressees() const
 {
-    return d->mEmailAddresses;
+    return d->mEmail->addresses;
 }
 
 QStringList KAEvent::emailAddresses() const
 {
-    return static_cast<QStringList>(d->mEmailAddresses);
+    return static_cast<QStringList>(d->mEmail->addresses);
 }
 
 QString KAEvent::emailAddresses(const QString& sep) const
 {
-    return d->mEmailAddresses.join(sep);
+    return d->mEmail->addresses.join(sep);
 }
 
 QString KAEvent::joinEmailAddresses(const KCalendarCore::Person::List& addresses, const QString& separator)
@@ -1926,27 +2073,27 @@ QString KAEvent::joinEmailAddresses(const KCalendarCore::Person::List& addresses
 
 QStringList KAEvent::emailPureAddresses() const
 {
-    return d->mEmailAddresses.pureAddresses();
+    return d->mEmail->addresses.pureAddresses();
 }
 
 QString KAEvent::emailPureAddresses(const QString& sep) const
 {
-    return d->mEmailAddresses.pureAddresses(sep);
+    return d->mEmail->addresses.pureAddresses(sep);
 }
 
 QString KAEvent::emailSubject() const
 {
-    return d->mEmailSubject;
+    return d->mEmail->subject;
 }
 
 QStringList KAEvent::emailAttachments() const
 {
-    return d->mEmailAttachments;
+    return d->mEmail->attachments;
 }
 
 QString KAEvent::emailAttachments(const QString& sep) const
 {
-    return d->mEmailAttachments.join(sep);
+    return d->mEmail->attachments.join(sep);
 }
 
 bool KAEvent::emailBcc() const
@@ -1963,49 +2110,46 @@ void KAEvent::setAudioFile(const QString& filename, float volume, float fadeVolu
 void KAEventPrivate::setAudioFile(const QString& filename, float volume, float fadeVolume, int fadeSeconds,
                                   int repeatPause, bool allowEmptyFile)
 {
-    mAudioFile = filename;
-    mSoundVolume = (!allowEmptyFile && filename.isEmpty()) ? -1 : volume;
-    if (mSoundVolume >= 0)
+    AudioData audio;
+    audio.file = filename;
+    audio.soundVolume = (!allowEmptyFile && filename.isEmpty()) ? -1 : volume;
+    if (audio.soundVolume >= 0)
     {
-        mFadeVolume  = (fadeSeconds > 0) ? fadeVolume : -1;
-        mFadeSeconds = (mFadeVolume >= 0) ? fadeSeconds : 0;
+        audio.fadeVolume  = (fadeSeconds > 0) ? fadeVolume : -1;
+        audio.fadeSeconds = (audio.fadeVolume >= 0) ? fadeSeconds : 0;
     }
-    else
-    {
-        mFadeVolume  = -1;
-        mFadeSeconds = 0;
-    }
-    mRepeatSoundPause = repeatPause;
+    audio.repeatSoundPause = repeatPause;
+    mAudio.set(audio);
 }
 
 QString KAEvent::audioFile() const
 {
-    return d->mAudioFile;
+    return d->mAudio->file;
 }
 
 float KAEvent::soundVolume() const
 {
-    return d->mSoundVolume;
+    return d->mAudio->soundVolume;
 }
 
 float KAEvent::fadeVolume() const
 {
-    return d->mSoundVolume >= 0 && d->mFadeSeconds ? d->mFadeVolume : -1;
+    return d->mAudio->soundVolume >= 0 && d->mAudio->fadeSeconds ? d->mAudio->fadeVolume : -1;
 }
 
 int KAEvent::fadeSeconds() const
 {
-    return d->mSoundVolume >= 0 && d->mFadeVolume >= 0 ? d->mFadeSeconds : 0;
+    return d->mAudio->soundVolume >= 0 && d->mAudio->fadeVolume >= 0 ? d->mAudio->fadeSeconds : 0;
 }
 
 bool KAEvent::repeatSound() const
 {
-    return d->mRepeatSoundPause >= 0;
+    return d->mAudio->repeatSoundPause >= 0;
 }
 
 int KAEvent::repeatSoundPause() const
 {
-    return d->mRepeatSoundPause;
+    return d->mAudio->repeatSoundPause;
 }
 
 bool KAEvent::beep() const
@@ -2048,24 +2192,26 @@ int KAEvent::templateAfterTime() const
 
 void KAEvent::setActions(const QString& pre, const QString& post, ExtraActionOptions options)
 {
-    d->mPreAction = pre;
-    d->mPostAction = post;
-    d->mExtraActionOptions = options;
+    ActionData actions;
+    actions.preAction          = pre;
+    actions.postAction         = post;
+    actions.extraActionOptions = options;
+    d->mExtraActions.set(actions);
 }
 
 QString KAEvent::preAction() const
 {
-    return d->mPreAction;
+    return d->mExtraActions->preAction;
 }
 
 QString KAEvent::postAction() const
 {
-    return d->mPostAction;
+    return d->mExtraActions->postAction;
 }
 
 KAEvent::ExtraActionOptions KAEvent::extraActionOptions() const
 {
-    return d->mExtraActionOptions;
+    return d->mExtraActions->extraActionOptions;
 }
 
 /******************************************************************************
@@ -3775,6 +3921,12 @@ bool KAEvent::compare(const KAEvent& other, Comparison comparison) const
 {
     return d->compare(*other.d, comparison);
 }
+
+size_t KAEvent::fingerprint() const
+{
+    return d->mFingerprint;
+}
+
 bool KAEventPrivate::compare(const KAEventPrivate& other, KAEvent::Comparison comparison) const
 {
     if (comparison & KAEvent::Compare::Id)
@@ -3857,7 +4009,7 @@ bool KAEventPrivate::compare(const KAEventPrivate& other, KAEvent::Comparison co
     {
         case KAEvent::SubAction::Command:
             if (mCommandScript != other.mCommandScript || mCommandXterm != other.mCommandXterm || mCommandDisplay != other.mCommandDisplay
-            ||  mCommandError != other.mCommandError || mCommandHideError != other.mCommandHideError || mLogFile != other.mLogFile)
+            ||  mCommandError != other.mCommandError || mCommandHideError != other.mCommandHideError || mCommand->logFile != other.mCommand->logFile)
                 return false;
             if (!mCommandDisplay)
                 break;
@@ -3873,16 +4025,16 @@ bool KAEventPrivate::compare(const KAEventPrivate& other, KAEvent::Comparison co
             ||  (mLateCancel  &&  mAutoClose != other.mAutoClose)
             ||  mDeferDefaultMinutes  != other.mDeferDefaultMinutes
             ||  (mDeferDefaultMinutes  &&  mDeferDefaultDateOnly != other.mDeferDefaultDateOnly)
-            ||  mPreAction            != other.mPreAction
-            ||  mPostAction           != other.mPostAction
-            ||  mExtraActionOptions   != other.mExtraActionOptions
+            ||  mExtraActions->preAction != other.mExtraActions->preAction
+            ||  mExtraActions->postAction != other.mExtraActions->postAction
+            ||  mExtraActions->extraActionOptions != other.mExtraActions->extraActionOptions
             ||  mCommandError         != other.mCommandError
             ||  mConfirmAck           != other.mConfirmAck
             ||  mNotify               != other.mNotify
             ||  mEmailId              != other.mEmailId
             ||  mBeep                 != other.mBeep
             ||  mSpeak                != other.mSpeak
-            ||  mAudioFile            != other.mAudioFile)
+            ||  mAudio->file         != other.mAudio->file)
                 return false;
             if (mReminderMinutes)
             {
@@ -3901,33 +4053,33 @@ bool KAEventPrivate::compare(const KAEventPrivate& other, KAEvent::Comparison co
                 ||  (mDeferral != DeferType::None  &&  mDeferralTime != other.mDeferralTime))
                     return false;
             }
-            if (mAudioFile.isEmpty())
+            if (mAudio->file.isEmpty())
                 break;
             [[fallthrough]]; // fall through to Audio
         case KAEvent::SubAction::Audio:
-            if (mRepeatSoundPause != other.mRepeatSoundPause)
+            if (mAudio->repeatSoundPause != other.mAudio->repeatSoundPause)
                 return false;
-            if (mSoundVolume >= 0)
+            if (mAudio->soundVolume >= 0)
             {
-                if (mSoundVolume != other.mSoundVolume)
+                if (mAudio->soundVolume != other.mAudio->soundVolume)
                     return false;
-                if (mFadeVolume >= 0)
+                if (mAudio->fadeVolume >= 0)
                 {
-                    if (mFadeVolume  != other.mFadeVolume
-                    ||  mFadeSeconds != other.mFadeSeconds)
+                    if (mAudio->fadeVolume  != other.mAudio->fadeVolume
+                    ||  mAudio->fadeSeconds != other.mAudio->fadeSeconds)
                         return false;
                 }
-                else if (other.mFadeVolume >= 0)
+                else if (other.mAudio->fadeVolume >= 0)
                     return false;
             }
-            else if (other.mSoundVolume >= 0)
+            else if (other.mAudio->soundVolume >= 0)
                 return false;
             break;
         case KAEvent::SubAction::Email:
-            if (mEmailFromIdentity != other.mEmailFromIdentity
-            ||  mEmailAddresses    != other.mEmailAddresses
-            ||  mEmailSubject      != other.mEmailSubject
-            ||  mEmailAttachments  != other.mEmailAttachments
+            if (mEmail->fromIdentity != other.mEmail->fromIdentity
+            ||  mEmail->addresses    != other.mEmail->addresses
+            ||  mEmail->subject      != other.mEmail->subject
+            ||  mEmail->attachments  != other.mEmail->attachments
             ||  mEmailBcc          != other.mEmailBcc)
                 return false;
             break;
@@ -4004,12 +4156,12 @@ void KAEventPrivate::dumpDebug() const
         if (!mUseDefaultFont)
             qCDebug(KALARMCAL_LOG) << "-- mFont:" << mFont.toString();
         qCDebug(KALARMCAL_LOG) << "-- mSpeak:" << mSpeak;
-        qCDebug(KALARMCAL_LOG) << "-- mAudioFile:" << mAudioFile;
-        qCDebug(KALARMCAL_LOG) << "-- mPreAction:" << mPreAction;
-        qCDebug(KALARMCAL_LOG) << "-- mExecPreActOnDeferral:" << (mExtraActionOptions & KAEvent::ExecPreActOnDeferral);
-        qCDebug(KALARMCAL_LOG) << "-- mCancelOnPreActErr:" << (mExtraActionOptions & KAEvent::CancelOnPreActError);
-        qCDebug(KALARMCAL_LOG) << "-- mDontShowPreActErr:" << (mExtraActionOptions & KAEvent::DontShowPreActError);
-        qCDebug(KALARMCAL_LOG) << "-- mPostAction:" << mPostAction;
+        qCDebug(KALARMCAL_LOG) << "-- mAudioFile:" << mAudio->file;
+        qCDebug(KALARMCAL_LOG) << "-- mPreAction:" << mExtraActions->preAction;
+        qCDebug(KALARMCAL_LOG) << "-- mExecPreActOnDeferral:" << (mExtraActions->extraActionOptions & KAEvent::ExecPreActOnDeferral);
+        qCDebug(KALARMCAL_LOG) << "-- mCancelOnPreActErr:" << (mExtraActions->extraActionOptions & KAEvent::CancelOnPreActError);
+        qCDebug(KALARMCAL_LOG) << "-- mDontShowPreActErr:" << (mExtraActions->extraActionOptions & KAEvent::DontShowPreActError);
+        qCDebug(KALARMCAL_LOG) << "-- mPostAction:" << mExtraActions->postAction;
         qCDebug(KALARMCAL_LOG) << "-- mLateCancel:" << mLateCancel;
         qCDebug(KALARMCAL_LOG) << "-- mAutoClose:" << mAutoClose;
         qCDebug(KALARMCAL_LOG) << "-- mNotify:" << mNotify;
@@ -4020,35 +4172,35 @@ void KAEventPrivate::dumpDebug() const
         qCDebug(KALARMCAL_LOG) << "-- mCommandXterm:" << mCommandXterm;
         qCDebug(KALARMCAL_LOG) << "-- mCommandDisplay:" << mCommandDisplay;
         qCDebug(KALARMCAL_LOG) << "-- mCommandHideError:" << mCommandHideError;
-        qCDebug(KALARMCAL_LOG) << "-- mLogFile:" << mLogFile;
+        qCDebug(KALARMCAL_LOG) << "-- mLogFile:" << mCommand->logFile;
     }
     else if (mActionSubType == KAEvent::SubAction::Email)
     {
-        qCDebug(KALARMCAL_LOG) << "-- mEmail: FromKMail:" << mEmailFromIdentity;
-        qCDebug(KALARMCAL_LOG) << "--         Addresses:" << mEmailAddresses.join(QStringLiteral(","));
-        qCDebug(KALARMCAL_LOG) << "--         Subject:" << mEmailSubject;
-        qCDebug(KALARMCAL_LOG) << "--         Attachments:" << mEmailAttachments.join(QLatin1Char(','));
+        qCDebug(KALARMCAL_LOG) << "-- mEmail: FromKMail:" << mEmail->fromIdentity;
+        qCDebug(KALARMCAL_LOG) << "--         Addresses:" << mEmail->addresses.join(QStringLiteral(","));
+        qCDebug(KALARMCAL_LOG) << "--         Subject:" << mEmail->subject;
+        qCDebug(KALARMCAL_LOG) << "--         Attachments:" << mEmail->attachments.join(QLatin1Char(','));
         qCDebug(KALARMCAL_LOG) << "--         Bcc:" << mEmailBcc;
     }
     else if (mActionSubType == KAEvent::SubAction::Audio)
-        qCDebug(KALARMCAL_LOG) << "-- mAudioFile:" << mAudioFile;
+        qCDebug(KALARMCAL_LOG) << "-- mAudioFile:" << mAudio->file;
     qCDebug(KALARMCAL_LOG) << "-- mBeep:" << mBeep;
-    if (mActionSubType == KAEvent::SubAction::Audio  ||  !mAudioFile.isEmpty())
+    if (mActionSubType == KAEvent::SubAction::Audio  ||  !mAudio->file.isEmpty())
     {
-        if (mSoundVolume >= 0)
+        if (mAudio->soundVolume >= 0)
         {
-            qCDebug(KALARMCAL_LOG) << "-- mSoundVolume:" << mSoundVolume;
-            if (mFadeVolume >= 0)
+            qCDebug(KALARMCAL_LOG) << "-- mSoundVolume:" << mAudio->soundVolume;
+            if (mAudio->fadeVolume >= 0)
             {
-                qCDebug(KALARMCAL_LOG) << "-- mFadeVolume:" << mFadeVolume;
-                qCDebug(KALARMCAL_LOG) << "-- mFadeSeconds:" << mFadeSeconds;
+                qCDebug(KALARMCAL_LOG) << "-- mFadeVolume:" << mAudio->fadeVolume;
+                qCDebug(KALARMCAL_LOG) << "-- mFadeSeconds:" << mAudio->fadeSeconds;
             }
             else
                 qCDebug(KALARMCAL_LOG) << "-- mFadeVolume:-:";
         }
         else
             qCDebug(KALARMCAL_LOG) << "-- mSoundVolume:-:";
-        qCDebug(KALARMCAL_LOG) << "-- mRepeatSoundPause:" << mRepeatSoundPause;
+        qCDebug(KALARMCAL_LOG) << "-- mRepeatSoundPause:" << mAudio->repeatSoundPause;
     }
     qCDebug(KALARMCAL_LOG) << "-- mEmailId:" << mEmailId;
     qCDebug(KALARMCAL_LOG) << "-- mCopyToKOrganizer:" << mCopyToKOrganizer;
@@ -4279,7 +4431,7 @@ void KAEventPrivate::readAlarm(const Alarm::Ptr& alarm, AlarmData& data, bool au
             }
             data.defaultFont = (n <= 2 || list[2].isEmpty());
             if (!data.defaultFont)
-                data.font.fromString(list[2]);
+                data.font = sharedFont(list[2]);
             break;
         }
         case Alarm::Email:
@@ -4525,7 +4677,10 @@ void KAEventPrivate::calcTriggerTimes() const
         KADateTime kdt;
         for (int i = 0;  i < 20;  ++i)
         {
+            // Skip straight past any consecutive holidays, to find the next
+            // occurrence on or after the first day which is not a holiday.
             kdt = nextTrigger.effectiveKDateTime();
+            kdt.setDate(mHolidays->nextNonHoliday(kdt.date().addDays(1)).addDays(-1));
             kdt.setTime(QTime(23, 59, 59));
             const KAEvent::OccurType type = nextOccurrence(kdt, nextTrigger, KAEvent::Repeats::Return);
             if (!nextTrigger.isValid())
@@ -5099,10 +5254,10 @@ bool KAEventPrivate::mayOccurDailyDuringWork(const KADateTime& kdt) const
 */
 void KAEventPrivate::setAudioAlarm(const Alarm::Ptr& alarm) const
 {
-    alarm->setAudioAlarm(mAudioFile);  // empty for a beep or for speaking
-    if (mSoundVolume >= 0)
+    alarm->setAudioAlarm(mAudio->file);  // empty for a beep or for speaking
+    if (mAudio->soundVolume >= 0)
         alarm->setCustomProperty(KACalendar::APPNAME, VOLUME_PROPERTY,
-                                 QStringLiteral("%1;%2;%3").arg(QString::number(mSoundVolume, 'f', 2), QString::number(mFadeVolume, 'f', 2), QString::number(mFadeSeconds)));
+                                 QStringLiteral("%1;%2;%3").arg(QString::number(mAudio->soundVolume, 'f', 2), QString::number(mAudio->fadeVolume, 'f', 2), QString::number(mAudio->fadeSeconds)));
 }
 
 /******************************************************************************
@@ -6279,6 +6434,140 @@ QString reminderToString(int minutes)
     return QStringLiteral("%1%2").arg(count).arg(unit);
 }
 
+/******************************************************************************
+* Return a font parsed from its string representation. Events with the same
+* font share the same font data, instead of each holding a separate copy.
+* Events may be created in any thread, so access is serialised.
+* The number of fonts held is limited, since it isn't possible to tell which
+* fonts are no longer used by any event. When the limit is reached, the fonts
+* held are released; events which use them keep their own references.
+*/
+QFont sharedFont(const QString& fontString)
+{
+    const int MAX_FONTS = 100;
+    static QMutex mutex;
+    static QHash<QString, QFont> fonts;
+    const QMutexLocker locker(&mutex);
+    auto it = fonts.constFind(fontString);
+    if (it == fonts.constEnd())
+    {
+        if (fonts.size() >= MAX_FONTS)
+            fonts.clear();
+        QFont font;
+        font.fromString(fontString);
+        it = fonts.insert(fontString, font);
+    }
+    return it.value();
+}
+
+/******************************************************************************
+* Combine a date/time into a hash value. qHash(QDateTime) only uses the UTC
+* time, so the time specification and time zone are added, so that a change
+* of time zone which leaves the UTC time unchanged alters the hash.
+*/
+size_t hashDateTime(size_t seed, const QDateTime& dt)
+{
+    seed = qHashMulti(seed, dt, static_cast<int>(dt.timeSpec()));
+    if (dt.timeSpec() == Qt::TimeZone)
+        seed = qHash(dt.timeZone().id(), seed);
+    else if (dt.timeSpec() == Qt::OffsetFromUTC)
+        seed = qHash(dt.offsetFromUtc(), seed);
+    return seed;
+}
+
+/******************************************************************************
+* Calculate a fingerprint of a KCalendarCore::Event's data. This includes all
+* the properties which are used to initialise a KAEvent, so that if two events
+* have the same fingerprint, the KAEvents created from them will be the same.
+*/
+size_t eventFingerprint(const Event::Ptr& event)
+{
+    size_t h = qHashMulti(0, event->uid(), event->revision(), event->summary(), event->isReadOnly(),
+                          event->allDay(), static_cast<int>(event->status()), event->customStatus());
+    h = hashDateTime(h, event->created());
+    h = hashDateTime(h, event->dtStart());
+    h = hashDateTime(h, event->dtEnd());
+    const QMap<QByteArray, QString> properties = event->customProperties();
+    for (auto it = properties.constBegin();  it != properties.constEnd();  ++it)
+        h = qHashMulti(h, it.key(), it.value());
+
+    const Recurrence* recurrence = event->recurrence();
+    if (recurrence->recurs())
+    {
+        const RecurrenceRule::List rules = recurrence->rRules() + recurrence->exRules();
+        for (const RecurrenceRule* rule : rules)
+        {
+            h = qHashMulti(h, static_cast<int>(rule->recurrenceType()), rule->frequency(), rule->duration(),
+                           rule->allDay(), rule->weekStart(),
+                           rule->bySeconds(), rule->byMinutes(), rule->byHours(), rule->byMonthDays(),
+                           rule->byYearDays(), rule->byWeekNumbers(), rule->byMonths(), rule->bySetPos());
+            h = hashDateTime(h, rule->startDt());
+            h = hashDateTime(h, rule->endDt());
+            const QList<RecurrenceRule::WDayPos> days = rule->byDays();
+            for (const RecurrenceRule::WDayPos& day : days)
+                h = qHashMulti(h, day.day(), day.pos());
+        }
+        h = qHashMulti(h, recurrence->rDates(), recurrence->exDates());
+        for (const QList<QDateTime>& dateTimes : {recurrence->rDateTimes(), recurrence->exDateTimes()})
+        {
+            h = qHash(dateTimes.count(), h);
+            for (const QDateTime& dt : dateTimes)
+                h = hashDateTime(h, dt);
+        }
+    }
+
+    const Alarm::List alarms = event->alarms();
+    for (const Alarm::Ptr& alarm : alarms)
+    {
+        h = qHashMulti(h, static_cast<int>(alarm->type()), alarm->enabled(), alarm->text(), alarm->mailText(),
+                       alarm->mailSubject(), alarm->mailAttachments(), alarm->audioFile(),
+                       alarm->programFile(), alarm->programArguments(), alarm->repeatCount(),
+                       alarm->snoozeTime().asSeconds(), alarm->snoozeTime().isDaily());
+        if (alarm->hasTime())
+            h = hashDateTime(h, alarm->time());
+        if (alarm->hasStartOffset())
+            h = qHashMulti(h, alarm->startOffset().asSeconds(), alarm->startOffset().isDaily());
+        if (alarm->hasEndOffset())
+            h = qHashMulti(h, alarm->endOffset().asSeconds(), alarm->endOffset().isDaily());
+        const Person::List addresses = alarm->mailAddresses();
+        for (const Person& address : addresses)
+            h = qHashMulti(h, address.name(), address.email());
+        const QMap<QByteArray, QString> alarmProperties = alarm->customProperties();
+        for (auto it = alarmProperties.constBegin();  it != alarmProperties.constEnd();  ++it)
+            h = qHashMulti(h, it.key(), it.value());
+    }
+    return h ? h : 1;    // 0 indicates no fingerprint
+}
+
+/******************************************************************************
+* Return a string with the same value as the parameter, which shares its data
+* with all other strings returned which have the same value.
+* When the number of strings held reaches a limit, strings which are no longer
+* used outside the set are removed. If that doesn't free enough space, all the
+* strings are released.
+*/
+QString sharedString(const QString& str)
+{
+    if (str.isEmpty())
+        return {};
+    const int MAX_STRINGS = 1000;
+    static QMutex mutex;
+    static QSet<QString> strings;
+    const QMutexLocker locker(&mutex);
+    auto it = strings.constFind(str);
+    if (it == strings.constEnd())
+    {
+        if (strings.size() >= MAX_STRINGS)
+        {
+            strings.removeIf([](const QString& s) { return s.isDetached(); });
+            if (strings.size() >= MAX_STRINGS / 2)
+                strings.clear();
+        }
+        it = strings.insert(str);
+    }
+    return *it;
+}
+
 } // namespace KAlarmCal
 
 // vim: et sw=4:
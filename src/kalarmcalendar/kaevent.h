@@ -1365,6 +1365,17 @@ public:
      */
     bool compare(const KAEvent& other, Comparison comparison) const;
 
+    /** Return a fingerprint of the calendar data which the event was created
+     *  from. Events created from identical KCalendarCore::Event data have the
+     *  same fingerprint, so this may be used to check quickly whether an event
+     *  has changed when a calendar is reloaded.
+     *  The fingerprint is only valid within the current process.
+     *  @return fingerprint, or 0 if the event was not created from a
+     *          KCalendarCore::Event, or if its data has been detached from a
+     *          shared copy in order to change it.
+     */
+    size_t fingerprint() const;
+
     /** Call before making a group of changes to the event, to avoid unnecessary
      *  calculation intensive recalculations of trigger times from being
      *  performed until all the changes have been applied. When the changes
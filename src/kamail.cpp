@@ -31,13 +31,16 @@
 #include <KFileItem>
 #include <KIO/StatJob>
 #include <KIO/StoredTransferJob>
-#include <KJobWidgets>
 #include <KEMailSettings>
 #include <KCodecs>
 #include <KShell>
 
 #include <QUrl>
 #include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QHash>
 #include <QHostInfo>
 #include <QList>
 #include <QByteArray>
@@ -64,6 +67,27 @@ void                        initHeaders(KMime::Message&, JobData&);
 KMime::Types::Mailbox::List parseAddresses(const QString& text, QString& invalidItem);
 QString                     extractEmailAndNormalize(const QString& emailAddress);
 QByteArray                  autoDetectCharset(const QString& text);
+
+// Details of remote attachment files, from the last time each was checked.
+// Downloaded contents are also cached, and are reused only while a fresh stat
+// shows the same modification time and size.
+struct AttachmentInfo
+{
+    QDateTime  modified;          // the file's modification time
+    KIO::filesize_t size {0};     // the file's size
+    QByteArray contents;          // the file's contents, if cached
+    bool       valid {false};     // the file exists, is not a folder, and is readable
+};
+const qsizetype ATTACHMENT_CACHE_FILE_MAX = 1024 * 1024;      // largest file whose contents are cached
+const qsizetype ATTACHMENT_CACHE_MAX      = 8 * 1024 * 1024;  // maximum total size of cached contents
+QHash<QUrl, AttachmentInfo> attachmentCache;
+qsizetype attachmentCacheBytes = 0;   // total size of cached contents
+
+QUrl attachmentUrl(const QString& attachment);
+void statAttachment(const QUrl&, QObject* context, const std::function<void(bool)>& result);
+AttachmentInfo storeAttachment(const QUrl&, KIO::StatJob*);
+void cacheAttachmentContents(const QUrl&, const QDateTime& modified, const QByteArray& contents);
+void removeAttachment(const QUrl&);
 }
 
 QString KAMail::i18n_NeedFromEmailAddress()
@@ -84,6 +108,9 @@ KAMail* KAMail::instance()
 
 /******************************************************************************
 * Send the email message specified in an event.
+* If the email has remote attachments, they are first downloaded in the
+* background, and the email is then sent. In this case, the result is notified
+* by KAlarmApp::emailSent().
 * Reply = 1 if the message was sent - 'errmsgs' may contain copy error messages.
 *       = 0 if the message is queued for sending.
 *       = -1 if the message was not sent - 'errmsgs' contains the error messages.
@@ -132,6 +159,8 @@ int KAMail::send(JobData& jobdata, QStringList& errmsgs)
         return -1;
     }
     jobdata.bcc  = (jobdata.event.emailBcc() ? Preferences::emailBccAddress() : QString());
+    if (fetchAttachments(jobdata))
+        return 0;    // the email will be sent once its attachments have been downloaded
     qCDebug(KALARM_LOG) << "KAMail::send: To:" << jobdata.event.emailAddresses(QStringLiteral(","))
                         << "\nSubject:" << jobdata.event.emailSubject();
 
@@ -284,37 +313,16 @@ QString KAMail::appendBodyAttachments(KMime::Message& message, JobData& data)
             const QUrl url = QUrl::fromUserInput(attachment, QString(), QUrl::AssumeLocalFile);
             const QString attachError = xi18nc("@info", "Error attaching file: <filename>%1</filename>", attachment);
             QByteArray contents;
-            bool atterror = false;
             if (!url.isLocalFile())
             {
-                auto statJob = KIO::stat(url, KIO::StatJob::SourceSide, KIO::StatDetail::StatDefaultDetails);
-                KJobWidgets::setWindow(statJob, MainWindow::mainMainWindow());
-                if (!statJob->exec())
-                {
-                    qCCritical(KALARM_LOG) << "KAMail::appendBodyAttachments: Not found:" << attachment;
-                    return xi18nc("@info", "Attachment not found: <filename>%1</filename>", attachment);
-                }
-                KFileItem fi(statJob->statResult(), url);
-                if (fi.isDir()  ||  !fi.isReadable())
-                {
-                    qCCritical(KALARM_LOG) << "KAMail::appendBodyAttachments: Not file/not readable:" << attachment;
-                    return attachError;
-                }
-
-                // Read the file contents
-                auto downloadJob = KIO::storedGet(url);
-                KJobWidgets::setWindow(downloadJob, MainWindow::mainMainWindow());
-                if (!downloadJob->exec())
+                // The file contents have already been downloaded by fetchAttachments().
+                auto it = data.attachmentData.constFind(att);
+                if (it == data.attachmentData.constEnd())
                 {
-                    qCCritical(KALARM_LOG) << "KAMail::appendBodyAttachments: Load failure:" << attachment;
+                    qCCritical(KALARM_LOG) << "KAMail::appendBodyAttachments: Not downloaded:" << attachment;
                     return attachError;
                 }
-                contents = downloadJob->data();
-                if (static_cast<unsigned>(contents.size()) < fi.size())
-                {
-                    qCDebug(KALARM_LOG) << "KAMail::appendBodyAttachments: Read error:" << attachment;
-                    atterror = true;
-                }
+                contents = it.value();
             }
             else
             {
@@ -346,14 +354,119 @@ QString KAMail::appendBodyAttachments(KMime::Message& message, JobData& data)
             content->setHeader(cte);
             content->assemble();
             message.addContent(content);
-            if (atterror)
-                return attachError;
         }
         message.assemble();
     }
     return {};
 }
 
+/******************************************************************************
+* Start downloading the next remote attachment of an email which has not yet
+* been downloaded. When all have been downloaded, the email is sent.
+* Each file is checked first. If its modification time and size are the same as
+* when it was last downloaded, the cached contents are used instead.
+* Reply = true if a download has been started,
+*       = false if there are no remote attachments still to download.
+*/
+bool KAMail::fetchAttachments(const JobData& jobdata)
+{
+    const QStringList attachments = jobdata.event.emailAttachments();
+    for (const QString& att : attachments)
+    {
+        if (jobdata.attachmentData.contains(att))
+            continue;
+        const QString attachment = QString::fromLatin1(att.toLocal8Bit());
+        const QUrl url = QUrl::fromUserInput(attachment, QString(), QUrl::AssumeLocalFile);
+        if (url.isLocalFile())
+            continue;
+
+        auto statJob = KIO::stat(url, KIO::StatJob::SourceSide, KIO::StatDetail::StatDefaultDetails, KIO::HideProgressInfo);
+        connect(statJob, &KJob::result, instance(), [jobdata, att, attachment, url](KJob* job)
+        {
+            JobData data(jobdata);
+            if (job->error())
+            {
+                qCCritical(KALARM_LOG) << "KAMail::fetchAttachments: Not found:" << attachment;
+                removeAttachment(url);
+                resumeSend(data, xi18nc("@info", "Attachment not found: <filename>%1</filename>", attachment));
+                return;
+            }
+            const AttachmentInfo info = storeAttachment(url, static_cast<KIO::StatJob*>(job));
+            if (!info.valid)
+            {
+                qCCritical(KALARM_LOG) << "KAMail::fetchAttachments: Not file/not readable:" << attachment;
+                resumeSend(data, xi18nc("@info", "Error attaching file: <filename>%1</filename>", attachment));
+                return;
+            }
+            if (info.size  &&  static_cast<KIO::filesize_t>(info.contents.size()) == info.size)
+            {
+                qCDebug(KALARM_LOG) << "KAMail::fetchAttachments: Using cached contents:" << attachment;
+                data.attachmentData[att] = info.contents;
+                resumeSend(data, QString());
+                return;
+            }
+            downloadAttachment(data, att, url, info.size, info.modified);
+        });
+        return true;
+    }
+    return false;
+}
+
+/******************************************************************************
+* Download the contents of a remote attachment in the background, and then
+* continue sending the email.
+* 'size' and 'modified' are the file's size and modification time, as found by
+* checking it just before the download.
+*/
+void KAMail::downloadAttachment(const JobData& jobdata, const QString& att, const QUrl& url,
+                                KIO::filesize_t size, const QDateTime& modified)
+{
+    auto downloadJob = KIO::storedGet(url, KIO::NoReload, KIO::HideProgressInfo);
+    connect(downloadJob, &KJob::result, instance(), [jobdata, att, url, size, modified](KJob* job)
+    {
+        JobData data(jobdata);
+        const QString attachment = QString::fromLatin1(att.toLocal8Bit());
+        const QString attachError = xi18nc("@info", "Error attaching file: <filename>%1</filename>", attachment);
+        if (job->error())
+        {
+            qCCritical(KALARM_LOG) << "KAMail::downloadAttachment: Load failure:" << attachment;
+            removeAttachment(url);
+            resumeSend(data, attachError);
+            return;
+        }
+        const QByteArray contents = static_cast<KIO::StoredTransferJob*>(job)->data();
+        if (static_cast<KIO::filesize_t>(contents.size()) < size)
+        {
+            qCDebug(KALARM_LOG) << "KAMail::downloadAttachment: Read error:" << attachment;
+            resumeSend(data, attachError);
+            return;
+        }
+        if (static_cast<KIO::filesize_t>(contents.size()) == size)
+            cacheAttachmentContents(url, modified, contents);
+        else
+            qCDebug(KALARM_LOG) << "KAMail::downloadAttachment: File has changed:" << attachment;
+        data.attachmentData[att] = contents;
+        resumeSend(data, QString());
+    });
+}
+
+/******************************************************************************
+* Continue sending an email once a remote attachment has been downloaded, or
+* report an error if downloading failed.
+*/
+void KAMail::resumeSend(JobData& jobdata, const QString& error)
+{
+    if (!error.isEmpty())
+    {
+        theApp()->emailSent(jobdata, errors(error), false);
+        return;
+    }
+    QStringList errmsgs;
+    const int ans = send(jobdata, errmsgs);
+    if (ans)
+        theApp()->emailSent(jobdata, errmsgs, (ans > 0));
+}
+
 /******************************************************************************
 * If any of the destination email addresses are non-local, display a
 * notification message saying that an email has been queued for sending.
@@ -510,28 +623,57 @@ int KAMail::checkAttachment(QString& attachment, QUrl* url)
         return 0;
     }
     // Check that the file exists
-    QUrl u = QUrl::fromUserInput(attachment, QString(), QUrl::AssumeLocalFile);
-    u.setPath(QDir::cleanPath(u.path()));
+    const QUrl u = attachmentUrl(attachment);
     if (url)
         *url = u;
     return checkAttachment(u) ? 1 : -1;
 }
 
 /******************************************************************************
-* Check for the existence of the attachment file.
+* Check for the existence of the attachment file, without blocking.
+* Local files are checked directly. For remote files, the result of the last
+* check is used. If the file has not been checked, a check is started in the
+* background and the file is accepted for now; it is checked again before the
+* email is sent.
 */
 bool KAMail::checkAttachment(const QUrl& url)
 {
-    auto statJob = KIO::stat(url);
-    KJobWidgets::setWindow(statJob, MainWindow::mainMainWindow());
-    if (!statJob->exec())
-        return false;       // doesn't exist
-    KFileItem fi(statJob->statResult(), url);
-    if (fi.isDir()  ||  !fi.isReadable())
-        return false;
+    if (url.isLocalFile())
+    {
+        const QFileInfo fi(url.toLocalFile());
+        return fi.exists()  &&  !fi.isDir()  &&  fi.isReadable();
+    }
+
+    auto it = attachmentCache.constFind(url);
+    if (it != attachmentCache.constEnd())
+        return it->valid;
+    statAttachment(url, instance(), {});
     return true;
 }
 
+/******************************************************************************
+* Check for the existence of the attachment file, without blocking.
+* For a remote file, this fetches its current details in the background and
+* caches them, so that a subsequent checkAttachment() call can use them.
+* If 'result' is specified, it is called in the thread of 'context' with the
+* result of the check. If 'context' is deleted first, it is not called.
+*/
+void KAMail::checkAttachmentAsync(const QString& attachment, QObject* context,
+                                  const std::function<void(bool)>& result)
+{
+    const QString att = attachment.trimmed();
+    if (att.isEmpty())
+        return;
+    const QUrl url = attachmentUrl(att);
+    if (url.isLocalFile())
+    {
+        if (result)
+            result(checkAttachment(url));
+        return;
+    }
+    statAttachment(url, context, result);
+}
+
 /******************************************************************************
 * Set the appropriate error messages for a given error string.
 */
@@ -551,6 +693,95 @@ QStringList KAMail::errors(const QString& err, ErrType prefix)
 namespace
 {
 
+/******************************************************************************
+* Return the URL for an attachment file name.
+*/
+QUrl attachmentUrl(const QString& attachment)
+{
+    QUrl url = QUrl::fromUserInput(attachment, QString(), QUrl::AssumeLocalFile);
+    url.setPath(QDir::cleanPath(url.path()));
+    return url;
+}
+
+/******************************************************************************
+* Check a remote attachment file in the background, and cache its details.
+* If 'result' is specified, it is called in the thread of 'context' with the
+* result of the check.
+*/
+void statAttachment(const QUrl& url, QObject* context, const std::function<void(bool)>& result)
+{
+    auto statJob = KIO::stat(url, KIO::StatJob::SourceSide, KIO::StatDetail::StatDefaultDetails, KIO::HideProgressInfo);
+    QObject::connect(statJob, &KJob::result, context, [url, result](KJob* job)
+    {
+        bool ok = false;
+        if (job->error())
+            removeAttachment(url);
+        else
+            ok = storeAttachment(url, static_cast<KIO::StatJob*>(job)).valid;
+        if (result)
+            result(ok);
+    });
+}
+
+/******************************************************************************
+* Cache the details of a remote attachment file from a successful stat job.
+* If the file's modification time or size has changed, its cached contents are
+* discarded.
+* Reply = the file's cached details.
+*/
+AttachmentInfo storeAttachment(const QUrl& url, KIO::StatJob* job)
+{
+    const KFileItem fi(job->statResult(), url);
+    const QDateTime modified = fi.time(KFileItem::ModificationTime);
+    AttachmentInfo& cached = attachmentCache[url];
+    if (!modified.isValid()  ||  modified != cached.modified  ||  fi.size() != cached.size)
+    {
+        attachmentCacheBytes -= cached.contents.size();
+        cached.contents.clear();
+        cached.modified = modified;
+        cached.size     = fi.size();
+    }
+    cached.valid = !fi.isDir()  &&  fi.isReadable();
+    return cached;
+}
+
+/******************************************************************************
+* Cache the downloaded contents of a remote attachment file, provided that its
+* details have not changed since it was checked. Only the contents of small
+* files are cached, and the total cached is limited.
+*/
+void cacheAttachmentContents(const QUrl& url, const QDateTime& modified, const QByteArray& contents)
+{
+    if (!modified.isValid()  ||  contents.size() > ATTACHMENT_CACHE_FILE_MAX)
+        return;
+    auto it = attachmentCache.find(url);
+    if (it == attachmentCache.end()
+    ||  it->modified != modified  ||  it->size != static_cast<KIO::filesize_t>(contents.size()))
+        return;
+    if (attachmentCacheBytes - it->contents.size() + contents.size() > ATTACHMENT_CACHE_MAX)
+    {
+        // Make room by discarding all cached contents.
+        for (AttachmentInfo& info : attachmentCache)
+            info.contents.clear();
+        attachmentCacheBytes = 0;
+    }
+    attachmentCacheBytes += contents.size() - it->contents.size();
+    it->contents = contents;
+}
+
+/******************************************************************************
+* Remove the cached details of a remote attachment file.
+*/
+void removeAttachment(const QUrl& url)
+{
+    auto it = attachmentCache.find(url);
+    if (it != attachmentCache.end())
+    {
+        attachmentCacheBytes -= it->contents.size();
+        attachmentCache.erase(it);
+    }
+}
+
 /******************************************************************************
 * Create the headers part of the email.
 */
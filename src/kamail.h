@@ -11,11 +11,15 @@
 #include "mailsend.h"
 
 #include <KCalendarCore/Person>
+#include <KIO/Global>
 
 #include <QObject>
 #include <QString>
 #include <QStringList>
 
+#include <functional>
+
+class QDateTime;
 class QUrl;
 namespace KMime {
     namespace Types { struct Address; }
@@ -33,6 +37,8 @@ public:
     static int         checkAddress(QString& address);
     static int         checkAttachment(QString& attachment, QUrl* = nullptr);
     static bool        checkAttachment(const QUrl&);
+    static void        checkAttachmentAsync(const QString& attachment, QObject* context,
+                                            const std::function<void(bool)>& result = {});
     static QString     convertAddresses(const QString& addresses, KCalendarCore::Person::List&);
     static QString     convertAttachments(const QString& attachments, QStringList& list);
     static QString     controlCentreAddress();
@@ -46,6 +52,10 @@ private:
     KAMail() = default;
     static KAMail*     instance();
     static QString     appendBodyAttachments(KMime::Message& message, MailSend::JobData&);
+    static bool        fetchAttachments(const MailSend::JobData&);
+    static void        downloadAttachment(const MailSend::JobData&, const QString& attachment,
+                                          const QUrl&, KIO::filesize_t size, const QDateTime& modified);
+    static void        resumeSend(MailSend::JobData&, const QString& error);
     static void        notifyQueued(const KAEvent&);
     enum ErrType { SEND_FAIL, SEND_ERROR };
     static QStringList errors(const QString& error = QString(), ErrType = SEND_FAIL);
@@ -0,0 +1,266 @@
+/*
+ *  logfilewriter.cpp  -  append to log files in a background thread
+ *  Program:  kalarm
+ *  SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "logfilewriter.h"
+
+#include "kalarm_debug.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QPointer>
+#include <QThread>
+#include <QTimer>
+
+#include <atomic>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+const int    IDLE_CLOSE_MS   = 10000;      // close log files which have been idle for this long
+const qint64 MAX_PENDING     = 1024*1024;  // maximum number of bytes waiting to be written
+std::atomic<qint64> pendingBytes {0};      // number of bytes waiting to be written
+
+// Function to call once text has been written, held in the GUI thread.
+struct WrittenCallback
+{
+    QPointer<QObject>     context;
+    std::function<void()> written;
+};
+QHash<quint64, WrittenCallback> writtenCallbacks;   // callbacks, keyed by request ID
+quint64 lastRequestId = 0;
+}
+
+/*=============================================================================
+= Class: LogFileWorker
+= Writes to log files, in the background thread.
+=============================================================================*/
+class LogFileWorker : public QObject
+{
+public:
+    LogFileWorker();
+    ~LogFileWorker() override;
+    void write(const QString& fileName, const QByteArray& data);
+
+private:
+    struct LogFile
+    {
+        QFile*        file;
+        QElapsedTimer lastWrite;
+        QDateTime     modified;     // modification time after the last write
+    };
+    QFile* openFile(const QString& fileName);
+    void   closeIdleFiles();
+    static bool isSameFile(const LogFile&, const QString& fileName);
+
+    QHash<QString, LogFile> mFiles;     // open log files
+    QTimer*                 mIdleTimer; // timer to close idle log files
+};
+
+LogFileWorker::LogFileWorker()
+    : mIdleTimer(new QTimer(this))
+{
+    mIdleTimer->setInterval(IDLE_CLOSE_MS);
+    QObject::connect(mIdleTimer, &QTimer::timeout, this, [this]() { closeIdleFiles(); });
+}
+
+LogFileWorker::~LogFileWorker()
+{
+    for (auto it = mFiles.begin();  it != mFiles.end();  ++it)
+        delete it->file;
+}
+
+/******************************************************************************
+* Append text to a log file.
+*/
+void LogFileWorker::write(const QString& fileName, const QByteArray& data)
+{
+    QFile* file = openFile(fileName);
+    if (file)
+    {
+        if (file->write(data) != data.size())
+        {
+            qCWarning(KALARM_LOG) << "LogFileWriter: Error writing to" << fileName << ":" << file->errorString();
+            delete file;
+            mFiles.remove(fileName);
+        }
+        else
+        {
+            LogFile& logFile = mFiles[fileName];
+            logFile.lastWrite.start();
+#ifndef Q_OS_UNIX
+            logFile.modified = QFileInfo(fileName).lastModified();
+#endif
+        }
+    }
+    if (!mFiles.isEmpty()  &&  !mIdleTimer->isActive())
+        mIdleTimer->start();
+}
+
+/******************************************************************************
+* Return an open log file, opening it if necessary. If the file is already
+* open, but the file system path no longer refers to the same file (e.g. it has
+* been rotated or deleted), it is reopened.
+*/
+QFile* LogFileWorker::openFile(const QString& fileName)
+{
+    auto it = mFiles.find(fileName);
+    if (it != mFiles.end())
+    {
+        if (isSameFile(*it, fileName))
+            return it->file;
+        delete it->file;
+        mFiles.erase(it);
+    }
+
+    auto* file = new QFile(fileName);
+    if (!file->open(QIODevice::Append | QIODevice::Text | QIODevice::Unbuffered))
+    {
+        qCWarning(KALARM_LOG) << "LogFileWriter: Error opening" << fileName << ":" << file->errorString();
+        delete file;
+        return nullptr;
+    }
+    mFiles.insert(fileName, LogFile{file, QElapsedTimer(), QDateTime()});
+    return file;
+}
+
+/******************************************************************************
+* Check whether the file system path of an open log file still refers to the
+* same file. On Unix, the device and inode of the path are compared with those
+* of the open file. Otherwise, the file is assumed to have been replaced if its
+* size or modification time differs from when it was last written by this
+* object; since commands also write to their log files, this may cause the
+* file to be reopened unnecessarily.
+*/
+bool LogFileWorker::isSameFile(const LogFile& logFile, const QString& fileName)
+{
+#ifdef Q_OS_UNIX
+    struct stat pathStat;
+    struct stat fileStat;
+    if (::stat(QFile::encodeName(fileName).constData(), &pathStat) != 0
+    ||  ::fstat(logFile.file->handle(), &fileStat) != 0)
+        return false;
+    return pathStat.st_dev == fileStat.st_dev  &&  pathStat.st_ino == fileStat.st_ino;
+#else
+    const QFileInfo info(fileName);
+    return info.exists()
+       &&  info.size() == logFile.file->size()
+       &&  info.lastModified() == logFile.modified;
+#endif
+}
+
+/******************************************************************************
+* Close log files which have not been written to recently.
+*/
+void LogFileWorker::closeIdleFiles()
+{
+    for (auto it = mFiles.begin();  it != mFiles.end();  )
+    {
+        if (it->lastWrite.hasExpired(IDLE_CLOSE_MS))
+        {
+            delete it->file;
+            it = mFiles.erase(it);
+        }
+        else
+            ++it;
+    }
+    if (mFiles.isEmpty())
+        mIdleTimer->stop();
+}
+
+
+/*=============================================================================
+= Class: LogFileWriter
+=============================================================================*/
+QThread*       LogFileWriter::mThread = nullptr;
+LogFileWorker* LogFileWriter::mWorker = nullptr;
+
+/******************************************************************************
+* Append text to a log file, in the background thread.
+*/
+void LogFileWriter::append(const QString& fileName, const QByteArray& data,
+                           QObject* context, const std::function<void()>& written)
+{
+    if (!mThread)
+    {
+        mThread = new QThread;
+        mThread->setObjectName(QStringLiteral("LogFileWriter"));
+        mWorker = new LogFileWorker;
+        mWorker->moveToThread(mThread);
+        QObject::connect(mThread, &QThread::finished, mWorker, &QObject::deleteLater);
+        mThread->start();
+    }
+
+    const qint64 size = data.size();
+    if (pendingBytes + size > MAX_PENDING)
+    {
+        qCWarning(KALARM_LOG) << "LogFileWriter: Too much pending output, discarding text for" << fileName;
+        if (context  &&  written)
+            QMetaObject::invokeMethod(context, written, Qt::QueuedConnection);
+        return;
+    }
+    pendingBytes += size;
+
+    // The callback is held in this thread, and only its ID is passed to the
+    // background thread, so that the context object is only accessed here.
+    quint64 id = 0;
+    if (context  &&  written)
+    {
+        id = ++lastRequestId;
+        writtenCallbacks.insert(id, WrittenCallback{context, written});
+    }
+    LogFileWorker* worker = mWorker;
+    QMetaObject::invokeMethod(mWorker, [worker, fileName, data, size, id]()
+    {
+        worker->write(fileName, data);
+        pendingBytes -= size;
+        if (id)
+            QMetaObject::invokeMethod(QCoreApplication::instance(), [id]() { notifyWritten(id); }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+/******************************************************************************
+* Called in the GUI thread once a block of text has been written.
+* Call the function which was supplied with it, if its context object still
+* exists.
+*/
+void LogFileWriter::notifyWritten(quint64 id)
+{
+    const WrittenCallback callback = writtenCallbacks.take(id);
+    if (callback.context  &&  callback.written)
+        callback.written();
+}
+
+/******************************************************************************
+* Stop the background thread, closing all log files.
+* Any text waiting to be written is written first. Functions waiting to be
+* called once their text has been written are not called.
+*/
+void LogFileWriter::terminate()
+{
+    if (mThread)
+    {
+        // Wait for the text already queued to be written.
+        QMetaObject::invokeMethod(mWorker, []() {}, Qt::BlockingQueuedConnection);
+        writtenCallbacks.clear();
+        mThread->quit();
+        mThread->wait();
+        delete mThread;    // the worker is deleted when the thread finishes
+        mThread = nullptr;
+        mWorker = nullptr;
+        pendingBytes = 0;
+    }
+}
+
+// vim: et sw=4:
@@ -0,0 +1,63 @@
+/*
+ *  logfilewriter.h  -  append to log files in a background thread
+ *  Program:  kalarm
+ *  SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+/** @file logfilewriter.h - append to log files in a background thread */
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+
+#include <functional>
+
+class QThread;
+class LogFileWorker;
+
+/**
+ *  @short Appends text to log files without blocking the GUI thread.
+ *
+ *  The LogFileWriter class appends blocks of text to log files in a background
+ *  thread, so that slow file systems do not stall the event loop.
+ *
+ *  Log files are kept open between writes, and are closed once they have been
+ *  idle for a while, or if the file has been replaced (e.g. by log rotation).
+ *  Each block of text is appended with a single unbuffered write, so that text
+ *  written by different processes to the same log file is not interleaved.
+ *
+ *  The amount of text waiting to be written is limited; if the limit is
+ *  exceeded, further text is discarded until the backlog has been written.
+ */
+class LogFileWriter
+{
+public:
+    /** Append text to a log file.
+     *  @param fileName  Path of the log file.
+     *  @param data      Text to append.
+     *  @param context   Object which must still exist for @p written to be
+     *                   called. This must be in the GUI thread.
+     *  @param written   Function to call in the GUI thread once the text has
+     *                   been written, or if an error occurred.
+     */
+    static void append(const QString& fileName, const QByteArray& data,
+                       QObject* context = nullptr, const std::function<void()>& written = {});
+
+    /** Write any text which is waiting to be written, close all log files and
+     *  stop the background thread. Functions passed to append() which have
+     *  not yet been called are discarded.
+     */
+    static void terminate();
+
+private:
+    static void notifyWritten(quint64 id);
+
+    static QThread*       mThread;
+    static LogFileWorker* mWorker;
+};
+
+// vim: et sw=4:
@@ -10,6 +10,9 @@
 
 #include "kalarmcalendar/kaevent.h"
 
+#include <QByteArray>
+#include <QHash>
+
 namespace MailSend
 {
 
@@ -23,6 +26,7 @@ struct JobData
     KAlarmCal::KAEvent  event;
     KAlarmCal::KAAlarm  alarm;
     QString             from, bcc, subject;
+    QHash<QString, QByteArray> attachmentData;   // contents of remote attachments, by attachment name
     bool                reschedule;
     bool                allowNotify;
     bool                queued;
@@ -28,11 +28,11 @@ bool MessageDisplay::mRedisplayed = false;
 
 /******************************************************************************
 * Create a new instance of a MessageDisplay, the derived class being dependent
-* on 'event.notify()'.
+* on 'event.notify()'. In headless mode, a notification is always used.
 */
 MessageDisplay* MessageDisplay::create(const KAEvent& event, const KAAlarm& alarm, int flags)
 {
-    if (event.notify())
+    if (event.notify()  ||  KAlarmApp::headless())
         return new MessageNotification(event, alarm, flags & ~AlwaysHide);
     else
         return new MessageWindow(event, alarm, flags);
@@ -49,7 +49,7 @@ void MessageDisplay::showError(const KAEvent& event, const DateTime& alarmDateTi
     if (MessageDisplayHelper::shouldShowError(event, errmsgs, dontShowAgain))
     {
         MessageDisplay* disp;
-        if (event.notify())
+        if (event.notify()  ||  KAlarmApp::headless())
             disp = new MessageNotification(event, alarmDateTime, errmsgs, dontShowAgain);
         else
             disp = new MessageWindow(event, alarmDateTime, errmsgs, dontShowAgain);
@@ -61,7 +61,9 @@ enum
     ErrMsg_AudioFile = 0x02
 };
 
-QList<MessageDisplayHelper*>   MessageDisplayHelper::mInstanceList;
+QSet<MessageDisplayHelper*>    MessageDisplayHelper::mInstances;
+QMultiHash<EventId, MessageDisplayHelper*> MessageDisplayHelper::mEventInstances;
+int                            MessageDisplayHelper::mAlwaysHiddenCount = 0;
 QHash<EventId, unsigned>       MessageDisplayHelper::mErrorMessages;
 // There can only be one audio thread at a time: trying to play multiple
 // sound files simultaneously would result in a cacophony, and besides
@@ -127,7 +129,7 @@ MessageDisplayHelper::MessageDisplayHelper(MessageDisplay* parent, const KAEvent
         mNoDefer = readonly || (flags & MessageDisplay::NoDefer) || alarm.repeatAtLogin();
     }
 
-    mInstanceList.append(this);
+    registerInstance();
     if (event.autoClose())
         mCloseTime = alarm.dateTime().effectiveKDateTime().toUtc().qDateTime().addSecs(event.lateCancel() * 60);
 }
@@ -159,7 +161,7 @@ MessageDisplayHelper::MessageDisplayHelper(MessageDisplay* parent, const KAEvent
     , mNoPostAction(true)
 {
     qCDebug(KALARM_LOG) << "MessageDisplayHelper(errmsg)";
-    mInstanceList.append(this);
+    registerInstance();
 }
 
 /******************************************************************************
@@ -170,7 +172,7 @@ MessageDisplayHelper::MessageDisplayHelper(MessageDisplay* parent)
     : mParent(parent)
 {
     qCDebug(KALARM_LOG) << "MessageDisplayHelper(): restore";
-    mInstanceList.append(this);
+    registerInstance();
 }
 
 /******************************************************************************
@@ -188,12 +190,38 @@ MessageDisplayHelper::~MessageDisplayHelper()
     if (mAudioThread.data())
         mAudioThread->setParent(nullptr);
     mErrorMessages.remove(mEventId);
-    mInstanceList.removeAll(this);
+    mInstances.remove(this);
+    mEventInstances.remove(mEventId, this);
+    if (mAlwaysHide)
+        --mAlwaysHiddenCount;
     delete mTempFile;
     if (!mNoPostAction  &&  !mEvent.postAction().isEmpty())
         theApp()->alarmCompleted(mEvent);
 }
 
+/******************************************************************************
+* Add this instance to the registry of message displays.
+*/
+void MessageDisplayHelper::registerInstance()
+{
+    mInstances.insert(this);
+    if (!mEventId.isEmpty())
+        mEventInstances.insert(mEventId, this);
+    if (mAlwaysHide)
+        ++mAlwaysHiddenCount;
+}
+
+/******************************************************************************
+* Set the event ID, and update the registry of message displays by event ID.
+*/
+void MessageDisplayHelper::setEventId(const EventId& eventId)
+{
+    mEventInstances.remove(mEventId, this);
+    mEventId = eventId;
+    if (!mEventId.isEmpty())
+        mEventInstances.insert(mEventId, this);
+}
+
 /******************************************************************************
 * Obtain the texts to show in the displayed alarm.
 */
@@ -359,15 +387,9 @@ void MessageDisplayHelper::initTexts()
 */
 int MessageDisplayHelper::instanceCount(bool excludeAlwaysHidden)
 {
-    int count = mInstanceList.count();
+    int count = mInstances.count();
     if (excludeAlwaysHidden)
-    {
-        for (const MessageDisplayHelper* h : std::as_const(mInstanceList))
-        {
-            if (h->mAlwaysHide)
-                --count;
-        }
-    }
+        count -= mAlwaysHiddenCount;
     return count;
 }
 
@@ -383,10 +405,11 @@ bool MessageDisplayHelper::shouldShowError(const KAEvent& event, const QStringLi
         return false;
 
     // Don't pile up duplicate error messages for the same alarm
-    EventId eid(event);
-    for (const MessageDisplayHelper* h : std::as_const(mInstanceList))
+    const EventId eid(event);
+    for (auto it = mEventInstances.constFind(eid);  it != mEventInstances.constEnd() && it.key() == eid;  ++it)
     {
-        if (h->mErrorWindow  &&  h->mEventId == eid
+        const MessageDisplayHelper* h = it.value();
+        if (h->mErrorWindow
         &&  h->mErrorMsgs == errmsgs  &&  h->mDontShowAgain == dontShowAgain)
             return false;
     }
@@ -693,7 +716,7 @@ bool MessageDisplayHelper::readPropertyValues(const KConfigGroup& config)
     mShowEdit            = false;
     // Temporarily initialise mResource and mEventId - they will be set by redisplayAlarm()
     mResource            = Resources::resource(resourceId);
-    mEventId             = EventId(resourceId, eventId);
+    setEventId(EventId(resourceId, eventId));
     if (mAlarmType == KAAlarm::Type::Invalid)
         return false;
     qCDebug(KALARM_LOG) << "MessageDisplayHelper::readProperties:" << eventId;
@@ -736,7 +759,7 @@ void MessageDisplayHelper::showRestoredAlarm()
 void MessageDisplayHelper::redisplayAlarm()
 {
     mResource = Resources::resourceForEvent(mEventId.eventId());
-    mEventId.setResourceId(mResource.id());
+    setEventId(EventId(mResource.id(), mEventId.eventId()));
     qCDebug(KALARM_LOG) << "MessageDisplayHelper::redisplayAlarm:" << mEventId;
     // Delete any already existing display for the same event
     MessageDisplay* duplicate = findEvent(mEventId, mParent);
@@ -800,9 +823,10 @@ MessageDisplay* MessageDisplayHelper::findEvent(const EventId& eventId, MessageD
 {
     if (!eventId.isEmpty())
     {
-        for (const MessageDisplayHelper* h : std::as_const(mInstanceList))
+        for (auto it = mEventInstances.constFind(eventId);  it != mEventInstances.constEnd() && it.key() == eventId;  ++it)
         {
-            if (h->mParent != exclude  &&  h->mEventId == eventId  &&  !h->mErrorWindow)
+            const MessageDisplayHelper* h = it.value();
+            if (h->mParent != exclude  &&  !h->mErrorWindow)
                 return h->mParent;
         }
     }
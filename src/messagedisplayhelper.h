@@ -16,6 +16,7 @@
 
 #include <QObject>
 #include <QHash>
+#include <QSet>
 #include <QPointer>
 #include <QDateTime>
 
@@ -146,8 +147,12 @@ private:
     bool    haveErrorMessage(unsigned msg) const;
     void    clearErrorMessage(unsigned msg) const;
     void    redisplayAlarm();
+    void    registerInstance();
+    void    setEventId(const EventId&);
 
-    static QList<MessageDisplayHelper*> mInstanceList; // list of existing message displays
+    static QSet<MessageDisplayHelper*> mInstances;    // existing message displays
+    static QMultiHash<EventId, MessageDisplayHelper*> mEventInstances; // message displays, by event ID
+    static int mAlwaysHiddenCount;                    // number of always-hidden message displays
     static QHash<EventId, unsigned> mErrorMessages; // error messages currently displayed, by event ID
     // Sound file playing
     static QPointer<QThread>     mAudioThread;    // container of thread to play audio file in
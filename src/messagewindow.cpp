@@ -108,6 +108,8 @@ public:
 };
 
 QList<MessageWindow*> MessageWindow::mWindowList;
+int                   MessageWindow::mAlwaysHiddenCount = 0;
+bool                  MessageWindow::mSpreadCheckPending = false;
 
 /******************************************************************************
 * Construct the message window for the specified alarm.
@@ -136,6 +138,7 @@ MessageWindow::MessageWindow(const KAEvent& event, const KAAlarm& alarm, int fla
     mWindowList.append(this);
     if (mAlwaysHidden())
     {
+        ++mAlwaysHiddenCount;
         hide();
         displayComplete();    // play audio, etc.
     }
@@ -191,6 +194,8 @@ MessageWindow::~MessageWindow()
 {
     qCDebug(KALARM_LOG) << "~MessageWindow" << (void*)this << mEventId();
     mWindowList.removeAll(this);
+    if (mAlwaysHidden())
+        --mAlwaysHiddenCount;
 }
 
 /******************************************************************************
@@ -529,13 +534,7 @@ int MessageWindow::windowCount(bool excludeAlwaysHidden)
 {
     int count = mWindowList.count();
     if (excludeAlwaysHidden)
-    {
-        for (MessageWindow* win : std::as_const(mWindowList))
-        {
-            if (win->mAlwaysHidden())
-                --count;
-        }
-    }
+        count -= mAlwaysHiddenCount;
     return count;
 }
 
@@ -802,6 +801,26 @@ bool MessageWindow::isSpread(const QPoint& topLeft)
     return false;
 }
 
+/******************************************************************************
+* Schedule a check of whether message windows are spread out, to update the
+* 'spread windows' menu item status.
+* The check is done once control returns to the event loop, so that when many
+* windows are moved together, all windows are not checked for each move.
+*/
+void MessageWindow::scheduleSpreadCheck()
+{
+    if (!mSpreadCheckPending)
+    {
+        mSpreadCheckPending = true;
+        const QPoint topLeft = Desktop::workArea(mScreenNumber).topLeft();
+        QTimer::singleShot(0, theApp(), [topLeft]()
+        {
+            mSpreadCheckPending = false;
+            theApp()->setSpreadWindowsState(isSpread(topLeft));
+        });
+    }
+}
+
 /******************************************************************************
 * Display the window, if it should not already be auto-closed.
 * If windows are being positioned away from the mouse cursor, it is initially
@@ -960,7 +979,7 @@ void MessageWindow::showEvent(QShowEvent* se)
 void MessageWindow::moveEvent(QMoveEvent* e)
 {
     MainWindowBase::moveEvent(e);
-    theApp()->setSpreadWindowsState(isSpread(Desktop::workArea(mScreenNumber).topLeft()));
+    scheduleSpreadCheck();
     if (mPositioning)
     {
         // The window has just been initially positioned
@@ -982,7 +1001,7 @@ void MessageWindow::frameDrawn()
         if (width() > s.width()  ||  height() > s.height())
             resize(s);
     }
-    theApp()->setSpreadWindowsState(isSpread(Desktop::workArea(mScreenNumber).topLeft()));
+    scheduleSpreadCheck();
 }
 
 /******************************************************************************
@@ -99,9 +99,12 @@ private:
     void                setButtonsReadOnly(bool);
     bool                getWorkAreaAndModal();
     static bool         isSpread(const QPoint& topLeft);
+    void                scheduleSpreadCheck();
     void show();   // ensure that display() is called instead of show() on a MessageWindow object
 
     static QList<MessageWindow*> mWindowList;     // list of message window instances
+    static int          mAlwaysHiddenCount;       // number of always-hidden message windows
+    static bool         mSpreadCheckPending;      // a check of the windows' spread state is scheduled
     // Properties needed by readProperties()
     int                 mRestoreHeight;
     // Miscellaneous
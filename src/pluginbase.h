@@ -14,6 +14,7 @@
 #include <KMime/Message>
 
 #include <QObject>
+#include <QSet>
 
 class QUrl;
 class QColor;
@@ -36,8 +37,10 @@ public:
     /** Create birthday model instances. */
     virtual QSortFilterProxyModel* createBirthdayModels(QWidget* messageParent, QObject* parent = nullptr) = 0;
 
-    /** Set a new prefix and suffix, and the corresponding selection list. */
-    virtual void setPrefixSuffix(QSortFilterProxyModel* birthdaySortModel, const QString& prefix, const QString& suffix, const QStringList& alarmMessageList) = 0;
+    /** Set a new prefix and suffix, and the corresponding selection list.
+     *  @param alarmMessages  texts of existing annual message alarms.
+     */
+    virtual void setPrefixSuffix(QSortFilterProxyModel* birthdaySortModel, const QString& prefix, const QString& suffix, const QSet<QString>& alarmMessages) = 0;
 
     enum class BirthdayModelValue { NameColumn, DateColumn, DateRole };
     /** Return BirthdayModel enum values. */
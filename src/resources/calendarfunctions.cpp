@@ -8,8 +8,11 @@
 
 #include "calendarfunctions.h"
 
+#include "resources.h"
 #include "preferences.h"
 #include "lib/messagebox.h"
+#include "kalarmcalendar/icalstreamreader.h"
+#include "kalarmcalendar/icalstreamwriter.h"
 #include "kalarm_debug.h"
 
 #include <KCalendarCore/CalFormat>
@@ -19,10 +22,87 @@ using namespace KCalendarCore;
 
 #include <KLocalizedString>
 #include <KJobWidgets>
+#include <KIO/FileCopyJob>
 #include <KIO/StoredTransferJob>
 
+#include <QEventLoop>
+#include <QPointer>
+#include <QProgressDialog>
+#include <QSaveFile>
 #include <QTemporaryFile>
+#include <QThread>
 
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+const int IMPORT_BATCH_SIZE = 500;   // number of events to read and add to a resource at a time
+const int PROGRESS_STEPS    = 1000;  // number of progress steps for each calendar file
+const int EXPORT_BATCH_SIZE = 500;   // number of events to convert and write to a file at a time
+
+KJob* fetchCalendarFile(const QUrl& url, QWidget* parent, const std::function<void(const QString&)>& fetched);
+void importEvent(const Event::Ptr& event, bool currentFormat, CalEvent::Types alarmTypes, bool newId,
+                 QHash<CalEvent::Type, QList<KAEvent>>& alarmList);
+
+// A batch of events read from a calendar file.
+struct ImportBatch
+{
+    QHash<CalEvent::Type, QList<KAEvent>> events;  // events read, converted for import
+    qint64 position {0};   // file position after reading the events
+    qint64 size {0};       // size of the file
+    bool   atEnd {false};  // the whole file has been read
+    bool   error {false};  // an error occurred
+};
+
+/*=============================================================================
+= Class: ImportReader
+= Reads events from a calendar file, in a background thread.
+=============================================================================*/
+class ImportReader : public QObject
+{
+public:
+    ImportReader(const QString& fileName, const QTimeZone& timeZone, CalEvent::Types alarmTypes)
+        : mFile(new QFile(fileName, this))
+        , mReader(mFile, timeZone)
+        , mAlarmTypes(alarmTypes)
+    {}
+    ImportBatch read();
+    void        close()   { mFile->close(); }
+
+private:
+    QFile*           mFile;
+    ICalStreamReader mReader;
+    CalEvent::Types  mAlarmTypes;
+};
+
+/*=============================================================================
+= Class: ExportWriter
+= Writes events to a calendar file, in a background thread.
+=============================================================================*/
+class ExportWriter : public QObject
+{
+public:
+    ExportWriter(const QString& fileName, bool append, const QTimeZone& timeZone)
+        : mFile(new QSaveFile(fileName, this))
+        , mWriter(mFile)
+        , mTimeZone(timeZone)
+        , mAppend(append)
+    {}
+    bool open();
+    bool write(const Event::List& events)   { return mWriter.writeEvents(events); }
+    bool commit();
+    void discard()            { mFile->cancelWriting();  mFile->commit(); }
+    bool appendError() const  { return mAppendError; }
+
+private:
+    QSaveFile*       mFile;
+    ICalStreamWriter mWriter;
+    QTimeZone        mTimeZone;
+    bool             mAppend;
+    bool             mAppendError {false};
+};
+}
 
 namespace KAlarm
 {
@@ -30,6 +110,8 @@ namespace KAlarm
 /******************************************************************************
 * Import alarms from a calendar file. The alarms are converted to the current
 * KAlarm format and are given new unique event IDs.
+* Only local files are supported, since this function cannot wait for a remote
+* file to download without blocking; importCalendarFiles() handles remote files.
 * Parameters: parent:    parent widget for error message boxes
 *             alarmList: imported alarms are appended to this list
 */
@@ -40,88 +122,554 @@ bool importCalendarFile(const QUrl& url, CalEvent::Types alarmTypes, bool newId,
         qCDebug(KALARM_LOG) << "KAlarm::importCalendarFile: Invalid URL";
         return false;
     }
+    if (!url.isLocalFile())
+    {
+        qCWarning(KALARM_LOG) << "KAlarm::importCalendarFile: Remote URL not supported:" << url.toDisplayString();
+        return false;
+    }
 
-    // If the URL is remote, download it into a temporary local file.
+    // For a local file, fetchCalendarFile() calls the function before returning.
     QString filename;
-    bool local = url.isLocalFile();
-    if (local)
+    fetchCalendarFile(url, parent, [&filename](const QString& name) { filename = name; });
+    if (filename.isEmpty())
+        return false;
+
+    // Read the calendar and add its alarms to the current calendars
+    MemoryCalendar::Ptr cal(new MemoryCalendar(Preferences::timeSpecAsZone()));
+    FileStorage::Ptr calStorage(new FileStorage(cal, filename));
+    if (!calStorage->load())
+    {
+        qCDebug(KALARM_LOG) << "KAlarm::importCalendarFile: Error loading calendar '" << filename <<"'";
+        KAMessageBox::error(parent, xi18nc("@info", "Could not load calendar <filename>%1</filename>.", url.toDisplayString()));
+        return false;
+    }
+
+    QString versionString;
+    const bool currentFormat = (KACalendar::updateVersion(calStorage, versionString) != KACalendar::IncompatibleFormat);
+    const Event::List events = cal->rawEvents();
+    for (const Event::Ptr& event : events)
+        importEvent(event, currentFormat, alarmTypes, newId, alarmList);
+    return true;
+}
+
+/******************************************************************************
+* Import alarms from calendar files into resources, reading the files in a
+* background thread. Each batch of alarms which is read is added to its
+* resource as a block, while the next batch is being read.
+*/
+bool importCalendarFiles(const QList<QUrl>& urls, CalEvent::Types alarmTypes, Resource& resource, QWidget* parent)
+{
+    QProgressDialog progress(i18nc("@info", "Importing alarms..."), i18nc("@action:button", "Cancel"),
+                             0, urls.count() * PROGRESS_STEPS, parent);
+    progress.setWindowTitle(i18nc("@title:window", "Import Alarms"));
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(1000);
+    progress.setValue(0);
+
+    QThread thread;
+    thread.setObjectName(QStringLiteral("CalendarImport"));
+    thread.start();
+
+    const QTimeZone timeZone = Preferences::timeSpecAsZone();
+    QHash<CalEvent::Type, Resource> destinations;   // resource to add each alarm type to
+    bool success   = true;
+    bool cancelled = false;
+    int  imported  = 0;
+    QEventLoop loop;
+    QPointer<KJob> download;   // job downloading the current file, if remote
+    QObject::connect(&progress, &QProgressDialog::canceled, &loop, [&]()
+    {
+        qCDebug(KALARM_LOG) << "KAlarm::importCalendarFiles: Cancelled";
+        cancelled = true;
+        if (download)
+            download->kill();
+        loop.quit();
+    });
+
+    for (int i = 0, count = urls.count();  i < count  &&  !cancelled;  ++i)
+    {
+        const QUrl& url = urls[i];
+        if (!url.isValid())
+        {
+            qCDebug(KALARM_LOG) << "KAlarm::importCalendarFiles: Invalid URL";
+            continue;
+        }
+        qCDebug(KALARM_LOG) << "KAlarm::importCalendarFiles:" << url.toDisplayString();
+
+        // If the URL is remote, wait for it to download into a temporary
+        // local file, while allowing the user to cancel.
+        QString filename;
+        bool fetched = false;
+        download = fetchCalendarFile(url, parent, [&](const QString& name)
+        {
+            filename = name;
+            fetched  = true;
+            loop.quit();
+        });
+        if (!fetched)
+            loop.exec();
+        if (cancelled)
+            break;
+        if (filename.isEmpty())
+        {
+            success = false;
+            continue;
+        }
+        const bool local = url.isLocalFile();
+
+        auto reader = new ImportReader(filename, timeZone, alarmTypes);
+        reader->moveToThread(&thread);
+        QObject receiver;    // receives batches of events from the reader thread
+        bool readError = false;
+        std::function<void(const ImportBatch&)> addBatch;
+
+        // Read the next batch of events in the reader thread, and then add
+        // them in this thread.
+        auto readNext = [reader, &receiver, &addBatch]()
+        {
+            QMetaObject::invokeMethod(reader, [reader, &receiver, &addBatch]()
+            {
+                const ImportBatch batch = reader->read();
+                QMetaObject::invokeMethod(&receiver, [&addBatch, batch]() { addBatch(batch); }, Qt::QueuedConnection);
+            }, Qt::QueuedConnection);
+        };
+
+        addBatch = [&](const ImportBatch& batch)
+        {
+            if (cancelled)
+                return;
+            // Find the destination resources first, since the user may be prompted.
+            for (auto it = batch.events.constBegin();  it != batch.events.constEnd();  ++it)
+            {
+                if (!destinations.contains(it.key()))
+                    destinations[it.key()] = resource.isValid() ? resource : Resources::destination(it.key(), parent);
+            }
+            if (cancelled)
+                return;
+            if (!batch.atEnd  &&  !batch.error)
+                readNext();   // read the next batch while this one is being added
+
+            for (auto it = batch.events.constBegin();  it != batch.events.constEnd();  ++it)
+            {
+                QList<int> failed;
+                destinations[it.key()].addEvents(it.value(), failed);
+                if (!failed.isEmpty())
+                    success = false;
+                imported += it.value().count() - failed.count();
+            }
+            if (batch.error)
+                readError = true;
+            if (batch.atEnd  ||  batch.error)
+                loop.quit();
+            if (batch.size > 0)
+                progress.setValue(i * PROGRESS_STEPS + static_cast<int>(batch.position * PROGRESS_STEPS / batch.size));
+        };
+
+        readNext();
+        loop.exec();
+
+        // Wait for the reader thread to finish with the file.
+        QMetaObject::invokeMethod(reader, [reader]() { reader->close(); }, Qt::BlockingQueuedConnection);
+        reader->deleteLater();
+        if (!local)
+            QFile::remove(filename);
+
+        if (readError)
+        {
+            qCDebug(KALARM_LOG) << "KAlarm::importCalendarFiles: Error reading calendar '" << filename <<"'";
+            KAMessageBox::error(parent, xi18nc("@info", "Could not load calendar <filename>%1</filename>.", url.toDisplayString()));
+            success = false;
+        }
+    }
+    QObject::disconnect(&progress, &QProgressDialog::canceled, &loop, nullptr);
+
+    thread.quit();
+    thread.wait();
+    progress.setValue(progress.maximum());
+    return success  &&  !cancelled  &&  imported;
+}
+
+/******************************************************************************
+* Export alarms to a calendar file. The alarms are converted to calendar events
+* in batches in this thread, and each batch is written to a temporary file in a
+* background thread while the next batch is being converted. The temporary file
+* replaces the destination file once all alarms have been written. If the
+* destination is remote, the file is then uploaded without waiting for the
+* upload to complete. Appending is only supported for local files, since the
+* existing remote file would otherwise need to be downloaded first.
+*/
+bool exportCalendarFile(const QList<KAEvent>& events, const QUrl& url, bool append, QWidget* parent)
+{
+    if (events.isEmpty())
+        return true;
+    qCDebug(KALARM_LOG) << "KAlarm::exportCalendarFile:" << url.toDisplayString() << "count:" << events.count();
+
+    // If the URL is remote, write to a temporary local file which will then be
+    // uploaded.
+    const bool local = url.isLocalFile();
+    if (append  &&  !local)
     {
+        qCCritical(KALARM_LOG) << "KAlarm::exportCalendarFile: Cannot append to remote file" << url.toDisplayString();
+        KAMessageBox::error(parent, xi18nc("@info", "Error loading calendar to append to:<nl/><filename>%1</filename>", url.toDisplayString()));
+        return false;
+    }
+    QString filename;
+    QTemporaryFile* tempFile = nullptr;
+    if (local)
         filename = url.toLocalFile();
+    else
+    {
+        tempFile = new QTemporaryFile;
+        if (!tempFile->open())
+        {
+            qCCritical(KALARM_LOG) << "KAlarm::exportCalendarFile: Error creating temporary file";
+            KAMessageBox::error(parent, xi18nc("@info", "Failed to save new calendar to:<nl/><filename>%1</filename>", url.toDisplayString()));
+            delete tempFile;
+            return false;
+        }
+        tempFile->close();
+        filename = tempFile->fileName();
+    }
+
+    const int count = events.count();
+    QProgressDialog progress(i18nc("@info", "Exporting alarms..."), i18nc("@action:button", "Cancel"),
+                             0, count, parent);
+    progress.setWindowTitle(i18nc("@title:window", "Export Alarms"));
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(1000);
+    progress.setValue(0);
+
+    QThread thread;
+    thread.setObjectName(QStringLiteral("CalendarExport"));
+    thread.start();
+    auto writer = new ExportWriter(filename, append, Preferences::timeSpecAsZone());
+    writer->moveToThread(&thread);
+
+    QEventLoop loop;
+    QObject receiver;    // receives notifications from the writer thread
+    bool writeError = false;
+    bool cancelled  = false;
+    int  converted  = 0;     // number of events converted so far
+    int  written    = 0;     // number of events written so far
+    Event::List pending;     // converted events waiting to be written
+    std::function<void(bool, int)> batchWritten;
+
+    // Convert the next batch of alarms to calendar events. The alarms are
+    // converted in this thread since they are shared with the resources.
+    auto convertNext = [&]()
+    {
+        const int end = std::min(converted + EXPORT_BATCH_SIZE, count);
+        pending.reserve(end - converted);
+        for ( ;  converted < end;  ++converted)
+        {
+            const KAEvent& event = events[converted];
+            Event::Ptr kcalEvent(new Event);
+            const QString id = CalEvent::uid(kcalEvent->uid(), event.category());
+            kcalEvent->setUid(id);
+            event.updateKCalEvent(kcalEvent, KAEvent::UidAction::Ignore);
+            pending += kcalEvent;
+        }
+    };
+
+    // Write a batch of events in the writer thread, and notify this thread
+    // when it has been written.
+    auto writeBatch = [writer, &receiver, &batchWritten](const Event::List& batch)
+    {
+        QMetaObject::invokeMethod(writer, [writer, &receiver, &batchWritten, batch]()
+        {
+            const bool ok = writer->write(batch);
+            const int n = batch.count();
+            QMetaObject::invokeMethod(&receiver, [&batchWritten, ok, n]() { batchWritten(ok, n); }, Qt::QueuedConnection);
+        }, Qt::QueuedConnection);
+    };
+
+    batchWritten = [&](bool ok, int n)
+    {
+        if (cancelled)
+            return;
+        if (!ok)
+        {
+            writeError = true;
+            loop.quit();
+            return;
+        }
+        written += n;
+        progress.setValue(written);
+        if (pending.isEmpty())
+        {
+            loop.quit();    // all events have been written
+            return;
+        }
+        writeBatch(pending);
+        pending.clear();
+        convertNext();   // convert the next batch while this one is being written
+    };
+
+    QObject::connect(&progress, &QProgressDialog::canceled, &loop, [&]()
+    {
+        qCDebug(KALARM_LOG) << "KAlarm::exportCalendarFile: Cancelled";
+        cancelled = true;
+        loop.quit();
+    });
+
+    // Open the file (copying any existing calendar if appending) while the
+    // first batch is being converted.
+    QMetaObject::invokeMethod(writer, [writer, &receiver, &batchWritten]()
+    {
+        const bool ok = writer->open();
+        QMetaObject::invokeMethod(&receiver, [&batchWritten, ok]() { batchWritten(ok, 0); }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+    convertNext();
+    loop.exec();
+    QObject::disconnect(&progress, &QProgressDialog::canceled, &loop, nullptr);
+
+    // Wait for the writer thread to finish, and replace the destination file
+    // with the new calendar, or discard it.
+    bool saved = false;
+    bool appendError = false;
+    QMetaObject::invokeMethod(writer, [&]()
+    {
+        appendError = writer->appendError();
+        if (cancelled  ||  writeError)
+            writer->discard();
+        else
+            saved = writer->commit();
+    }, Qt::BlockingQueuedConnection);
+    writer->deleteLater();
+    thread.quit();
+    thread.wait();
+    progress.setValue(progress.maximum());
+
+    if (!saved)
+    {
+        delete tempFile;
+        if (cancelled)
+            return false;
+        if (appendError)
+        {
+            qCCritical(KALARM_LOG) << "KAlarm::exportCalendarFile: Error loading calendar file" << filename << "for append";
+            KAMessageBox::error(parent, xi18nc("@info", "Error loading calendar to append to:<nl/><filename>%1</filename>", url.toDisplayString()));
+        }
+        else
+        {
+            qCCritical(KALARM_LOG) << "KAlarm::exportCalendarFile:" << filename << ": failed";
+            KAMessageBox::error(parent, xi18nc("@info", "Failed to save new calendar to:<nl/><filename>%1</filename>", url.toDisplayString()));
+        }
+        return false;
+    }
+
+    if (!local)
+    {
+        // Upload the file in the background. The temporary file is deleted
+        // once the upload has completed.
+        auto uploadJob = KIO::file_copy(QUrl::fromLocalFile(filename), url, -1, KIO::Overwrite);
+        KJobWidgets::setWindow(uploadJob, parent);
+        const QPointer<QWidget> parentWidget(parent);
+        QObject::connect(uploadJob, &KJob::result, uploadJob, [tempFile, url, parentWidget](KJob* job)
+        {
+            if (job->error())
+            {
+                qCCritical(KALARM_LOG) << "KAlarm::exportCalendarFile:" << url.toDisplayString() << ": upload failed:" << job->errorString();
+                KAMessageBox::error(parentWidget, xi18nc("@info", "Cannot upload new calendar to:<nl/><filename>%1</filename>", url.toDisplayString()));
+            }
+            delete tempFile;
+        });
+    }
+    return true;
+}
+
+}
+
+namespace
+{
+
+/******************************************************************************
+* Find the local file name for a calendar file. If the URL is remote, the file
+* is downloaded asynchronously into a temporary local file, which the caller
+* must delete.
+* Parameters: parent:  parent widget for error message boxes
+*             fetched: called with the local file name once it is available, or
+*                      with an empty file name on error. If the URL is local,
+*                      it is called before this function returns. It is not
+*                      called if the download job is killed.
+* Reply = job downloading the file, or null if the URL is local.
+*/
+KJob* fetchCalendarFile(const QUrl& url, QWidget* parent, const std::function<void(const QString&)>& fetched)
+{
+    if (url.isLocalFile())
+    {
+        const QString filename = url.toLocalFile();
         if (!QFile::exists(filename))
         {
             qCDebug(KALARM_LOG) << "KAlarm::importCalendarFile:" << url.toDisplayString() << "not found";
             KAMessageBox::error(parent, xi18nc("@info", "Could not load calendar <filename>%1</filename>.", url.toDisplayString()));
-            return false;
+            fetched(QString());
         }
+        else
+            fetched(filename);
+        return nullptr;
     }
-    else
+
+    auto getJob = KIO::storedGet(url);
+    KJobWidgets::setWindow(getJob, parent);
+    const QPointer<QWidget> parentWidget(parent);
+    QObject::connect(getJob, &KJob::result, getJob, [url, parentWidget, fetched](KJob* job)
     {
-        auto getJob = KIO::storedGet(url);
-        KJobWidgets::setWindow(getJob, parent);
-        if (!getJob->exec())
+        if (job->error())
         {
-            qCCritical(KALARM_LOG) << "KAlarm::importCalendarFile: Download failure";
-            KAMessageBox::error(parent, xi18nc("@info", "Cannot download calendar: <filename>%1</filename>", url.toDisplayString()));
-            return false;
+            qCCritical(KALARM_LOG) << "KAlarm::importCalendarFile: Download failure:" << job->errorString();
+            KAMessageBox::error(parentWidget, xi18nc("@info", "Cannot download calendar: <filename>%1</filename>", url.toDisplayString()));
+            fetched(QString());
+            return;
         }
         QTemporaryFile tmpFile;
         tmpFile.setAutoRemove(false);
-        tmpFile.write(getJob->data());
-        tmpFile.seek(0);
-        filename = tmpFile.fileName();
-        qCDebug(KALARM_LOG) << "KAlarm::importCalendarFile: --- Downloaded to" << filename;
-    }
+        if (!tmpFile.open()
+        ||  tmpFile.write(static_cast<KIO::StoredTransferJob*>(job)->data()) < 0)
+        {
+            qCCritical(KALARM_LOG) << "KAlarm::importCalendarFile: Error writing temporary file";
+            KAMessageBox::error(parentWidget, xi18nc("@info", "Cannot download calendar: <filename>%1</filename>", url.toDisplayString()));
+            tmpFile.remove();
+            fetched(QString());
+            return;
+        }
+        tmpFile.close();
+        qCDebug(KALARM_LOG) << "KAlarm::importCalendarFile: --- Downloaded to" << tmpFile.fileName();
+        fetched(tmpFile.fileName());
+    });
+    return getJob;
+}
 
-    // Read the calendar and add its alarms to the current calendars
-    MemoryCalendar::Ptr cal(new MemoryCalendar(Preferences::timeSpecAsZone()));
-    FileStorage::Ptr calStorage(new FileStorage(cal, filename));
-    bool success = calStorage->load();
-    if (!local)
-        QFile::remove(filename);
-    if (!success)
+/******************************************************************************
+* Convert an event read from a calendar file for import, and add it to a list
+* if it is a usable alarm of a required type.
+* Parameters: currentFormat: false if the calendar was not created by KAlarm
+*             newId:         whether to give the event a new unique ID
+*             alarmList:     the converted event is appended to this list
+*/
+void importEvent(const Event::Ptr& event, bool currentFormat, CalEvent::Types alarmTypes, bool newId,
+                 QHash<CalEvent::Type, QList<KAEvent>>& alarmList)
+{
+    if (event->alarms().isEmpty()  ||  !KAEvent(event).isValid())
+        return;    // ignore events without alarms, or usable alarms
+    CalEvent::Type type = CalEvent::status(event);
+    if (type == CalEvent::TEMPLATE)
     {
-        qCDebug(KALARM_LOG) << "KAlarm::importCalendarFile: Error loading calendar '" << filename <<"'";
-        KAMessageBox::error(parent, xi18nc("@info", "Could not load calendar <filename>%1</filename>.", url.toDisplayString()));
-        return false;
+        // If we know the event was not created by KAlarm, don't treat it as a template
+        if (!currentFormat)
+            type = CalEvent::ACTIVE;
     }
+    if (!(type & alarmTypes))
+        return;
 
-    QString versionString;
-    const bool currentFormat = (KACalendar::updateVersion(calStorage, versionString) != KACalendar::IncompatibleFormat);
-    const Event::List events = cal->rawEvents();
-    for (const Event::Ptr& event : events)
+    Event::Ptr newev(new Event(*event));
+
+    // If there is a display alarm without display text, use the event
+    // summary text instead.
+    if (type == CalEvent::ACTIVE  &&  !newev->summary().isEmpty())
     {
-        if (event->alarms().isEmpty()  ||  !KAEvent(event).isValid())
-            continue;    // ignore events without alarms, or usable alarms
-        CalEvent::Type type = CalEvent::status(event);
-        if (type == CalEvent::TEMPLATE)
+        const Alarm::List& alarms = newev->alarms();
+        for (Alarm::Ptr alarm : alarms)
         {
-            // If we know the event was not created by KAlarm, don't treat it as a template
-            if (!currentFormat)
-                type = CalEvent::ACTIVE;
+            if (alarm->type() == Alarm::Display  &&  alarm->text().isEmpty())
+                alarm->setText(newev->summary());
         }
-        if (!(type & alarmTypes))
-            continue;
+        newev->setSummary(QString());   // KAlarm only uses summary for template names
+    }
+
+    // Give the event a new ID, or ensure that it is in the correct format.
+    const QString id = newId ? CalFormat::createUniqueId() : newev->uid();
+    newev->setUid(CalEvent::uid(id, type));
+
+    alarmList[type] += KAEvent(newev);
+}
+
+/******************************************************************************
+* Read and convert the next batch of events from the calendar file.
+*/
+ImportBatch ImportReader::read()
+{
+    ImportBatch batch;
+    if (!mFile->isOpen()  &&  !mFile->open(QIODevice::ReadOnly))
+    {
+        qCWarning(KALARM_LOG) << "ImportReader::read: Error opening" << mFile->fileName() << ":" << mFile->errorString();
+        batch.error = true;
+        return batch;
+    }
+    Event::List events;
+    if (!mReader.readEvents(IMPORT_BATCH_SIZE, events))
+        batch.error = true;
+    const bool currentFormat = (mReader.version() != KACalendar::IncompatibleFormat);
+    for (const Event::Ptr& event : std::as_const(events))
+        importEvent(event, currentFormat, mAlarmTypes, true, batch.events);
+    batch.position = mFile->pos();
+    batch.size     = mFile->size();
+    batch.atEnd    = mReader.atEnd();
+    return batch;
+}
 
-        Event::Ptr newev(new Event(*event));
 
-        // If there is a display alarm without display text, use the event
-        // summary text instead.
-        if (type == CalEvent::ACTIVE  &&  !newev->summary().isEmpty())
+/******************************************************************************
+* Open the temporary file to write to. If appending, copy the events from the
+* existing calendar file, converting them to the current KAlarm format. The
+* existing calendar's other components (e.g. to-dos) and calendar properties
+* are copied unchanged.
+*/
+bool ExportWriter::open()
+{
+    if (!mFile->open(QIODevice::WriteOnly))
+    {
+        qCWarning(KALARM_LOG) << "ExportWriter::open: Error opening" << mFile->fileName() << ":" << mFile->errorString();
+        return false;
+    }
+    if (mAppend)
+    {
+        QFile existing(mFile->fileName());
+        if (existing.size() > 0)
         {
-            const Alarm::List& alarms = newev->alarms();
-            for (Alarm::Ptr alarm : alarms)
+            if (!existing.open(QIODevice::ReadOnly))
             {
-                if (alarm->type() == Alarm::Display  &&  alarm->text().isEmpty())
-                    alarm->setText(newev->summary());
+                qCWarning(KALARM_LOG) << "ExportWriter::open: Error opening" << existing.fileName() << ":" << existing.errorString();
+                mAppendError = true;
+                return false;
             }
-            newev->setSummary(QString());   // KAlarm only uses summary for template names
+            ICalStreamReader reader(&existing, mTimeZone);
+            bool first = true;
+            while (!reader.atEnd())
+            {
+                Event::List events;
+                if (!reader.readEvents(EXPORT_BATCH_SIZE, events))
+                {
+                    mAppendError = true;
+                    return false;
+                }
+                if (first)
+                {
+                    // The calendar properties precede the first event.
+                    mWriter.setProperties(reader.properties());
+                    first = false;
+                }
+                if (!mWriter.writeEvents(events))
+                    return false;
+            }
+            if (!mWriter.writeComponents(reader.components()))
+                return false;
         }
+    }
+    return true;
+}
 
-        // Give the event a new ID, or ensure that it is in the correct format.
-        const QString id = newId ? CalFormat::createUniqueId() : newev->uid();
-        newev->setUid(CalEvent::uid(id, type));
-
-        alarmList[type] += KAEvent(newev);
+/******************************************************************************
+* Finish writing the calendar, and replace the destination file with it.
+*/
+bool ExportWriter::commit()
+{
+    if (!mWriter.finish())
+        mFile->cancelWriting();
+    if (!mFile->commit())
+    {
+        qCWarning(KALARM_LOG) << "ExportWriter::commit: Error writing" << mFile->fileName() << ":" << mFile->errorString();
+        return false;
     }
     return true;
 }
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include "resource.h"
 #include "kalarmcalendar/kaevent.h"
 
 #include <QHash>
@@ -21,10 +22,11 @@ class QWidget;
 namespace KAlarm
 {
 
-/** Read events from a calendar file. The events are converted to the current
- *  KAlarm format and are optionally given new unique event IDs.
+/** Read events from a local calendar file. The events are converted to the
+ *  current KAlarm format and are optionally given new unique event IDs.
+ *  Use importCalendarFiles() to import remote files.
  *
- *  @param url        URL of calendar file to read
+ *  @param url        URL of local calendar file to read
  *  @param alarmTypes alarm types to read from calendar file; other types are ignored
  *  @param newId      whether to create new IDs for the events
  *  @param parent     parent widget for error messages
@@ -34,6 +36,45 @@ namespace KAlarm
 bool importCalendarFile(const QUrl& url, CalEvent::Types alarmTypes, bool newId,
                         QWidget* parent, QHash<CalEvent::Type, QList<KAEvent>>& events);
 
+/** Import alarms from calendar files into resources. The events are converted
+ *  to the current KAlarm format and are given new unique event IDs.
+ *
+ *  Remote files are downloaded asynchronously before being read. The files
+ *  are read and converted in a background thread, and the alarms are added to
+ *  resources in batches, each batch being saved once. Progress is shown to
+ *  the user, who can cancel the import; alarms which have already been added
+ *  are retained.
+ *
+ *  @param urls       URLs of calendar files to read
+ *  @param alarmTypes alarm types to read from calendar files; other types are ignored
+ *  @param resource   resource to add alarms to; if invalid, the standard
+ *                    resource for each alarm type is used
+ *  @param parent     parent widget for the progress dialog and error messages
+ *  @return  true if any alarms were imported, and all alarms were imported
+ *           successfully; false if any errors occurred, or if cancelled.
+ */
+bool importCalendarFiles(const QList<QUrl>& urls, CalEvent::Types alarmTypes,
+                         Resource& resource, QWidget* parent);
+
+/** Export alarms to a calendar file. The alarms are given new unique event IDs.
+ *
+ *  The alarms are written in batches to a temporary file in a background
+ *  thread, without building the whole calendar in memory. The temporary file
+ *  replaces the destination file only once all alarms have been written, so
+ *  that the destination is unchanged if an error occurs or the user cancels.
+ *  If the destination is remote, it is uploaded in the background, and any
+ *  upload error is reported when the upload completes.
+ *
+ *  @param events   alarms to export
+ *  @param url      URL of calendar file to write
+ *  @param append   whether to append to the existing calendar file, if any.
+ *                  This is only supported if @p url is a local file.
+ *  @param parent   parent widget for the progress dialog and error messages
+ *  @return  true if the alarms were written successfully (or there were none);
+ *           false if any errors occurred, or if cancelled.
+ */
+bool exportCalendarFile(const QList<KAEvent>& events, const QUrl& url, bool append, QWidget* parent);
+
 } // namespace KAlarm
 
 // vim: et sw=4:
@@ -12,8 +12,7 @@
 
 #include <KLocalizedString>
 
-#include <QCoreApplication>
-#include <QThread>
+#include <QEventLoop>
 
 
 /*=============================================================================
@@ -22,6 +21,7 @@
 =============================================================================*/
 
 QList<CalendarUpdater*> CalendarUpdater::mInstances;
+QList<QEventLoop*>      CalendarUpdater::mWaitLoops;
 
 CalendarUpdater::CalendarUpdater(ResourceId resourceId, bool ignoreKeepFormat, QObject* parent, QWidget* promptParent)
     : QObject(parent)
@@ -37,6 +37,7 @@ CalendarUpdater::CalendarUpdater(ResourceId resourceId, bool ignoreKeepFormat, Q
 CalendarUpdater::~CalendarUpdater()
 {
     mInstances.removeAll(this);
+    checkWaitCompleted();
 }
 
 bool CalendarUpdater::containsResource(ResourceId id)
@@ -50,20 +51,49 @@ bool CalendarUpdater::containsResource(ResourceId id)
 }
 
 /******************************************************************************
-* Wait until all instances have completed and been deleted.
+* Return whether all instances have completed.
 */
-void CalendarUpdater::waitForCompletion()
+bool CalendarUpdater::allCompleted()
+{
+    for (const CalendarUpdater* instance : std::as_const(mInstances))
+    {
+        if (!instance->mCompleted)
+            return false;
+    }
+    return true;
+}
+
+/******************************************************************************
+* If waitForCompletion() is waiting, and all instances have completed, tell it
+* to stop waiting.
+*/
+void CalendarUpdater::checkWaitCompleted()
 {
-    while (!mInstances.isEmpty())
+    if (!mWaitLoops.isEmpty()  &&  allCompleted())
     {
-        for (int i = mInstances.count();  --i >= 0;  )
-            if (mInstances.at(i)->isComplete())
-                delete mInstances.at(i);    // the destructor removes the instance from mInstances
+        for (QEventLoop* loop : std::as_const(mWaitLoops))
+            loop->quit();
+    }
+}
 
-        QCoreApplication::processEvents();
-        if (!mInstances.isEmpty())     //cppcheck-suppress knownConditionTrueFalse; 'delete' removes from mInstances
-            QThread::msleep(100);
+/******************************************************************************
+* Wait until all instances have completed, and then delete them.
+* An event loop is run until the last instance notifies its completion, so that
+* there is no delay once the last instance has completed.
+*/
+void CalendarUpdater::waitForCompletion()
+{
+    if (!allCompleted())
+    {
+        QEventLoop loop;
+        mWaitLoops.append(&loop);
+        loop.exec();
+        mWaitLoops.removeAll(&loop);
     }
+
+    for (int i = mInstances.count();  --i >= 0;  )
+        if (mInstances.at(i)->isComplete())
+            delete mInstances.at(i);    // the destructor removes the instance from mInstances
 }
 
 /******************************************************************************
@@ -72,7 +102,9 @@ void CalendarUpdater::waitForCompletion()
 void CalendarUpdater::setCompleted()
 {
     mCompleted = true;
+    Q_EMIT completed(mResourceId);
     deleteLater();
+    checkWaitCompleted();
 }
 
 /******************************************************************************
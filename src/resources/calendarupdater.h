@@ -10,6 +10,8 @@
 
 #include "resource.h"
 
+class QEventLoop;
+
 
 // Updates the backend calendar format of a single alarm calendar
 class CalendarUpdater : public QObject
@@ -30,7 +32,13 @@ public:
 
     static bool pending()   { return !mInstances.isEmpty(); }
 
-    /** Wait until all completed instances have completed and been deleted. */
+    /** Return whether all instances have completed. */
+    static bool allCompleted();
+
+    /** Wait until all instances have completed, and delete them.
+     *  Events are processed while waiting, and the wait ends as soon as the
+     *  last instance completes.
+     */
     static void waitForCompletion();
 
 #if 0
@@ -55,13 +63,19 @@ public Q_SLOTS:
      */
     virtual bool update() = 0;
 
+Q_SIGNALS:
+    /** Emitted when the instance has completed, before it is deleted. */
+    void completed(KAlarmCal::ResourceId);
+
 protected:
     /** Mark the instance as completed, and schedule its deletion. */
     void setCompleted();
 
     static QString conversionPrompt(const QString& calendarName, const QString& calendarVersion, bool whole);
+    static void    checkWaitCompleted();
 
     static QList<CalendarUpdater*> mInstances;
+    static QList<QEventLoop*>      mWaitLoops;   // event loops in waitForCompletion()
     ResourceId mResourceId;
     QObject*   mParent;
     QWidget*   mPromptParent;
@@ -239,7 +239,7 @@ AlarmListModel::AlarmListModel(QObject* parent)
     Resources* resources = Resources::instance();
     connect(resources, &Resources::settingsChanged, this, &AlarmListModel::slotResourceSettingsChanged);
     connect(resources, &Resources::resourceRemoved, this, &AlarmListModel::slotResourceRemoved);
-    connect(resources, &Resources::eventUpdated,    this, &AlarmListModel::slotEventUpdated);
+    connect(resources, &Resources::eventsUpdated,   this, &AlarmListModel::slotEventsUpdated);
     connect(resources, &Resources::eventsRemoved,   this, &AlarmListModel::slotEventsRemoved);
 }
 
@@ -316,6 +316,7 @@ bool AlarmListModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourcePa
             return false;    // only include active alarms in the filter
         const KADateTime::Spec timeSpec = Preferences::timeSpec();
         const KADateTime now = KADateTime::currentDateTime(timeSpec);
+        const KADateTime::Compact compactNow(now);
         auto& resourceHash = mDateFilterCache[ev.resourceId()];
         const auto eit = resourceHash.constFind(ev.id());
         bool haveEvent = (eit != resourceHash.constEnd());
@@ -324,7 +325,7 @@ bool AlarmListModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourcePa
             // Use cached date filter status for this event.
             if (!eit.value().isValid())
                 return false;
-            if (eit.value() < now)
+            if (eit.value() < compactNow)
             {
                 resourceHash.erase(eit); // occurrence has passed - check again
                 haveEvent = false;
@@ -345,7 +346,7 @@ bool AlarmListModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourcePa
                     ev.nextOccurrence(from, nextDt, KAEvent::Repeats::Return);
                     if (!nextDt.isValid())
                     {
-                        resourceHash[ev.id()] = KADateTime();
+                        resourceHash[ev.id()] = KADateTime::Compact();
                         return false;
                     }
                     from = nextDt.effectiveKDateTime().toTimeSpec(timeSpec);
@@ -356,7 +357,7 @@ bool AlarmListModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourcePa
                         while (++i < count  &&  from > mFilterDates[i].second) {}
                         if (i >= count)
                         {
-                            resourceHash[ev.id()] = KADateTime();
+                            resourceHash[ev.id()] = KADateTime::Compact();
                             return false;    // the event occurs after all date ranges
                         }
                         if (from < mFilterDates[i].first)
@@ -376,7 +377,7 @@ bool AlarmListModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourcePa
                     // This occurrence is excluded, so check for another.
                 }
             }
-            resourceHash[ev.id()] = occurs;
+            resourceHash[ev.id()] = KADateTime::Compact(occurs);
             if (!occurs.isValid())
                 return false;
         }
@@ -441,7 +442,7 @@ QVariant AlarmListModel::data(const QModelIndex& ix, int role) const
                             const auto eit = resourceHash.constFind(ev.id());
                             if (eit != resourceHash.constEnd()  &&  eit.value().isValid())
                             {
-                                const KADateTime next = eit.value();
+                                const KADateTime next = eit.value().toDateTime();
                                 switch (role)
                                 {
                                     case Qt::DisplayRole:
@@ -512,14 +513,17 @@ void AlarmListModel::slotResourceRemoved(ResourceId id)
 }
 
 /******************************************************************************
-* Called when an event has been updated.
-* Remove it from the date filter cache.
+* Called when events have been updated.
+* Remove them from the date filter cache.
 */
-void AlarmListModel::slotEventUpdated(Resource& resource, const KAEvent& event)
+void AlarmListModel::slotEventsUpdated(Resource& resource, const QList<KAEvent>& events)
 {
     auto rit = mDateFilterCache.find(resource.id());
     if (rit != mDateFilterCache.end())
-        rit.value().remove(event.id());
+    {
+        for (const KAEvent& event : events)
+            rit.value().remove(event.id());
+    }
 }
 
 /******************************************************************************
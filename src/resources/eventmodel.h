@@ -156,14 +156,14 @@ protected:
 private Q_SLOTS:
     void slotResourceSettingsChanged(Resource&, ResourceType::Changes);
     void slotResourceRemoved(KAlarmCal::ResourceId);
-    void slotEventUpdated(Resource&, const KAlarmCal::KAEvent&);
+    void slotEventsUpdated(Resource&, const QList<KAlarmCal::KAEvent>&);
     void slotEventsRemoved(Resource&, const QList<KAlarmCal::KAEvent>&);
 
 private:
     static AlarmListModel* mAllInstance;
     CalEvent::Types mFilterTypes;    // types of events contained in this model
     QList<std::pair<KADateTime, KADateTime>> mFilterDates; // date/time ranges to include in filter
-    mutable QHash<ResourceId, QHash<QString, KADateTime>> mDateFilterCache;  // if date filter, whether events are included in filter
+    mutable QHash<ResourceId, QHash<QString, KADateTime::Compact>> mDateFilterCache;  // if date filter, first occurrence of each event in filter
     bool mReplaceBlankName {false};  // replace Name with Text for Qt::DisplayRole if Name is blank
 };
 
@@ -378,9 +378,9 @@ void FileResource::loaded(bool success, QHash<QString, KAEvent>& newEvents, cons
         // Set any command execution error flags for the events.
         // These are stored in the KAlarm config file, not the alarm
         // calendar, since they are specific to the user's local system.
-        bool changed = false;
-        QHash<QString, KAEvent::CmdErr> cmdErrors = mSettings->commandErrors();
-        for (auto errit = cmdErrors.begin();  errit != cmdErrors.end();  )
+        QStringList obsolete;
+        const QHash<QString, KAEvent::CmdErr>& cmdErrors = mSettings->commandErrors();
+        for (auto errit = cmdErrors.constBegin();  errit != cmdErrors.constEnd();  ++errit)
         {
             auto evit = newEvents.find(errit.key());
             if (evit != newEvents.end())
@@ -389,18 +389,16 @@ void FileResource::loaded(bool success, QHash<QString, KAEvent>& newEvents, cons
                 if (event.category() == CalEvent::ACTIVE)
                 {
                     event.setCommandError(errit.value());
-                    ++errit;
                     continue;
                 }
             }
             // The event for this command error doesn't exist, or is not active,
             // so remove this command error from the settings.
-            errit = cmdErrors.erase(errit);
-            changed = true;
+            obsolete += errit.key();
         }
 
-        if (changed)
-            mSettings->setCommandErrors(cmdErrors);
+        for (const QString& id : std::as_const(obsolete))
+            mSettings->setCommandError(id, KAEvent::CmdErr::None);
     }
 
     // Update the list of loaded events for the resource.
@@ -504,11 +502,7 @@ bool FileResource::addEvent(const KAEvent& event)
             // Add this event's command error to the settings.
             if (event.category() == CalEvent::ACTIVE
             &&  event.commandError() != KAEvent::CmdErr::None)
-            {
-                QHash<QString, KAEvent::CmdErr> cmdErrors = mSettings->commandErrors();
-                cmdErrors[event.id()] = event.commandError();
-                mSettings->setCommandErrors(cmdErrors);
-            }
+                mSettings->setCommandError(event.id(), event.commandError());
         }
 
         scheduleSave();
@@ -518,6 +512,63 @@ bool FileResource::addEvent(const KAEvent& event)
     return false;
 }
 
+/******************************************************************************
+* Add a list of events to the resource.
+* The events are all notified together, so that they are inserted into data
+* models as a single block, and the resource is only saved once.
+*/
+bool FileResource::addEvents(const QList<KAEvent>& events, QList<int>& failed)
+{
+    qCDebug(KALARM_LOG) << "FileResource::addEvents: count" << events.count();
+    failed.clear();
+    bool usable = false;
+    if (!isValid())
+        qCWarning(KALARM_LOG) << "FileResource::addEvents: Resource invalid!" << displayName();
+    else if (!isEnabled(CalEvent::EMPTY))
+        qCDebug(KALARM_LOG) << "FileResource::addEvents: Resource disabled!" << displayName();
+    else
+        usable = true;
+
+    QList<KAEvent> added;
+    added.reserve(events.count());
+    QList<const KAEvent*> newCmdErrors;
+    for (int i = 0, count = events.count();  i < count;  ++i)
+    {
+        const KAEvent& event = events[i];
+        if (!usable)
+            failed += i;
+        else if (!isWritable(event.category()))
+        {
+            qCWarning(KALARM_LOG) << "FileResource::addEvents: Calendar not writable" << displayName();
+            failed += i;
+        }
+        else if (!doAddEvent(event))
+            failed += i;
+        else
+        {
+            added += event;
+            if (event.category() == CalEvent::ACTIVE
+            &&  event.commandError() != KAEvent::CmdErr::None)
+                newCmdErrors += &event;
+        }
+    }
+    if (added.isEmpty())
+        return false;
+
+    setUpdatedEvents(added, false);
+
+    if (!newCmdErrors.isEmpty()  &&  mSettings  &&  mSettings->isEnabled(CalEvent::ACTIVE))
+    {
+        // Add the new events' command errors to the settings.
+        for (const KAEvent* event : std::as_const(newCmdErrors))
+            mSettings->setCommandError(event->id(), event->commandError());
+    }
+
+    scheduleSave();
+    notifyUpdatedEvents();
+    return true;
+}
+
 /******************************************************************************
 * Update an event in the resource. Its UID must be unchanged.
 */
@@ -576,11 +627,7 @@ bool FileResource::deleteEvent(const KAEvent& event)
         setDeletedEvents({event});
 
         if (mSettings  &&  mSettings->isEnabled(CalEvent::ACTIVE))
-        {
-            QHash<QString, KAEvent::CmdErr> cmdErrors = mSettings->commandErrors();
-            if (cmdErrors.remove(event.id()))
-                mSettings->setCommandErrors(cmdErrors);
-        }
+            mSettings->setCommandError(event.id(), KAEvent::CmdErr::None);
 
         scheduleSave();
         return true;
@@ -589,40 +636,62 @@ bool FileResource::deleteEvent(const KAEvent& event)
 }
 
 /******************************************************************************
-* Save a command error change to the settings.
+* Delete a list of events from the resource.
+* The events are all notified together, so that they are removed from data
+* models in blocks, and the resource is only saved once.
 */
-void FileResource::handleCommandErrorChange(const KAEvent& event)
+bool FileResource::deleteEvents(const QList<KAEvent>& events)
 {
-    if (!mSettings)
-        return;
-    // Update command errors held in the settings, if appropriate.
-    bool changed = false;
-    QHash<QString, KAEvent::CmdErr> cmdErrors = mSettings->commandErrors();
-    if (event.category() != CalEvent::ACTIVE
-    ||  event.commandError() == KAEvent::CmdErr::None)
+    qCDebug(KALARM_LOG) << "FileResource::deleteEvents: count" << events.count();
+    if (!isValid())
     {
-        if (cmdErrors.remove(event.id()))
-            changed = true;
+        qCWarning(KALARM_LOG) << "FileResource::deleteEvents: Resource invalid!" << displayName();
+        return false;
     }
-    else if (event.category() == CalEvent::ACTIVE)
+    if (!isEnabled(CalEvent::EMPTY))
     {
-        auto it = cmdErrors.find(event.id());
-        if (it == cmdErrors.end())
-        {
-            cmdErrors[event.id()] = event.commandError();
-            changed = true;
-        }
-        else if (event.commandError() != it.value())
-        {
-            it.value() = event.commandError();
-            changed = true;
-        }
+        qCDebug(KALARM_LOG) << "FileResource::deleteEvents: Resource disabled!" << displayName();
+        return false;
+    }
+
+    QList<KAEvent> deleted;
+    deleted.reserve(events.count());
+    CalEvent::Types notWritable = CalEvent::EMPTY;
+    for (const KAEvent& event : events)
+    {
+        if (!isWritable(event.category()))
+            notWritable |= event.category();
+        else if (doDeleteEvent(event))
+            deleted += event;
     }
-    if (changed)
+    if (notWritable != CalEvent::EMPTY)
+        qCWarning(KALARM_LOG) << "FileResource::deleteEvents: Calendar not writable" << displayName();
+    if (deleted.isEmpty())
+        return false;
+
+    setDeletedEvents(deleted);
+
+    if (mSettings  &&  mSettings->isEnabled(CalEvent::ACTIVE))
     {
-        mSettings->setCommandErrors(cmdErrors);
-        Resources::notifyEventUpdated(this, event);
+        for (const KAEvent& event : std::as_const(deleted))
+            mSettings->setCommandError(event.id(), KAEvent::CmdErr::None);
     }
+
+    scheduleSave();
+    return true;
+}
+
+/******************************************************************************
+* Save a command error change to the settings.
+*/
+void FileResource::handleCommandErrorChange(const KAEvent& event)
+{
+    if (!mSettings)
+        return;
+    // Update command errors held in the settings, if appropriate.
+    const KAEvent::CmdErr error = (event.category() == CalEvent::ACTIVE) ? event.commandError() : KAEvent::CmdErr::None;
+    if (mSettings->setCommandError(event.id(), error))
+        Resources::notifyEventsUpdated(this, {event});
 }
 
 /******************************************************************************
@@ -649,12 +718,10 @@ QString FileResource::identifier() const
 }
 
 /******************************************************************************
-* Find the compatibility of an existing calendar file.
+* Find the compatibility of a calendar, given its KAlarm format version.
 */
-KACalendar::Compat FileResource::getCompatibility(const KCalendarCore::FileStorage::Ptr& fileStorage, int& version)
+KACalendar::Compat FileResource::getCompatibility(int version)
 {
-    QString versionString;
-    version = KACalendar::updateVersion(fileStorage, versionString);
     switch (version)
     {
         case KACalendar::IncompatibleFormat:
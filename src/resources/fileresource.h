@@ -10,8 +10,6 @@
 
 #include "resourcetype.h"
 
-#include <KCalendarCore/FileStorage>
-
 #include <QSharedPointer>
 #include <QHash>
 
@@ -255,6 +253,16 @@ public:
      */
     bool addEvent(const KAEvent&) override;
 
+    /** Add a list of events to the resource. The new events are notified
+     *  together, and the resource is saved once for all of them.
+     *  Derived classes must implement event addition in doAddEvent().
+     *  @param events  Events to add.
+     *  @param failed  Updated to contain the indexes in @p events of the events
+     *                 which could not be added.
+     *  @return true if any events were added, false if none were added.
+     */
+    bool addEvents(const QList<KAEvent>& events, QList<int>& failed) override;
+
     /** Update an event in the resource. Its UID must be unchanged.
      *  Derived classes must implement event update in doUpdateEvent().
      *  @param saveIfReadOnly  If the resource is read-only, whether to try to save
@@ -268,6 +276,13 @@ public:
      */
     bool deleteEvent(const KAEvent&) override;
 
+    /** Delete a list of events from the resource. The deleted events are
+     *  notified together, and the resource is saved once for all of them.
+     *  Derived classes must implement event deletion in doDeleteEvent().
+     *  @return true if any events were deleted, false if none were deleted.
+     */
+    bool deleteEvents(const QList<KAEvent>&) override;
+
     /** Called to notify the resource that an event's command error has changed. */
     void handleCommandErrorChange(const KAEvent&) override;
 
@@ -288,8 +303,10 @@ protected:
     /** Identifier for use in cache file names etc. */
     QString identifier() const;
 
-    /** Find the compatibility of an existing calendar file. */
-    static KACalendar::Compat getCompatibility(const KCalendarCore::FileStorage::Ptr& fileStorage, int& version);
+    /** Find the compatibility of a calendar, given its KAlarm format version
+     *  as returned by KACalendar::updateVersion().
+     */
+    static KACalendar::Compat getCompatibility(int version);
 
     /** Update the resource to the current KAlarm storage format. */
     virtual bool updateStorageFmt() = 0;
@@ -19,6 +19,8 @@
 #include "lib/synchtimer.h"
 #include "kalarm_debug.h"
 
+#include <QSet>
+
 // Represents a resource or event within the data model.
 struct FileResourceDataModel::Node
 {
@@ -90,8 +92,8 @@ FileResourceDataModel::FileResourceDataModel(QObject* parent)
                  this, &FileResourceDataModel::removeResource);
     connect(resources, &Resources::eventsAdded,
                  this, &FileResourceDataModel::slotEventsAdded);
-    connect(resources, &Resources::eventUpdated,
-                 this, &FileResourceDataModel::slotEventUpdated);
+    connect(resources, &Resources::eventsUpdated,
+                 this, &FileResourceDataModel::slotEventsUpdated);
     connect(resources, &Resources::eventsToBeRemoved,
                  this, &FileResourceDataModel::deleteEvents);
 
@@ -506,27 +508,28 @@ void FileResourceDataModel::slotEventsAdded(Resource& resource, const QList<KAEv
 }
 
 /******************************************************************************
-* Update an event which already exists (and with the same UID) in the model.
+* Update events which already exist (and with the same UIDs) in the model.
 */
-void FileResourceDataModel::slotEventUpdated(Resource& resource, const KAEvent& event)
+void FileResourceDataModel::slotEventsUpdated(Resource& resource, const QList<KAEvent>& events)
 {
-    auto it = mEventNodes.constFind(event.id());
-    if (it != mEventNodes.constEnd())
+    const QList<Node*> eventNodes = mResourceNodes.value(resource);
+    const QModelIndex resourceIx = resourceIndex(resource);
+    for (const KAEvent& event : events)
     {
-        Node* node = it.value();
-        if (node  &&  node->parent() == resource)
+        auto it = mEventNodes.constFind(event.id());
+        if (it != mEventNodes.constEnd())
         {
-            KAEvent* oldEvent = node->event();
-            if (oldEvent)
+            Node* node = it.value();
+            if (node  &&  node->parent() == resource)
             {
-                *oldEvent = event;
-
-                const QList<Node *> eventNodes = mResourceNodes.value(resource);
-                int row = eventNodes.indexOf(node);
-                if (row >= 0)
+                KAEvent* oldEvent = node->event();
+                if (oldEvent)
                 {
-                    const QModelIndex resourceIx = resourceIndex(resource);
-                    Q_EMIT dataChanged(index(row, 0, resourceIx), index(row, ColumnCount - 1, resourceIx));
+                    *oldEvent = event;
+
+                    int row = eventNodes.indexOf(node);
+                    if (row >= 0)
+                        Q_EMIT dataChanged(index(row, 0, resourceIx), index(row, ColumnCount - 1, resourceIx));
                 }
             }
         }
@@ -547,37 +550,44 @@ bool FileResourceDataModel::deleteEvents(Resource& resource, const QList<KAEvent
         return false;
     QList<Node*>& eventNodes = it.value();
 
-    // Find the row numbers of the events to delete.
-    QList<int> rowsToDelete;
-    rowsToDelete.reserve(events.count());
+    // Find the row numbers of the events to delete, in a single pass through
+    // the resource's events.
+    QSet<const Node*> nodesToDelete;
+    nodesToDelete.reserve(events.count());
     for (const KAEvent& event : events)
     {
-        Node* node = mEventNodes.value(event.id(), nullptr);
+        const Node* node = mEventNodes.value(event.id(), nullptr);
         if (node  &&  node->parent() == resource)
-        {
-            int row = eventNodes.indexOf(node);
-            if (row >= 0)
-                rowsToDelete << row;
-        }
+            nodesToDelete.insert(node);
+    }
+    QList<int> rowsToDelete;
+    rowsToDelete.reserve(nodesToDelete.count());
+    for (int row = 0, count = eventNodes.count();  row < count  &&  rowsToDelete.count() < nodesToDelete.count();  ++row)
+    {
+        if (nodesToDelete.contains(eventNodes.at(row)))
+            rowsToDelete << row;
     }
 
-    // Delete the events in groups of consecutive rows (if any).
-    std::sort(rowsToDelete.begin(), rowsToDelete.end());
-    for (int i = 0, count = rowsToDelete.count();  i < count;  )
+    // Delete the events in groups of consecutive rows (if any), starting from
+    // the last group so that the row numbers of earlier groups are unchanged.
+    for (int i = rowsToDelete.count();  i > 0;  )
     {
-        int row = rowsToDelete.at(i);
-        int lastRow = row;
-        while (++i < count  &&  rowsToDelete.at(i) == lastRow + 1)
-            ++lastRow;
+        const int lastRow = rowsToDelete.at(--i);
+        int row = lastRow;
+        while (i > 0  &&  rowsToDelete.at(i - 1) == row - 1)
+        {
+            --row;
+            --i;
+        }
 
         beginRemoveRows(resourceIx, row, lastRow);
-        do
+        for (int r = row;  r <= lastRow;  ++r)
         {
-            Node* node = eventNodes.at(row);
-            eventNodes.removeAt(row);
+            Node* node = eventNodes.at(r);
             mEventNodes.remove(node->event()->id());
             delete node;
-        } while (++row <= lastRow);
+        }
+        eventNodes.remove(row, lastRow - row + 1);
         endRemoveRows();
     }
 
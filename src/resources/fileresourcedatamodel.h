@@ -128,7 +128,7 @@ private Q_SLOTS:
     void     slotResourceSettingsChanged(Resource&, ResourceType::Changes);
     void     removeResource(Resource&);
     void     slotEventsAdded(Resource&, const QList<KAEvent>&);
-    void     slotEventUpdated(Resource&, const KAEvent&);
+    void     slotEventsUpdated(Resource&, const QList<KAEvent>&);
     bool     deleteEvents(Resource&, const QList<KAEvent>&);
 
     /** Called when a resource notifies a message to display to the user. */
@@ -12,6 +12,7 @@
 #include <KConfigGroup>
 
 #include <QFileInfo>
+#include <QTimer>
 
 namespace
 {
@@ -74,6 +75,8 @@ FileResourceSettings::FileResourceSettings(Storage storageType,
 
 FileResourceSettings::~FileResourceSettings()
 {
+    writePendingCommandErrors();
+    delete mCommandErrorTimer;
     delete mConfigGroup;
 }
 
@@ -192,7 +195,10 @@ bool FileResourceSettings::createConfig(KConfig* config, const QString& resource
 void FileResourceSettings::save() const
 {
     if (mConfigGroup)
+    {
+        writePendingCommandErrors();
         mConfigGroup->sync();
+    }
 }
 
 bool FileResourceSettings::isValid() const
@@ -471,19 +477,64 @@ void FileResourceSettings::setHash(const QByteArray& hash, bool sync)
     }
 }
 
-QHash<QString, KAEvent::CmdErr> FileResourceSettings::commandErrors() const
+const QHash<QString, KAEvent::CmdErr>& FileResourceSettings::commandErrors() const
 {
     return mCommandErrors;
 }
 
+KAEvent::CmdErr FileResourceSettings::commandError(const QString& eventId) const
+{
+    return mCommandErrors.value(eventId, KAEvent::CmdErr::None);
+}
+
 void FileResourceSettings::setCommandErrors(const QHash<QString, KAEvent::CmdErr>& cmdErrors, bool sync)
 {
     if (cmdErrors != mCommandErrors)
     {
         mCommandErrors = cmdErrors;
         if (mConfigGroup)
+        {
+            mCommandErrorsPending = false;
             writeConfigCommandErrors(sync);
+        }
+    }
+}
+
+/******************************************************************************
+* Set or clear the command error for one event.
+* Writing to the config file is deferred until control returns to the event
+* loop, so that a batch of changes results in only one config file write.
+*/
+bool FileResourceSettings::setCommandError(const QString& eventId, KAEvent::CmdErr error)
+{
+    if (error == KAEvent::CmdErr::None)
+    {
+        if (!mCommandErrors.remove(eventId))
+            return false;
     }
+    else
+    {
+        auto it = mCommandErrors.find(eventId);
+        if (it == mCommandErrors.end())
+            mCommandErrors.insert(eventId, error);
+        else if (it.value() != error)
+            it.value() = error;
+        else
+            return false;
+    }
+
+    if (mConfigGroup  &&  !mCommandErrorsPending)
+    {
+        mCommandErrorsPending = true;
+        if (!mCommandErrorTimer)
+        {
+            mCommandErrorTimer = new QTimer;
+            mCommandErrorTimer->setSingleShot(true);
+            QObject::connect(mCommandErrorTimer, &QTimer::timeout, mCommandErrorTimer, [this]() { writePendingCommandErrors(); });
+        }
+        mCommandErrorTimer->start(0);
+    }
+    return true;
 }
 
 /******************************************************************************
@@ -608,7 +659,23 @@ void FileResourceSettings::writeConfigHash(bool sync)
         mConfigGroup->sync();
 }
 
-void FileResourceSettings::writeConfigCommandErrors(bool sync)
+/******************************************************************************
+* Write command error changes which have not yet been saved to the config file.
+* If the config group has been deleted (because the resource has been removed),
+* nothing is written.
+*/
+void FileResourceSettings::writePendingCommandErrors() const
+{
+    if (!mCommandErrorsPending)
+        return;
+    mCommandErrorsPending = false;
+    if (mCommandErrorTimer)
+        mCommandErrorTimer->stop();
+    if (mConfigGroup  &&  mConfigGroup->exists())
+        writeConfigCommandErrors(true);
+}
+
+void FileResourceSettings::writeConfigCommandErrors(bool sync) const
 {
     QStringList cmdErrs;
     for (auto it = mCommandErrors.constBegin();  it != mCommandErrors.constEnd();  ++it)
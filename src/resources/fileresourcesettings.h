@@ -20,6 +20,7 @@
 
 class KConfig;
 class KConfigGroup;
+class QTimer;
 
 using namespace KAlarmCal;
 
@@ -266,7 +267,13 @@ public:
      *  command errors.
      *  @return command error types, indexed by event ID.
      */
-    QHash<QString, KAEvent::CmdErr> commandErrors() const;
+    const QHash<QString, KAEvent::CmdErr>& commandErrors() const;
+
+    /** Return the command error for an event.
+     *  @param eventId  the event's ID
+     *  @return command error type, or CmdErr::None if none.
+     */
+    KAEvent::CmdErr commandError(const QString& eventId) const;
 
     /** Set the command error data for all events in the resource which have
      *  command errors.
@@ -275,6 +282,15 @@ public:
      */
     void setCommandErrors(const QHash<QString, KAEvent::CmdErr>& cmdErrors, bool save = true);
 
+    /** Set or clear the command error for one event.
+     *  The change is written to the config file once control returns to the
+     *  event loop, so that multiple changes are saved together.
+     *  @param eventId  the event's ID
+     *  @param error    command error type, or CmdErr::None to clear it.
+     *  @return true if the command error has changed.
+     */
+    bool setCommandError(const QString& eventId, KAEvent::CmdErr error);
+
 protected:
     /** Set the resource's unique ID.
      *  This method can only be called when initialising the instance.
@@ -299,7 +315,8 @@ private:
     void writeConfigKeepFormat(bool save);
     void writeConfigUpdateFormat(bool save);
     void writeConfigHash(bool save);
-    void writeConfigCommandErrors(bool save);
+    void writeConfigCommandErrors(bool save) const;
+    void writePendingCommandErrors() const;
 
     KConfigGroup*     mConfigGroup {nullptr}; // the config group holding all this resource's config
                                               // Until this is set, no notifications will be made
@@ -309,6 +326,7 @@ private:
     QString           mDisplayName;      // name for user display
     QByteArray        mHash;             // hash of the calendar file contents
     QHash<QString, KAEvent::CmdErr> mCommandErrors;  // event IDs and their command error types
+    QTimer*           mCommandErrorTimer {nullptr};  // timer to save command error changes
     QColor            mBackgroundColour; // background colour to display the resource and its alarms
     Storage           mStorageType {Storage::None};  // how the calendar is stored
     CalEvent::Types   mAlarmTypes {CalEvent::EMPTY}; // alarm types which the resource contains
@@ -317,6 +335,7 @@ private:
     bool              mReadOnly {false};  // the resource is read-only
     bool              mKeepFormat {true}; // do not update the calendar file to the current KAlarm format
     bool              mUpdateFormat {false}; // request to update the calendar file to the current KAlarm format
+    mutable bool      mCommandErrorsPending {false}; // command error changes have not been written to config
 };
 
 // vim: et sw=4:
@@ -272,11 +272,28 @@ bool Resource::containsEvent(const QString& eventId) const
     return mResource.isNull() ? false : mResource->containsEvent(eventId);
 }
 
+QList<KAEvent> Resource::archivedEvents(const QDate& createdBefore) const
+{
+    return mResource.isNull() ? QList<KAEvent>() : mResource->archivedEvents(createdBefore);
+}
+
 bool Resource::addEvent(const KAEvent& event)
 {
     return mResource.isNull() ? false : mResource->addEvent(event);
 }
 
+bool Resource::addEvents(const QList<KAEvent>& events, QList<int>& failed)
+{
+    if (mResource.isNull())
+    {
+        failed.clear();
+        for (int i = 0, count = events.count();  i < count;  ++i)
+            failed += i;
+        return false;
+    }
+    return mResource->addEvents(events, failed);
+}
+
 bool Resource::updateEvent(const KAEvent& event, bool saveIfReadOnly)
 {
     return mResource.isNull() ? false : mResource->updateEvent(event, saveIfReadOnly);
@@ -287,6 +304,11 @@ bool Resource::deleteEvent(const KAEvent& event)
     return mResource.isNull() ? false : mResource->deleteEvent(event);
 }
 
+bool Resource::deleteEvents(const QList<KAEvent>& events)
+{
+    return mResource.isNull() ? false : mResource->deleteEvents(events);
+}
+
 void Resource::adjustStartOfDay()
 {
     if (!mResource.isNull())
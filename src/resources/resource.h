@@ -329,9 +329,26 @@ public:
      */
     bool containsEvent(const QString& eventId) const;
 
+    /** Return the archived events which were created before a given date, in
+     *  order of creation date, provided that archived alarms are enabled for
+     *  the resource.
+     *  @param createdBefore  Only return events created before this date, or
+     *                        if invalid, return all archived events.
+     */
+    QList<KAEvent> archivedEvents(const QDate& createdBefore = QDate()) const;
+
     /** Add an event to the resource. */
     bool addEvent(const KAEvent&);
 
+    /** Add a list of events to the resource. The new events are notified
+     *  together, and the resource is saved once for all of them.
+     *  @param events  Events to add.
+     *  @param failed  Updated to contain the indexes in @p events of the events
+     *                 which could not be added.
+     *  @return true if any events were added, false if none were added.
+     */
+    bool addEvents(const QList<KAEvent>& events, QList<int>& failed);
+
     /** Update an event in the resource. Its UID must be unchanged.
      *  @param saveIfReadOnly  If the resource is read-only, whether to try to save
      *                         the resource after updating the event. (A writable
@@ -342,6 +359,12 @@ public:
     /** Delete an event from the resource. */
     bool deleteEvent(const KAEvent&);
 
+    /** Delete a list of events from the resource. The deleted events are
+     *  notified together, and the resource is saved once for all of them.
+     *  @return true if any events were deleted, false if none were deleted.
+     */
+    bool deleteEvents(const QList<KAEvent>&);
+
     /** To be called when the start-of-day time has changed, to adjust the start
      *  times of all date-only alarms' recurrences.
      */
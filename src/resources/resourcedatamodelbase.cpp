@@ -173,6 +173,7 @@ bool ResourceDataModelBase::roleHandled(int role) const
         case AlarmActionsRole:
         case AlarmSubActionRole:
         case CommandErrorRole:
+        case DisplayColourRole:
             return true;
         default:
             return false;
@@ -252,6 +253,10 @@ QVariant ResourceDataModelBase::eventData(int role, int column, const KAEvent& e
                 return static_cast<int>(event.actionSubType());
             case CommandErrorRole:
                 return static_cast<int>(event.commandError());
+            case DisplayColourRole:
+                if (event.actionTypes() & KAEvent::Action::Display)
+                    return event.bgColour();
+                return {};
             default:
                 break;
         }
@@ -61,7 +61,8 @@ public:
         SortRole,                  // the value to use for sorting
         TimeDisplayRole,           // time column value with '~' representing omitted leading zeroes
         ColumnTitleRole,           // column titles (whether displayed or not)
-        CommandErrorRole           // last command execution error for alarm (per user)
+        CommandErrorRole,          // last command execution error for alarm (per user)
+        DisplayColourRole          // background colour of a display alarm, else invalid
     };
     /** The type of a model row. */
     enum class Type { Error = 0, Event, Resource };
@@ -538,13 +538,13 @@ void Resources::notifyEventsAdded(ResourceType* res, const QList<KAEvent>& event
     }
 }
 
-void Resources::notifyEventUpdated(ResourceType* res, const KAEvent& event)
+void Resources::notifyEventsUpdated(ResourceType* res, const QList<KAEvent>& events)
 {
     if (res)
     {
         Resource r = resource(res->id());
         if (r.isValid())
-            Q_EMIT instance()->eventUpdated(r, event);
+            Q_EMIT instance()->eventsUpdated(r, events);
     }
 }
 
@@ -199,10 +199,10 @@ public:
     /** Called by a resource to notify that it has added events. */
     static void notifyEventsAdded(ResourceType*, const QList<KAEvent>&);
 
-    /** Called by a resource to notify that it has changed an event.
-     *  The event's UID must be unchanged.
+    /** Called by a resource to notify that it has changed events.
+     *  The events' UIDs must be unchanged.
      */
-    static void notifyEventUpdated(ResourceType*, const KAEvent& event);
+    static void notifyEventsUpdated(ResourceType*, const QList<KAEvent>&);
 
     /** Called by a resource to notify that it is about to delete events. */
     static void notifyEventsToBeRemoved(ResourceType*, const QList<KAEvent>&);
@@ -265,11 +265,11 @@ Q_SIGNALS:
      */
     void eventsAdded(Resource&, const QList<KAEvent>&);
 
-    /** Emitted when an event has been updated in a resource.
+    /** Emitted when events have been updated in a resource.
      *  Events are only notified whose alarm type is enabled.
-     *  The event's UID is unchanged.
+     *  The events' UIDs are unchanged.
      */
-    void eventUpdated(Resource&, const KAEvent&);
+    void eventsUpdated(Resource&, const QList<KAEvent>&);
 
     /** Emitted when events are about to be deleted from a resource.
      *  Events are only notified whose alarm type is enabled.
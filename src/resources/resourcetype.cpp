@@ -177,10 +177,34 @@ void ResourceType::removeResource(ResourceId id)
     Resources::removeResource(id);
 }
 
+/******************************************************************************
+* Return the archived events which were created before a given date, in order
+* of creation date.
+* The events are found from the creation date index, so that only the events
+* to be returned need to be examined.
+*/
+QList<KAEvent> ResourceType::archivedEvents(const QDate& createdBefore) const
+{
+    QList<KAEvent> events;
+    if (!(enabledTypes() & CalEvent::ARCHIVED))
+        return events;
+    const auto end = createdBefore.isValid() ? mArchivedEvents.lowerBound(createdBefore) : mArchivedEvents.constEnd();
+    for (auto it = mArchivedEvents.constBegin();  it != end;  ++it)
+    {
+        auto eit = mEvents.constFind(it.value());
+        if (eit != mEvents.constEnd())
+            events += eit.value();
+    }
+    return events;
+}
+
 /******************************************************************************
 * To be called when the resource has loaded, to update the list of loaded
 * events for the resource.
 * Added, updated and deleted events are notified, only for enabled alarm types.
+* Existing events whose calendar data is unchanged, as shown by their
+* fingerprints, are retained without being compared or replaced, so that their
+* data continues to be shared with other copies.
 */
 void ResourceType::setLoadedEvents(QHash<QString, KAEvent>& newEvents)
 {
@@ -191,6 +215,7 @@ void ResourceType::setLoadedEvents(QHash<QString, KAEvent>& newEvents)
     // longer exist.
     QStringList    eventsToDelete;
     QList<KAEvent> eventsToNotifyDelete;
+    QList<KAEvent> eventsToNotifyUpdate;
     QList<KAEvent> eventsToNotifyNewlyEnabled;   // only if mNewlyEnabled is true
     for (auto it = mEvents.begin();  it != mEvents.end();  ++it)
     {
@@ -198,6 +223,7 @@ void ResourceType::setLoadedEvents(QHash<QString, KAEvent>& newEvents)
         auto newit = newEvents.find(id);
         if (newit == newEvents.end())
         {
+            indexArchivedEvent(it.value(), false);
             eventsToDelete << id;
             if (it.value().category() & types)
                 eventsToNotifyDelete << it.value();   // this event no longer exists
@@ -205,16 +231,27 @@ void ResourceType::setLoadedEvents(QHash<QString, KAEvent>& newEvents)
         else
         {
             KAEvent& event = it.value();
-            bool changed = !event.compare(newit.value(), KAEvent::Compare::Id | KAEvent::Compare::CurrentState);
-            event = newit.value();   // update existing event
-            event.setResourceId(mId);
+            const KAEvent& newEvent = newit.value();
+            if (!event.fingerprint()  ||  event.fingerprint() != newEvent.fingerprint()
+            ||  event.commandError() != newEvent.commandError()
+            ||  event.compatibility() != newEvent.compatibility())
+            {
+                const bool changed = !event.compare(newEvent, KAEvent::Compare::Id | KAEvent::Compare::CurrentState);
+                indexArchivedEvent(event, false);
+                event = newEvent;   // update existing event
+                if (event.resourceId() != mId)
+                    event.setResourceId(mId);
+                indexArchivedEvent(event, true);
+                if (changed  &&  (event.category() & types))
+                    eventsToNotifyUpdate << event;
+            }
             newEvents.erase(newit);
             if (mNewlyEnabled)
                 eventsToNotifyNewlyEnabled << event;
-            if (changed  &&  (event.category() & types))
-                Resources::notifyEventUpdated(this, event);
         }
     }
+    if (!eventsToNotifyUpdate.isEmpty())
+        Resources::notifyEventsUpdated(this, eventsToNotifyUpdate);
 
     // Delete events which no longer exist.
     if (!eventsToNotifyDelete.isEmpty())
@@ -227,8 +264,10 @@ void ResourceType::setLoadedEvents(QHash<QString, KAEvent>& newEvents)
     // Add new events.
     for (auto newit = newEvents.begin();  newit != newEvents.end(); )
     {
-        newit.value().setResourceId(mId);
+        if (newit.value().resourceId() != mId)
+            newit.value().setResourceId(mId);
         mEvents[newit.key()] = newit.value();
+        indexArchivedEvent(newit.value(), true);
         if (newit.value().category() & types)
             ++newit;
         else
@@ -259,6 +298,7 @@ void ResourceType::setUpdatedEvents(const QList<KAEvent>& events, bool notify)
             KAEvent& ev = mEvents[event.id()];
             ev = event;
             ev.setResourceId(mId);
+            indexArchivedEvent(ev, true);
             if (event.category() & types)
                 mEventsAdded += ev;
         }
@@ -266,19 +306,23 @@ void ResourceType::setUpdatedEvents(const QList<KAEvent>& events, bool notify)
         {
             KAEvent& ev = it.value();
             bool changed = !ev.compare(event, KAEvent::Compare::Id | KAEvent::Compare::CurrentState);
+            indexArchivedEvent(ev, false);
             ev = event;   // update existing event
             ev.setResourceId(mId);
+            indexArchivedEvent(ev, true);
             if (changed  &&  (event.category() & types))
-            {
-                if (notify)
-                    Resources::notifyEventUpdated(this, event);
-                else
-                    mEventsUpdated += event;
-            }
+                mEventsUpdated += event;
         }
     }
-    if (notify  &&  !mEventsAdded.isEmpty())
-        Resources::notifyEventsAdded(this, mEventsAdded);
+    if (notify)
+    {
+        if (!mEventsUpdated.isEmpty())
+            Resources::notifyEventsUpdated(this, mEventsUpdated);
+        if (!mEventsAdded.isEmpty())
+            Resources::notifyEventsAdded(this, mEventsAdded);
+        mEventsUpdated.clear();
+        mEventsAdded.clear();
+    }
 }
 
 /******************************************************************************
@@ -287,8 +331,8 @@ void ResourceType::setUpdatedEvents(const QList<KAEvent>& events, bool notify)
 */
 void ResourceType::notifyUpdatedEvents()
 {
-    for (const KAEvent& event : std::as_const(mEventsUpdated))
-        Resources::notifyEventUpdated(this, event);
+    if (!mEventsUpdated.isEmpty())
+        Resources::notifyEventsUpdated(this, mEventsUpdated);
     mEventsUpdated.clear();
 
     if (!mEventsAdded.isEmpty())
@@ -307,8 +351,10 @@ void ResourceType::setDeletedEvents(const QList<KAEvent>& events)
     QList<KAEvent> eventsToNotify;
     for (const KAEvent& event : events)
     {
-        if (mEvents.constFind(event.id()) != mEvents.constEnd())
+        auto it = mEvents.constFind(event.id());
+        if (it != mEvents.constEnd())
         {
+            indexArchivedEvent(it.value(), false);
             eventsToDelete += event.id();
             if (event.category() & types)
                 eventsToNotify += event;
@@ -322,6 +368,21 @@ void ResourceType::setDeletedEvents(const QList<KAEvent>& events)
         Resources::notifyEventsRemoved(this, eventsToNotify);
 }
 
+/******************************************************************************
+* Add an event to, or remove it from, the creation date index of archived
+* events. Events which are not archived are ignored.
+*/
+void ResourceType::indexArchivedEvent(const KAEvent& event, bool add)
+{
+    if (event.category() != CalEvent::ARCHIVED)
+        return;
+    const QDate created = event.createdDateTime().date();
+    if (add)
+        mArchivedEvents.insert(created, event.id());
+    else
+        mArchivedEvents.remove(created, event.id());
+}
+
 void ResourceType::setLoaded(bool loaded) const
 {
     if (loaded != mLoaded)
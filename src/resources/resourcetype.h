@@ -11,6 +11,8 @@
 #include "kalarmcalendar/kacalendar.h"
 #include "kalarmcalendar/kaevent.h"
 
+#include <QDate>
+#include <QMultiMap>
 #include <QObject>
 #include <QSharedPointer>
 #include <QUrl>
@@ -371,9 +373,26 @@ public:
      */
     bool containsEvent(const QString& eventId) const;
 
+    /** Return the archived events which were created before a given date, in
+     *  order of creation date, provided that archived alarms are enabled for
+     *  the resource.
+     *  @param createdBefore  Only return events created before this date, or
+     *                        if invalid, return all archived events.
+     */
+    QList<KAEvent> archivedEvents(const QDate& createdBefore = QDate()) const;
+
     /** Add an event to the resource. */
     virtual bool addEvent(const KAEvent&) = 0;
 
+    /** Add a list of events to the resource. The new events are notified
+     *  together, and the resource is saved once for all of them.
+     *  @param events  Events to add.
+     *  @param failed  Updated to contain the indexes in @p events of the events
+     *                 which could not be added.
+     *  @return true if any events were added, false if none were added.
+     */
+    virtual bool addEvents(const QList<KAEvent>& events, QList<int>& failed) = 0;
+
     /** Update an event in the resource. Its UID must be unchanged.
      *  @param saveIfReadOnly  If the resource is read-only, whether to try to save
      *                         the resource after updating the event. (A writable
@@ -384,6 +403,12 @@ public:
     /** Delete an event from the resource. */
     virtual bool deleteEvent(const KAEvent&) = 0;
 
+    /** Delete a list of events from the resource. The deleted events are
+     *  notified together, and the resource is saved once for all of them.
+     *  @return true if any events were deleted, false if none were deleted.
+     */
+    virtual bool deleteEvents(const QList<KAEvent>&) = 0;
+
     /** To be called when the start-of-day time has changed, to adjust the start
      *  times of all date-only alarms' recurrences.
      */
@@ -481,8 +506,10 @@ protected:
 private:
     static ResourceType* data(Resource&);
     static const ResourceType* data(const Resource&);
+    void indexArchivedEvent(const KAEvent&, bool add);
 
     QHash<QString, KAEvent> mEvents;     // all events (of ALL types) in the resource, indexed by ID
+    QMultiMap<QDate, QString> mArchivedEvents;  // IDs of archived events in mEvents, by creation date
     QList<KAEvent> mEventsAdded;         // events added to mEvents but not yet notified
     QList<KAEvent> mEventsUpdated;       // events updated in mEvents but not yet notified
     ResourceId   mId {-1};               // resource's ID, which can't be changed
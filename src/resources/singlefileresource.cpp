@@ -13,12 +13,12 @@
 #include "singlefileresource.h"
 
 #include "resources.h"
+#include "kalarmcalendar/icalstreamreader.h"
+#include "kalarmcalendar/icalstreamwriter.h"
 #include "kalarmcalendar/kacalendar.h"
 #include "kalarmcalendar/kaevent.h"
 #include "kalarm_debug.h"
 
-#include <KCalendarCore/ICalFormat>
-
 #include <KIO/Job>
 #include <KDirWatch>
 #include <KLocalizedString>
@@ -27,6 +27,8 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QCryptographicHash>
+#include <QSaveFile>
+#include <QSet>
 #include <QStandardPaths>
 #include <QTimer>
 #include <QTimeZone>
@@ -40,6 +42,8 @@ Q_DECLARE_METATYPE(QEventLoopLocker*)
 namespace
 {
 const int SAVE_TIMER_DELAY = 1000;   // 1 second
+const int LOAD_BATCH_SIZE  = 500;    // number of events to parse together when loading
+const int SAVE_BATCH_SIZE  = 500;    // number of events to serialise together when saving
 }
 
 Resource SingleFileResource::create(FileResourceSettings::Ptr settings)
@@ -108,14 +112,14 @@ bool SingleFileResource::updateStorageFmt()
 {
     if (failed()  ||  readOnly()  ||  enabledTypes() == CalEvent::EMPTY  ||  !mSettings)
         return false;
-    if (!mFileStorage)
+    if (!mCalendarOpen)
     {
         qCCritical(KALARM_LOG) << "SingleFileResource::updateStorageFormat:" << displayId() << "Calendar not open";
         return false;
     }
 
-    QString versionString;
-    if (KACalendar::updateVersion(mFileStorage, versionString) != KACalendar::CurrentFormat)
+    // The events were converted to the current format when they were read.
+    if (mCompatibility == KACalendar::Incompatible)
     {
         qCWarning(KALARM_LOG) << "SingleFileResource::updateStorageFormat:" << displayId() << "Cannot convert calendar to current storage format";
         return false;
@@ -137,20 +141,23 @@ bool SingleFileResource::updateStorageFmt()
 bool SingleFileResource::reload(bool discardMods)
 {
     mCurrentHash.clear();   // ensure that load() re-reads the file
-    mLoadedEvents.clear();
+    clearEventHashes();
 
     if (!isEnabled(CalEvent::EMPTY))
         return false;
     qCDebug(KALARM_LOG) << "SingleFileResource::reload()" << displayName();
 
     // If it has been modified since its last load, write it back to save the changes.
-    if (!discardMods  &&  mCalendar  &&  mCalendar->isModified()
+    if (!discardMods  &&  mCalendarOpen  &&  mModified
     &&  !mSaveUrl.isEmpty()  &&  isWritable(CalEvent::EMPTY))
     {
         if (save())
             return true;  // no need to load again - we would re-read what has just been saved
     }
 
+    mLoadedEvents.clear();
+    mOtherEvents.clear();
+    mModified = false;
     return load();
 }
 
@@ -202,15 +209,12 @@ int SingleFileResource::doLoad(QHash<QString, KAEvent>& newEvents, bool readThro
         // It's a local file.
         // Cache file name, because readLocalFile() will clear mSaveUrl on failure.
         localFileName = settingsLocalFileName;
-        if (mFileStorage  &&  localFileName != mFileStorage->fileName())
+        if (!mFileName.isEmpty()  &&  localFileName != mFileName)
         {
             // The resource's location should never change, so this code should
             // never be reached!
             qCWarning(KALARM_LOG) << "SingleFileResource::load:" << displayId() << "Error? File location changed to" << localFileName;
             setLoadFailure(true, Status::NotConfigured);
-            mFileStorage.reset();
-            mCalendar.reset();
-            mLoadedEvents.clear();
         }
 
         // Check if the file exists, and if not, create it
@@ -302,14 +306,21 @@ int SingleFileResource::doLoad(QHash<QString, KAEvent>& newEvents, bool readThro
 void SingleFileResource::setLoadFailure(bool exists, Status newStatus)
 {
     setStatus(newStatus);
+    mCalendarOpen = false;
+    mModified = false;
+    mFileName.clear();
     mLoadedEvents.clear();
+    mOtherEvents.clear();
+    mCalendarProperties.clear();
+    mCalendarComponents.clear();
+    clearEventHashes();
     QHash<QString, KAEvent> events;
     setLoadedEvents(events);
     setLoaded(!exists);
 }
 
 /******************************************************************************
-* Write the current mCalendar to the backend file, if it has changed since the
+* Write the current events to the backend file, if it has changed since the
 * last load() or save().
 * The file location to write to is given by mSaveUrl. This is for two reasons:
 * 1) to ensure that if the file location has changed (which shouldn't happen!),
@@ -320,7 +331,7 @@ int SingleFileResource::doSave(bool writeThroughCache, bool force, QString& erro
 {
     mSaveTimer->stop();
 
-    if (!force  &&  mCalendar  &&  !mCalendar->isModified())
+    if (!force  &&  mCalendarOpen  &&  !mModified)
         return 1;    // there are no changes to save
 
     if (mSaveUrl.isEmpty())
@@ -359,11 +370,15 @@ int SingleFileResource::doSave(bool writeThroughCache, bool force, QString& erro
     }
 
     // Write to the local file or the cache file.
-    // This sets the 'modified' status of mCalendar to false.
+    // On success, this also records the file's hash and its events' hashes.
     const bool writeResult = writeToFile(localFileName, errorMessage);
-    // Update the hash so we can detect at localFileChanged() if the file actually
+    if (!writeResult)
+    {
+        mCurrentHash = calculateHash(localFileName);
+        clearEventHashes();
+    }
+    // Save the hash so we can detect at localFileChanged() if the file actually
     // did change.
-    mCurrentHash = calculateHash(localFileName);
     saveHash(mCurrentHash);
     if (isLocalFile)
     {
@@ -430,8 +445,14 @@ void SingleFileResource::close()
 
     if (mSettings  &&  mSettings->url().isLocalFile())
         KDirWatch::self()->removeFile(mSettings->url().toLocalFile());
-    mCalendar.reset();
-    mFileStorage.reset();
+    mCalendarOpen = false;
+    mModified = false;
+    mFileName.clear();
+    mLoadedEvents.clear();
+    mOtherEvents.clear();
+    mCalendarProperties.clear();
+    mCalendarComponents.clear();
+    clearEventHashes();
     setStatus(Status::Closed);
 }
 
@@ -450,40 +471,28 @@ void SingleFileResource::removeSettings()
 */
 bool SingleFileResource::doAddEvent(const KAEvent& event)
 {
-    if (!mCalendar)
+    if (!mCalendarOpen)
     {
         qCCritical(KALARM_LOG) << "SingleFileResource::addEvent:" << displayId() << "Calendar not open";
         return false;
     }
-
-    KCalendarCore::Event::Ptr kcalEvent(new KCalendarCore::Event);
-    event.updateKCalEvent(kcalEvent, KAEvent::UidAction::Set);
-    if (!mCalendar->addEvent(kcalEvent))
-    {
-        qCCritical(KALARM_LOG) << "SingleFileResource::addEvent:" << displayId() << "Error adding event with id" << event.id();
-        return false;
-    }
-    return addLoadedEvent(kcalEvent);
-}
-
-/******************************************************************************
-* Add an event to the list of loaded events.
-*/
-bool SingleFileResource::addLoadedEvent(const KCalendarCore::Event::Ptr& kcalEvent)
-{
     if (!mSettings)
         return false;
 
-    KAEvent event(kcalEvent);
-    if (!event.isValid())
+    const QString id = event.id();
+    if (id.isEmpty()  ||  !event.isValid()
+    ||  mLoadedEvents.contains(id)  ||  mOtherEvents.contains(id))
     {
-        qCDebug(KALARM_LOG) << "SingleFileResource::addLoadedEvent:" << displayId() << "Invalid event:" << kcalEvent->uid();
+        qCCritical(KALARM_LOG) << "SingleFileResource::addEvent:" << displayId() << "Error adding event with id" << id;
         return false;
     }
 
-    event.setResourceId(mSettings->id());
-    event.setCompatibility(mCompatibility);
-    mLoadedEvents[event.id()] = event;
+    KAEvent newEvent(event);
+    newEvent.setResourceId(mSettings->id());
+    newEvent.setCompatibility(mCompatibility);
+    mLoadedEvents[id] = newEvent;
+    mEventHashes.remove(id);
+    mModified = true;
     return true;
 }
 
@@ -493,28 +502,33 @@ bool SingleFileResource::addLoadedEvent(const KCalendarCore::Event::Ptr& kcalEve
 */
 bool SingleFileResource::doUpdateEvent(const KAEvent& event)
 {
-    if (!mCalendar)
+    if (!mCalendarOpen)
     {
         qCCritical(KALARM_LOG) << "SingleFileResource::updateEvent:" << displayId() << "Calendar not open";
         return false;
     }
+    if (!mSettings)
+        return false;
 
-    KCalendarCore::Event::Ptr calEvent = mCalendar->event(event.id());
-    if (!calEvent)
+    auto it = mLoadedEvents.find(event.id());
+    if (it == mLoadedEvents.end())
     {
         qCWarning(KALARM_LOG) << "SingleFileResource::doUpdateEvent:" << displayId() << "Event not found" << event.id();
         return false;
     }
-    if (calEvent->isReadOnly())
+    if (it.value().isReadOnly())
     {
         qCWarning(KALARM_LOG) << "SingleFileResource::updateEvent:" << displayId() << "Event is read only:" << event.id();
         return false;
     }
 
     // Update the event in place.
-    mCalendar->deleteEventInstances(calEvent);
-    event.updateKCalEvent(calEvent, KAEvent::UidAction::Set);
-    mCalendar->setModified(true);
+    mEventHashes.remove(event.id());   // the loaded event no longer matches the file
+    KAEvent& loadedEvent = it.value();
+    loadedEvent = event;
+    loadedEvent.setResourceId(mSettings->id());
+    loadedEvent.setCompatibility(mCompatibility);
+    mModified = true;
     return true;
 }
 
@@ -523,31 +537,26 @@ bool SingleFileResource::doUpdateEvent(const KAEvent& event)
 */
 bool SingleFileResource::doDeleteEvent(const KAEvent& event)
 {
-    if (!mCalendar)
+    if (!mCalendarOpen)
     {
         qCCritical(KALARM_LOG) << "SingleFileResource::doDeleteEvent:" << displayId() << "Calendar not open";
         return false;
     }
 
-    bool found = false;
-    const KCalendarCore::Event::Ptr calEvent = mCalendar->event(event.id());
-    if (calEvent)
+    auto it = mLoadedEvents.find(event.id());
+    if (it == mLoadedEvents.end())
     {
-        if (calEvent->isReadOnly())
-        {
-            qCWarning(KALARM_LOG) << "SingleFileResource::updateEvent:" << displayId() << "Event is read only:" << event.id();
-            return false;
-        }
-        found = mCalendar->deleteEvent(calEvent);
-        mCalendar->deleteEventInstances(calEvent);
+        qCWarning(KALARM_LOG) << "SingleFileResource::doDeleteEvent:" << displayId() << "Event not found" << event.id();
+        return false;
     }
-    mLoadedEvents.remove(event.id());
-
-    if (!found)
+    if (it.value().isReadOnly())
     {
-        qCWarning(KALARM_LOG) << "SingleFileResource::doDeleteEvent:" << displayId() << "Event not found" << event.id();
+        qCWarning(KALARM_LOG) << "SingleFileResource::updateEvent:" << displayId() << "Event is read only:" << event.id();
         return false;
     }
+    mLoadedEvents.erase(it);
+    mEventHashes.remove(event.id());
+    mModified = true;
     return true;
 }
 
@@ -590,63 +599,352 @@ bool SingleFileResource::readLocalFile(const QString& fileName, QString& errorMe
 bool SingleFileResource::readFromFile(const QString& fileName, QString& errorMessage)
 {
     qCDebug(KALARM_LOG) << "SingleFileResource::readFromFile:" << fileName;
-    mLoadedEvents.clear();
-    mCalendar.reset(new KCalendarCore::MemoryCalendar(QTimeZone::utc()));
-    mFileStorage.reset(new KCalendarCore::FileStorage(mCalendar, fileName, new KCalendarCore::ICalFormat()));
-    const bool result = mFileStorage->load();
-    if (!result)
+    if (mHeaderHash  &&  mCalendarOpen  &&  fileName == mFileName)
     {
-        qCCritical(KALARM_LOG) << "SingleFileResource::readFromFile: Error loading file " << fileName;
-        errorMessage = xi18nc("@info", "Could not load file <filename>%1</filename>.", fileName);
-        return false;
+        // The file has been read or written before, so try to re-read only
+        // the events which have changed.
+        const int result = readEvents(fileName, true, errorMessage);
+        if (result)
+            return result > 0;
     }
-    if (mCalendar->incidences().isEmpty())
+    return readEvents(fileName, false, errorMessage) > 0;
+}
+
+/******************************************************************************
+* Read the events in the given local file, and convert them to KAEvents.
+* The file is read and parsed a batch of events at a time, without building a
+* calendar containing all its events, so that only the KAEvents are kept.
+* Events which are not valid KAlarm events are kept unaltered, so that they can
+* be written back when the calendar is saved.
+* If 'changesOnly' is true, events are identified by the hash of their VEVENT
+* text, so that only the text of new and changed events needs to be parsed.
+* Reply = 0 if 'changesOnly' is true and the whole file must be read instead,
+* because its calendar properties or time zones have changed, or its events
+* cannot be matched up with those already loaded. In this case, nothing is
+* altered.
+*/
+int SingleFileResource::readEvents(const QString& fileName, bool changesOnly, QString& errorMessage)
+{
+    if (!mSettings)
+        return -1;
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
     {
-        // It's a new file. Set up the KAlarm custom property.
-        KACalendar::setKAlarmVersion(mCalendar);
+        qCCritical(KALARM_LOG) << "SingleFileResource::readFromFile: Error opening file" << fileName << file.errorString();
+        errorMessage = xi18nc("@info", "Could not load file <filename>%1</filename>.", fileName);
+        return -1;
     }
-    mCompatibility = getCompatibility(mFileStorage, mVersion);
+    ICalStreamReader reader(&file, QTimeZone::utc());
+
+    QHash<QString, KAEvent> loadedEvents;
+    QMultiHash<QString, KCalendarCore::Event::Ptr> otherEvents;
+    QHash<QString, size_t> hashes;
+    bool hashesValid = true;   // hashes can be used to identify the events next time
+    // A calendar containing no events (e.g. a new file) is treated as being
+    // in the current KAlarm format.
+    int  version = changesOnly ? mVersion : KACalendar::CurrentFormat;
+    KACalendar::Compat compatibility = changesOnly ? mCompatibility : KACalendar::Current;
+    bool versionRead = changesOnly;
+    QByteArray batch;          // text of the events waiting to be parsed
+    QSet<QString> batchUids;   // UIDs of the events waiting to be parsed
+    int eventCount = 0;
+    int changedCount = 0;
+
+    // Parse the events waiting to be parsed, and convert them to KAEvents.
+    auto parseBatch = [&]() -> int
+    {
+        KCalendarCore::Event::List kcalEvents;
+        if (changesOnly)
+        {
+            // Only current format calendars are re-read in part, and the
+            // result is discarded if the calendar header has changed, so
+            // there is no need to find the calendar's version again.
+            reader.setFileVersion(KACalendar::CurrentFormat);
+        }
+        if (!reader.parseEvents(batch, kcalEvents))
+        {
+            if (changesOnly)
+                return 0;
+            qCCritical(KALARM_LOG) << "SingleFileResource::readFromFile: Error loading file " << fileName;
+            errorMessage = xi18nc("@info", "Could not load file <filename>%1</filename>.", fileName);
+            return -1;
+        }
+        if (!versionRead)
+        {
+            version = reader.version();
+            compatibility = getCompatibility(version);
+            versionRead = true;
+        }
+        if (kcalEvents.count() != batchUids.count())
+        {
+            if (changesOnly)
+                return 0;
+            hashesValid = false;
+        }
+        for (const KCalendarCore::Event::Ptr& kcalEvent : std::as_const(kcalEvents))
+        {
+            const QString uid = kcalEvent->uid();
+            if (!batchUids.contains(uid))
+            {
+                if (changesOnly)
+                    return 0;
+                hashesValid = false;
+            }
+            if (kcalEvent->alarms().isEmpty())
+            {
+                qCDebug(KALARM_LOG) << "SingleFileResource::readFromFile:" << displayId() << "KCalendarCore::Event has no alarms:" << uid;
+                otherEvents.insert(uid, kcalEvent);
+                continue;
+            }
+            if (kcalEvent->hasRecurrenceId()  ||  loadedEvents.contains(uid))
+            {
+                // KAlarm uses only one event per UID. Keep any others (e.g.
+                // instances of recurring events, or duplicates in an edited
+                // or imported file) so that they are written back unchanged.
+                qCWarning(KALARM_LOG) << "SingleFileResource::readFromFile:" << displayId() << "Ignoring additional event with same UID:" << uid;
+                otherEvents.insert(uid, kcalEvent);
+                continue;
+            }
+            KAEvent event(kcalEvent);
+            if (!event.isValid())
+            {
+                qCDebug(KALARM_LOG) << "SingleFileResource::readFromFile:" << displayId() << "Invalid event:" << uid;
+                otherEvents.insert(uid, kcalEvent);
+                continue;
+            }
+            event.setResourceId(mSettings->id());
+            event.setCompatibility(compatibility);
+            loadedEvents[uid] = event;
+        }
+        batch.clear();
+        batchUids.clear();
+        return 1;
+    };
 
-    // Retrieve events from the calendar
-    const KCalendarCore::Event::List events = mCalendar->events();
-    for (const KCalendarCore::Event::Ptr& kcalEvent : std::as_const(events))
+    QByteArray text;
+    while (reader.readEventText(text))
     {
-        if (kcalEvent->alarms().isEmpty())
-            qCDebug(KALARM_LOG) << "SingleFileResource::readFromFile:" << displayId() << "KCalendarCore::Event has no alarms:" << kcalEvent->uid();
+        ++eventCount;
+        const QString uid = ICalStreamReader::eventUid(text);
+        const size_t hash = qHash(text);
+        if (uid.isEmpty()  ||  hashes.contains(uid))
+        {
+            if (changesOnly)
+                return 0;
+            hashesValid = false;
+        }
         else
-            addLoadedEvent(kcalEvent);
+            hashes[uid] = hash;
+
+        if (changesOnly)
+        {
+            auto it = mEventHashes.constFind(uid);
+            if (it != mEventHashes.constEnd()  &&  it.value() == hash)
+            {
+                // The event is unchanged, so reuse the event already loaded.
+                auto lit = mLoadedEvents.constFind(uid);
+                if (lit != mLoadedEvents.constEnd())
+                    loadedEvents[uid] = lit.value();
+                else
+                {
+                    const QList<KCalendarCore::Event::Ptr> others = mOtherEvents.values(uid);
+                    if (others.isEmpty())
+                        return 0;
+                    for (const KCalendarCore::Event::Ptr& kcalEvent : others)
+                        otherEvents.insert(uid, kcalEvent);
+                }
+                continue;
+            }
+        }
+
+        batch += text;
+        batchUids.insert(uid);
+        ++changedCount;
+        if (batchUids.count() >= LOAD_BATCH_SIZE)
+        {
+            const int result = parseBatch();
+            if (result <= 0)
+                return result;
+        }
     }
-    mCalendar->setModified(false);
-    return true;
+    if (!batch.isEmpty())
+    {
+        const int result = parseBatch();
+        if (result <= 0)
+            return result;
+    }
+
+    size_t headerHash = qHash(reader.header());
+    if (!headerHash)
+        headerHash = 1;
+    if (changesOnly  &&  headerHash != mHeaderHash)
+        return 0;
+    if (!eventCount  &&  reader.header().isEmpty())
+    {
+        // The file contains no calendar. Only allow it if it is empty.
+        file.seek(0);
+        if (!file.readAll().trimmed().isEmpty())
+        {
+            qCCritical(KALARM_LOG) << "SingleFileResource::readFromFile: Error loading file " << fileName;
+            errorMessage = xi18nc("@info", "Could not load file <filename>%1</filename>.", fileName);
+            return -1;
+        }
+    }
+    if (changesOnly)
+        qCDebug(KALARM_LOG) << "SingleFileResource::readFromFile:" << displayId() << changedCount << "changed events out of" << eventCount;
+
+    mLoadedEvents = loadedEvents;
+    mOtherEvents  = otherEvents;
+    mCalendarProperties = reader.properties();
+    mCalendarComponents = reader.components();
+    mVersion      = version;
+    mCompatibility = compatibility;
+    mFileName     = fileName;
+    mCalendarOpen = true;
+    mModified     = false;
+    if (hashesValid  &&  mCompatibility == KACalendar::Current)
+    {
+        mEventHashes = hashes;
+        mHeaderHash  = headerHash;
+    }
+    else
+        clearEventHashes();
+    return 1;
+}
+
+void SingleFileResource::clearEventHashes()
+{
+    mEventHashes.clear();
+    mHeaderHash = 0;
 }
 
 /******************************************************************************
 * Write calendar data to the given file.
+* Events whose VEVENT text is unchanged since the file was last read or written
+* are copied verbatim from that file, so that any properties which KAlarm does
+* not use are preserved. Only new and changed events are converted and written
+* a batch at a time, so that the whole calendar is never held in memory as
+* KCalendarCore events. The calendar properties and non-event components (e.g.
+* to-dos and journals) read from the file are also written back unchanged.
+* On success, the hashes of the file and of its VEVENT components are recorded
+* from the text written, so that the file does not need to be read again.
 */
 bool SingleFileResource::writeToFile(const QString& fileName, QString& errorMessage)
 {
     qCDebug(KALARM_LOG) << "SingleFileResource::writeToFile:" << fileName;
-    if (!mCalendar)
+    if (!mCalendarOpen)
     {
-        qCCritical(KALARM_LOG) << "SingleFileResource::writeToFile:" << displayId() << "mCalendar is null!";
+        qCCritical(KALARM_LOG) << "SingleFileResource::writeToFile:" << displayId() << "Calendar not open";
         errorMessage = i18nc("@info", "Calendar not open.");
         return false;
     }
-    KACalendar::setKAlarmVersion(mCalendar);   // write the application ID into the calendar
-    KCalendarCore::FileStorage::Ptr fileStorage = mFileStorage;
-    if (!mFileStorage  ||  fileName != mFileStorage->fileName())
-        fileStorage = KCalendarCore::FileStorage::Ptr::create(mCalendar, fileName,
-                                                              new KCalendarCore::ICalFormat());
 
-    bool success = true;
-    if (!fileStorage->save())    // this sets mCalendar->modified to false
+    QHash<QString, size_t> hashes;
+    bool hashesValid = (mCompatibility == KACalendar::Current);
+    size_t headerHash = 0;
+    QByteArray fileHash;
+    QSaveFile file(fileName);
+    bool success = file.open(QIODevice::WriteOnly);
+    if (success)
+    {
+        ICalStreamWriter writer(&file);
+        writer.setProperties(mCalendarProperties);
+        writer.setEventWrittenHandler([&](const QByteArray& text)
+        {
+            const QString uid = ICalStreamReader::eventUid(text);
+            if (uid.isEmpty()  ||  hashes.contains(uid))
+                hashesValid = false;
+            else
+                hashes[uid] = qHash(text);
+        });
+        success = writer.writeComponents(mCalendarComponents);
+
+        // Copy unchanged events from the file which was last read or written.
+        // QSaveFile writes to a temporary file, so this is safe even if it is
+        // the same file as is being written.
+        QSet<QString> written;   // UIDs of events already written
+        if (success  &&  !mEventHashes.isEmpty())
+        {
+            QFile oldFile(mFileName);
+            if (oldFile.open(QIODevice::ReadOnly))
+            {
+                ICalStreamReader reader(&oldFile, QTimeZone::utc());
+                QByteArray text;
+                QByteArray unchanged;
+                int unchangedCount = 0;
+                while (success  &&  reader.readEventText(text))
+                {
+                    const QString uid = ICalStreamReader::eventUid(text);
+                    auto it = mEventHashes.constFind(uid);
+                    if (it == mEventHashes.constEnd()  ||  it.value() != qHash(text)  ||  written.contains(uid)
+                    ||  (!mLoadedEvents.contains(uid)  &&  !mOtherEvents.contains(uid)))
+                        continue;
+                    written.insert(uid);
+                    unchanged += text;
+                    if (++unchangedCount >= SAVE_BATCH_SIZE)
+                    {
+                        success = writer.writeComponents(unchanged);
+                        unchanged.clear();
+                        unchangedCount = 0;
+                    }
+                }
+                if (success  &&  !unchanged.isEmpty())
+                    success = writer.writeComponents(unchanged);
+            }
+        }
+
+        // Convert and write the events which have changed.
+        KCalendarCore::Event::List batch;
+        for (auto it = mLoadedEvents.constBegin();  success  &&  it != mLoadedEvents.constEnd();  ++it)
+        {
+            if (written.contains(it.key()))
+                continue;
+            KCalendarCore::Event::Ptr kcalEvent(new KCalendarCore::Event);
+            if (it.value().updateKCalEvent(kcalEvent, KAEvent::UidAction::Set))
+                batch += kcalEvent;
+            else
+                qCWarning(KALARM_LOG) << "SingleFileResource::writeToFile:" << displayId() << "Event cannot be written:" << it.key();
+            if (batch.count() >= SAVE_BATCH_SIZE)
+            {
+                success = writer.writeEvents(batch);
+                batch.clear();
+            }
+        }
+        for (auto it = mOtherEvents.constBegin();  success  &&  it != mOtherEvents.constEnd();  ++it)
+        {
+            if (written.contains(it.key()))
+                continue;
+            batch += it.value();
+            if (batch.count() >= SAVE_BATCH_SIZE)
+            {
+                success = writer.writeEvents(batch);
+                batch.clear();
+            }
+        }
+        if (success  &&  !batch.isEmpty())
+            success = writer.writeEvents(batch);
+        success = success  &&  writer.finish()  &&  file.commit();
+        headerHash = qHash(writer.header());
+        fileHash   = writer.fileHash();
+    }
+    if (!success)
     {
-        qCCritical(KALARM_LOG) << "SingleFileResource::writeToFile:" << displayId() << "Failed to save calendar to file " << fileName;
+        qCCritical(KALARM_LOG) << "SingleFileResource::writeToFile:" << displayId() << "Failed to save calendar to file " << fileName << file.errorString();
         errorMessage = xi18nc("@info", "Could not save file <filename>%1</filename>.", fileName);
-        success = false;
+        return false;
     }
 
-    return success;
+    mFileName    = fileName;
+    mModified    = false;
+    mCurrentHash = fileHash;
+    if (hashesValid)
+    {
+        mEventHashes = hashes;
+        mHeaderHash  = headerHash ? headerHash : 1;
+    }
+    else
+        clearEventHashes();
+    return true;
 }
 
 /******************************************************************************
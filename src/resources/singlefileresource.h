@@ -11,9 +11,10 @@
 #include "fileresource.h"
 #include "fileresourceconfigmanager.h"
 
-#include <KCalendarCore/MemoryCalendar>
-#include <KCalendarCore/FileStorage>
+#include <KCalendarCore/Event>
 
+#include <QHash>
+#include <QMultiHash>
 #include <QUrl>
 
 namespace KIO {
@@ -145,10 +146,25 @@ protected:
     /** Read the data from the given local file. */
     bool readFromFile(const QString& fileName, QString& errorMessage);
 
+    /** Read the events in the given local file, converting them directly to
+     *  KAEvents a batch at a time.
+     *  @param changesOnly  only parse the events which have changed since the
+     *                      file was last read or written, and reuse the others.
+     *  @return 1 = success,
+     *          0 = only reading changes was not possible, and the whole file
+     *              needs to be read; nothing has been altered,
+     *         -1 = error.
+     */
+    int readEvents(const QString& fileName, bool changesOnly, QString& errorMessage);
+
+    /** Discard the recorded hashes, so that the whole file will be read next time. */
+    void clearEventHashes();
+
     /**
-     * Reimplement to write your data to the given file.
-     * The file is always local, storing back to the network url is done
-     * automatically when needed.
+     * Write the calendar data to the given local file. Events which have not
+     * changed since the file was last read or written are copied verbatim
+     * from that file, as are its non-event components and calendar properties.
+     * Storing back to the network url is done automatically when needed.
      */
     bool writeToFile(const QString& fileName, QString& errorMessage);
 
@@ -198,7 +214,6 @@ private Q_SLOTS:
     void slotDownloadJobResult(KJob*);
     void slotUploadJobResult(KJob*);
     void updateFormat()    { updateStorageFmt(); }
-    bool addLoadedEvent(const KCalendarCore::Event::Ptr&);
 
 private:
     void setLoadFailure(bool exists, Status);
@@ -207,12 +222,18 @@ private:
     KIO::FileCopyJob*  mDownloadJob {nullptr};
     KIO::FileCopyJob*  mUploadJob {nullptr};
     QByteArray         mCurrentHash;
-    KCalendarCore::MemoryCalendar::Ptr mCalendar;
-    KCalendarCore::FileStorage::Ptr    mFileStorage;
-    QHash<QString, KAEvent> mLoadedEvents;    // events loaded from calendar last time file was read
+    QString            mFileName;             // local file which the calendar was last read from
+    QHash<QString, KAEvent> mLoadedEvents;    // the calendar's KAlarm events, by ID
+    QMultiHash<QString, KCalendarCore::Event::Ptr> mOtherEvents;  // calendar events which are not valid KAlarm events
+    QByteArray         mCalendarProperties;   // calendar properties read from the file
+    QByteArray         mCalendarComponents;   // non-event components (e.g. to-dos) read from the file
+    QHash<QString, size_t>  mEventHashes;     // hash of each unmodified event's VEVENT text, by UID
+    size_t             mHeaderHash {0};       // hash of calendar properties and time zones, or 0 if unknown
     QTimer*            mSaveTimer {nullptr};  // timer to enable multiple saves to be grouped
     bool               mSavePendingCache;     // writeThroughCache parameter for delayed save()
     bool               mFileReadOnly {false}; // the calendar file is a read-only local file
+    bool               mCalendarOpen {false}; // the calendar has been read from the file
+    bool               mModified {false};     // events have changed since the file was last read or written
 };
 
 // vim: et sw=4:
@@ -15,6 +15,8 @@
 
 #include <KCalendarCore/CalFormat>
 
+#include <algorithm>
+
 using namespace KAlarmCal;
 
 
@@ -25,6 +27,8 @@ ResourcesCalendar::EarliestMap ResourcesCalendar::mEarliestNonDispAlarm;
 QSet<QString>                  ResourcesCalendar::mPendingAlarms;
 bool                           ResourcesCalendar::mIgnoreAtLogin {false};
 bool                           ResourcesCalendar::mHaveDisabledAlarms {false};
+QMultiMap<QDateTime, EventId>  ResourcesCalendar::mDisplayOrder;
+QHash<EventId, QDateTime>      ResourcesCalendar::mDisplayTimes;
 QHash<ResourceId, QHash<QString, KernelWakeAlarm>> ResourcesCalendar::mWakeSuspendTimers;
 
 
@@ -60,11 +64,14 @@ ResourcesCalendar::ResourcesCalendar()
     connect(resources, &Resources::resourceAdded, this, &ResourcesCalendar::slotResourceAdded);
     connect(resources, &Resources::eventsAdded, this, &ResourcesCalendar::slotEventsAdded);
     connect(resources, &Resources::eventsToBeRemoved, this, &ResourcesCalendar::slotEventsToBeRemoved);
-    connect(resources, &Resources::eventUpdated, this, &ResourcesCalendar::slotEventUpdated);
+    connect(resources, &Resources::eventsUpdated, this, &ResourcesCalendar::slotEventsUpdated);
     connect(resources, &Resources::resourcesPopulated, this, &ResourcesCalendar::slotResourcesPopulated);
     connect(resources, &Resources::settingsChanged, this, &ResourcesCalendar::slotResourceSettingsChanged);
     connect(theApp(), &KAlarmApp::alarmEnabledToggled, this, &ResourcesCalendar::slotAlarmsEnabledToggled);
     Preferences::connect(&Preferences::wakeFromSuspendAdvanceChanged, this, &ResourcesCalendar::slotWakeFromSuspendAdvanceChanged);
+    Preferences::connect(&Preferences::startOfDayChanged, this, &ResourcesCalendar::slotRebuildDisplayOrder);
+    Preferences::connect(&Preferences::workTimeChanged, this, &ResourcesCalendar::slotRebuildDisplayOrder);
+    Preferences::connect(&Preferences::holidaysChanged, this, &ResourcesCalendar::slotRebuildDisplayOrder);
 
     // Fetch events from all resources which already exist.
     QList<Resource> allResources = Resources::enabledResources();
@@ -103,7 +110,10 @@ void ResourcesCalendar::removeKAEvents(ResourceId key, bool closing, CalEvent::T
             else
                 remove = event.category() & types;
             if (remove)
+            {
+                removeDisplayTime(EventId(key, *it), !closing);
                 removed = true;
+            }
             else
                 retained.insert(*it);
         }
@@ -182,6 +192,15 @@ void ResourcesCalendar::slotEventsAdded(Resource& resource, const QList<KAEvent>
         slotEventUpdated(resource, event);
 }
 
+/******************************************************************************
+* Called when events have been changed in a resource.
+*/
+void ResourcesCalendar::slotEventsUpdated(Resource& resource, const QList<KAEvent>& events)
+{
+    for (const KAEvent& event : events)
+        slotEventUpdated(resource, event);
+}
+
 /******************************************************************************
 * Called when an event has been changed in a resource.
 * Record that the event is now usable by the ResourcesCalendar.
@@ -237,6 +256,8 @@ void ResourcesCalendar::slotEventUpdated(Resource& resource, const KAEvent& even
         }
     }
 
+    updateDisplayTime(event);
+
     if (event.category() == CalEvent::ACTIVE)
     {
         bool enabled = event.enabled();
@@ -306,14 +327,23 @@ void ResourcesCalendar::slotWakeFromSuspendAdvanceChanged(unsigned advance)
 * to prevent asynchronous calendar operations interfering with one another.
 *
 * Purge a list of archived events from the calendar.
+* The events in each resource are deleted together, so that they are notified
+* as a block and the resource is saved only once.
 */
 void ResourcesCalendar::purgeEvents(const QList<KAEvent>& events)
 {
+    QHash<ResourceId, QList<KAEvent>> resourceEvents;
     for (const KAEvent& event : events)
+        resourceEvents[event.resourceId()] += event;
+    for (auto it = resourceEvents.constBegin();  it != resourceEvents.constEnd();  ++it)
     {
-        Resource resource = Resources::resource(event.resourceId());
+        Resource resource = Resources::resource(it.key());
         if (resource.isValid())
-            deleteEventInternal(event.id(), event, resource, true);
+        {
+            for (const KAEvent& event : it.value())
+                deleteEventInternal(event.id(), event, resource, false);
+            resource.deleteEvents(it.value());
+        }
     }
     if (mHaveDisabledAlarms)
         mInstance->checkForDisabledAlarms();
@@ -352,21 +382,7 @@ bool ResourcesCalendar::addEvent(KAEvent& evnt, Resource& resource, QWidget* pro
     }
 
     KAEvent event = evnt;
-    QString id = event.id();
-    if (type == CalEvent::ACTIVE)
-    {
-        if (id.isEmpty())
-            useEventID = false;
-        else if (!useEventID)
-            id.clear();
-    }
-    else
-        useEventID = true;
-    if (id.isEmpty())
-        id = KCalendarCore::CalFormat::createUniqueId();
-    if (useEventID)
-        id = CalEvent::uid(id, type);   // include the alarm type tag in the ID
-    event.setEventId(id);
+    setNewEventId(event, useEventID);
 
     bool ok = false;
     if (!resource.isEnabled(type))
@@ -393,6 +409,108 @@ bool ResourcesCalendar::addEvent(KAEvent& evnt, Resource& resource, QWidget* pro
     return ok;
 }
 
+/******************************************************************************
+* Add a list of active events to the calendar, saving the resource only once.
+* Event IDs are set as for addEvent(), and the resource is determined in the
+* same way. 'failed' is set to the indexes in 'events' of the events which
+* could not be added.
+* Reply = true if any events were written to the calendar. The events which
+*              were written are updated.
+*       = false if no events were written.
+*/
+bool ResourcesCalendar::addEvents(QList<KAEvent>& events, Resource& resource, QWidget* promptParent, AddEventOptions options, QList<int>& failed)
+{
+    qCDebug(KALARM_LOG) << "ResourcesCalendar::addEvents: count" << events.count() << ", resource" << resource.displayId();
+    failed.clear();
+    if (events.isEmpty())
+        return false;
+
+    QList<KAEvent> newEvents;
+    QList<int> indexes;     // index in 'events' of each item in 'newEvents'
+    newEvents.reserve(events.count());
+    indexes.reserve(events.count());
+    for (int i = 0, count = events.count();  i < count;  ++i)
+    {
+        if (events[i].category() != CalEvent::ACTIVE)
+        {
+            failed += i;
+            continue;
+        }
+        KAEvent event = events[i];
+        setNewEventId(event, options & UseEventId);
+        newEvents += event;
+        indexes += i;
+    }
+    if (newEvents.isEmpty())
+        return false;
+
+    if (!resource.isEnabled(CalEvent::ACTIVE))
+    {
+        Resources::DestOptions destOptions {};
+        if (options & NoResourcePrompt)
+            destOptions |= Resources::NoResourcePrompt;
+        resource = Resources::destination(CalEvent::ACTIVE, promptParent, destOptions);
+        if (!resource.isValid())
+        {
+            qCWarning(KALARM_LOG) << "ResourcesCalendar::addEvents: Error! Cannot create events (No default calendar is defined)";
+            failed += indexes;
+            std::sort(failed.begin(), failed.end());
+            return false;
+        }
+    }
+
+    // Don't add the events to mResourceMap yet - they will be added after they
+    // are inserted into the data model, when the resource signals eventsAdded().
+    QList<int> notAdded;
+    resource.addEvents(newEvents, notAdded);
+    bool disabled = false;
+    int n = 0;
+    for (int i = 0, count = newEvents.count();  i < count;  ++i)
+    {
+        if (n < notAdded.count()  &&  notAdded[n] == i)
+        {
+            ++n;
+            failed += indexes[i];
+            continue;
+        }
+        KAEvent& event = newEvents[i];
+        event.setResourceId(resource.id());
+        if (!event.enabled())
+            disabled = true;
+        events[indexes[i]] = event;
+    }
+    std::sort(failed.begin(), failed.end());
+    if (disabled)
+        mInstance->checkForDisabledAlarms(true, false);
+    return notAdded.count() < newEvents.count();
+}
+
+/******************************************************************************
+* Set a new ID for an event which is to be added to the calendar.
+* If it is an active event and 'useEventID' is false, or if it has no ID, a new
+* event ID is created. Otherwise, the existing event ID is used, tagged with
+* the alarm type.
+*/
+void ResourcesCalendar::setNewEventId(KAEvent& event, bool useEventID)
+{
+    const CalEvent::Type type = event.category();
+    QString id = event.id();
+    if (type == CalEvent::ACTIVE)
+    {
+        if (id.isEmpty())
+            useEventID = false;
+        else if (!useEventID)
+            id.clear();
+    }
+    else
+        useEventID = true;
+    if (id.isEmpty())
+        id = KCalendarCore::CalFormat::createUniqueId();
+    if (useEventID)
+        id = CalEvent::uid(id, type);   // include the alarm type tag in the ID
+    event.setEventId(id);
+}
+
 /******************************************************************************
 * Modify the specified event in the calendar with its new contents.
 * The new event must have a different event ID from the old one; if it does not
@@ -517,6 +635,7 @@ CalEvent::Type ResourcesCalendar::deleteEventInternal(const QString& eventID, co
         mWakeSuspendTimers[key].remove(eventID);   // this cancels the timer
 
     mResourceMap[key].remove(eventID);
+    removeDisplayTime(EventId(key, eventID));
     if (mEarliestAlarm.value(key)        == eventID
     ||  mEarliestNonDispAlarm.value(key) == eventID)
         mInstance->findEarliestAlarm(resource);
@@ -822,6 +941,102 @@ KAEvent ResourcesCalendar::earliestAlarm(KADateTime& nextTriggerTime, bool exclu
     return earliest;
 }
 
+/******************************************************************************
+* Return the enabled active message alarms which are next due to be displayed,
+* up to a specified time, in order of their next display time.
+*/
+QList<KAEvent> ResourcesCalendar::nextDisplayAlarms(const KADateTime& until, int maxCount)
+{
+    const QDateTime end = until.toUtc().qDateTime();
+    QList<KAEvent> events;
+    for (auto it = mDisplayOrder.constBegin();  it != mDisplayOrder.constEnd();  ++it)
+    {
+        if (it.key() > end)
+            break;
+        const KAEvent event = Resources::resource(it.value().resourceId()).event(it.value().eventId());
+        if (event.isValid())
+        {
+            events += event;
+            if (maxCount > 0  &&  events.count() >= maxCount)
+                break;
+        }
+    }
+    return events;
+}
+
+/******************************************************************************
+* Update an event's position in the display time order of message alarms.
+* The event is only included if it is an enabled active message alarm.
+*/
+void ResourcesCalendar::updateDisplayTime(const KAEvent& event, bool notify)
+{
+    const EventId id(event);
+    QDateTime newTime;
+    if (event.category() == CalEvent::ACTIVE  &&  event.enabled()  &&  !event.expired()
+    &&  event.actionSubType() == KAEvent::SubAction::Message)
+    {
+        const DateTime next = event.nextTrigger(KAEvent::Trigger::Display);
+        if (next.isValid())
+            newTime = next.effectiveKDateTime().toUtc().qDateTime();
+    }
+
+    QDateTime oldTime;
+    auto it = mDisplayTimes.find(id);
+    if (it != mDisplayTimes.end())
+    {
+        oldTime = it.value();
+        mDisplayOrder.remove(oldTime, id);
+        if (newTime.isValid())
+            it.value() = newTime;
+        else
+            mDisplayTimes.erase(it);
+    }
+    else if (newTime.isValid())
+        mDisplayTimes.insert(id, newTime);
+    if (newTime.isValid())
+        mDisplayOrder.insert(newTime, id);
+
+    if (notify  &&  (oldTime.isValid() || newTime.isValid()))
+        Q_EMIT mInstance->displayAlarmsChanged(oldTime, newTime);
+}
+
+/******************************************************************************
+* Remove an event from the display time order of message alarms.
+*/
+void ResourcesCalendar::removeDisplayTime(const EventId& id, bool notify)
+{
+    auto it = mDisplayTimes.find(id);
+    if (it != mDisplayTimes.end())
+    {
+        const QDateTime oldTime = it.value();
+        mDisplayOrder.remove(oldTime, id);
+        mDisplayTimes.erase(it);
+        if (notify)
+            Q_EMIT mInstance->displayAlarmsChanged(oldTime, QDateTime());
+    }
+}
+
+/******************************************************************************
+* Called when the start-of-day time, working time or holiday preferences have
+* changed. The display times of date-only alarms, and of alarms restricted to
+* working time or non-holidays, may have changed, so rebuild the display time
+* order of message alarms.
+* Note that KAlarmApp connects to these preference signals before this instance
+* is created, so KAEvent has already been updated with the new settings.
+*/
+void ResourcesCalendar::slotRebuildDisplayOrder()
+{
+    mDisplayOrder.clear();
+    mDisplayTimes.clear();
+    for (auto rit = mResourceMap.constBegin();  rit != mResourceMap.constEnd();  ++rit)
+    {
+        const Resource resource = Resources::resource(rit.key());
+        for (const QString& eventId : rit.value())
+            updateDisplayTime(resource.event(eventId), false);
+    }
+    Q_EMIT displayAlarmsChanged(QDateTime(), QDateTime());
+}
+
 /******************************************************************************
 * Note that an alarm which has triggered is now being processed. While pending,
 * it will be ignored for the purposes of finding the earliest trigger time.
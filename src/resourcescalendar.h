@@ -8,15 +8,16 @@
 
 #pragma once
 
+#include "eventid.h"
 #include "kernelwakealarm.h"
 #include "resources/resource.h"
 #include "kalarmcalendar/kaevent.h"
 
+#include <QDateTime>
 #include <QHash>
+#include <QMultiMap>
 #include <QObject>
 
-class EventId;
-
 using namespace KAlarmCal;
 
 
@@ -25,6 +26,7 @@ using namespace KAlarmCal;
  *  When events are added, modified or deleted, additional processing is
  *  performed beyond what the raw Resource classes do, to:
  *  - keep track of which events are to be triggered first in each resource.
+ *  - keep track of the order in which message alarms are next due.
  *  - keep track of whether any events are disabled.
  *  - control the triggering of repeat-at-login alarms.
  */
@@ -43,6 +45,13 @@ public:
      */
     static KAEvent        earliestAlarm(KADateTime& nextTriggerTime, bool excludeDisplayAlarms = false);
 
+    /** Return the enabled active message alarms which are next due to be
+     *  displayed, in order of their next display time.
+     *  @param until     Latest display time to include.
+     *  @param maxCount  Maximum number of alarms to return, or <= 0 for no limit.
+     */
+    static QList<KAEvent> nextDisplayAlarms(const KADateTime& until, int maxCount = 0);
+
     static void           setAlarmPending(const KAEvent&, bool pending = true);
     static bool           haveDisabledAlarms()       { return mHaveDisabledAlarms; }
     static void           disabledChanged(const KAEvent&);
@@ -63,6 +72,7 @@ public:
     Q_DECLARE_FLAGS(AddEventOptions, AddEventOption)
 
     static bool           addEvent(KAEvent&, Resource&, QWidget* promptparent = nullptr, AddEventOptions options = NoOption, bool* cancelled = nullptr);
+    static bool           addEvents(QList<KAEvent>&, Resource&, QWidget* promptparent, AddEventOptions options, QList<int>& failed);
     static bool           modifyEvent(const EventId& oldEventId, KAEvent& newEvent);
     static KAEvent        updateEvent(const KAEvent&, bool saveIfReadOnly = true);
     static bool           deleteEvent(const KAEvent&, Resource&, bool save = false);
@@ -71,6 +81,12 @@ public:
 
 Q_SIGNALS:
     void                  earliestAlarmChanged();
+    /** Emitted when a message alarm has been added to, updated in or removed
+     *  from the display time order. The times are in UTC, and are invalid if
+     *  the alarm was not/is no longer in the order. If both are invalid, the
+     *  whole order may have changed.
+     */
+    void                  displayAlarmsChanged(const QDateTime& oldTime, const QDateTime& newTime);
     void                  haveDisabledAlarmsChanged(bool haveDisabled);
     void                  atLoginEventAdded(const KAlarmCal::KAEvent&);
 
@@ -80,9 +96,11 @@ private Q_SLOTS:
     void                  slotResourceAdded(Resource&);
     void                  slotEventsAdded(Resource&, const QList<KAlarmCal::KAEvent>&);
     void                  slotEventsToBeRemoved(Resource&, const QList<KAlarmCal::KAEvent>&);
+    void                  slotEventsUpdated(Resource&, const QList<KAlarmCal::KAEvent>&);
     void                  slotEventUpdated(Resource&, const KAlarmCal::KAEvent&);
     void                  slotAlarmsEnabledToggled(bool enabled);
     void                  slotWakeFromSuspendAdvanceChanged(unsigned advance);
+    void                  slotRebuildDisplayOrder();
 private:
     ResourcesCalendar();
     static CalEvent::Type deleteEventInternal(const KAlarmCal::KAEvent&, Resource&, bool deleteFromResource = true);
@@ -95,8 +113,11 @@ private:
     void                  checkForDisabledAlarms();
     void                  checkForDisabledAlarms(bool oldEnabled, bool newEnabled);
     static QList<KAEvent> eventsForResource(const Resource&, const QSet<QString>& eventIds);
+    static void           setNewEventId(KAEvent&, bool useEventID);
     void                  setKernelWakeSuspend();
     static void           checkKernelWakeSuspend(ResourceId, const KAlarmCal::KAEvent&);
+    static void           updateDisplayTime(const KAlarmCal::KAEvent&, bool notify = true);
+    static void           removeDisplayTime(const EventId&, bool notify = true);
 
     static ResourcesCalendar* mInstance;   // the unique instance
 
@@ -109,6 +130,8 @@ private:
     static QSet<QString>  mPendingAlarms;      // IDs of alarms which are currently being processed after triggering
     static bool           mIgnoreAtLogin;      // ignore new/updated repeat-at-login alarms
     static bool           mHaveDisabledAlarms; // there is at least one individually disabled alarm
+    static QMultiMap<QDateTime, EventId> mDisplayOrder;  // enabled active message alarms, by next display time (UTC)
+    static QHash<EventId, QDateTime>     mDisplayTimes;  // next display time (UTC) of each alarm in mDisplayOrder
     // Wake from suspend kernel timers: indexed by resource and event ID.
     // There is an entry for every enabled alarm with kernel wake from suspend specified.
     // If alarms are disabled (for all alarms), the entries still exist with kernel timers disarmed.
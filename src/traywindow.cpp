@@ -16,8 +16,6 @@
 #include "prefdlg.h"
 #include "preferences.h"
 #include "resourcescalendar.h"
-#include "resources/datamodel.h"
-#include "resources/eventmodel.h"
 #include "lib/synchtimer.h"
 #include "kalarmcalendar/alarmtext.h"
 #include "kalarm_debug.h"
@@ -36,12 +34,6 @@
 
 using namespace KAlarmCal;
 
-struct TipItem
-{
-    QDateTime  dateTime;
-    QString    text;
-};
-
 
 /*=============================================================================
 = Class: TrayWindow
@@ -111,15 +103,10 @@ TrayWindow::TrayWindow(MainWindow* parent)
     connect(mToolTipUpdateTimer, &QTimer::timeout, this, &TrayWindow::updateToolTip);
 
     // Update every minute to show accurate deadlines
-    MinuteTimer::connect(mToolTipUpdateTimer, SLOT(start()));
+    MinuteTimer::connect(this, SLOT(slotMinuteTick()));
 
-    // Update when alarms are modified
-    AlarmListModel* all = DataModel::allAlarmListModel();
-    connect(all, &QAbstractItemModel::dataChanged,  mToolTipUpdateTimer, qOverload<>(&QTimer::start));
-    connect(all, &QAbstractItemModel::rowsInserted, mToolTipUpdateTimer, qOverload<>(&QTimer::start));
-    connect(all, &QAbstractItemModel::rowsMoved,    mToolTipUpdateTimer, qOverload<>(&QTimer::start));
-    connect(all, &QAbstractItemModel::rowsRemoved,  mToolTipUpdateTimer, qOverload<>(&QTimer::start));
-    connect(all, &QAbstractItemModel::modelReset,   mToolTipUpdateTimer, qOverload<>(&QTimer::start));
+    // Update when alarms which are due soon are modified
+    connect(ResourcesCalendar::instance(), &ResourcesCalendar::displayAlarmsChanged, this, &TrayWindow::slotDisplayAlarmsChanged);
 
     // Set auto-hide status when next alarm or preferences change
     mStatusUpdateTimer->setSingleShot(true);
@@ -293,6 +280,7 @@ void TrayWindow::updateToolTip()
 {
     bool enabled = theApp()->alarmsEnabled();
     QString subTitle;
+    mToolTipHorizon = QDateTime();
     if (enabled && Preferences::tooltipAlarmCount())
         subTitle = tooltipAlarmText();
 
@@ -307,6 +295,33 @@ void TrayWindow::updateToolTip()
     setToolTipSubTitle(subTitle);
 }
 
+/******************************************************************************
+* Called when a message alarm's next display time has changed, or the alarm has
+* been added or removed.
+* Update the tooltip if the alarm is, or was, due soon enough to be shown in it.
+*/
+void TrayWindow::slotDisplayAlarmsChanged(const QDateTime& oldTime, const QDateTime& newTime)
+{
+    if (!mToolTipHorizon.isValid())
+        return;    // the tooltip doesn't show any alarms
+    if ((!oldTime.isValid()  &&  !newTime.isValid())
+    ||  (oldTime.isValid()  &&  oldTime <= mToolTipHorizon)
+    ||  (newTime.isValid()  &&  newTime <= mToolTipHorizon))
+        mToolTipUpdateTimer->start();
+}
+
+/******************************************************************************
+* Called every minute.
+* Update the tooltip if it shows the time to each alarm, or if more alarms may
+* now be due within 24 hours.
+*/
+void TrayWindow::slotMinuteTick()
+{
+    if (mToolTipHorizon.isValid()
+    &&  (Preferences::showTooltipTimeToAlarm()  ||  !mToolTipFull))
+        mToolTipUpdateTimer->start();
+}
+
 /******************************************************************************
 * Adjust icon according to the app state.
 */
@@ -320,72 +335,57 @@ void TrayWindow::updateIcon()
 /******************************************************************************
 * Return the tooltip text showing alarms due in the next 24 hours.
 * The limit of 24 hours is because only times, not dates, are displayed.
+* The alarms are fetched from the calendar's display time order, so only those
+* which are shown need to be examined.
 */
-QString TrayWindow::tooltipAlarmText() const
+QString TrayWindow::tooltipAlarmText()
 {
     const QString& prefix = Preferences::tooltipTimeToPrefix();
-    int maxCount = Preferences::tooltipAlarmCount();
+    const int maxCount = Preferences::tooltipAlarmCount();
     const KADateTime now = KADateTime::currentLocalDateTime();
     const KADateTime tomorrow = now.addDays(1);
 
-    // Get today's and tomorrow's alarms, sorted in time order
-    int i, iend;
-    QList<TipItem> items;
-    QList<KAEvent> events = KAlarm::getSortedActiveEvents(const_cast<TrayWindow*>(this), &mAlarmsModel);
-    for (i = 0, iend = events.count();  i < iend;  ++i)
-    {
-        KAEvent* event = &events[i];
-        if (event->actionSubType() == KAEvent::SubAction::Message)
-        {
-            TipItem item;
-            QDateTime dateTime = event->nextTrigger(KAEvent::Trigger::Display).effectiveKDateTime().toLocalZone().qDateTime();
-            if (dateTime > tomorrow.qDateTime())
-                break;   // ignore alarms after tomorrow at the current clock time
-            item.dateTime = dateTime;
-
-            // The alarm is due today, or early tomorrow
-            if (Preferences::showTooltipAlarmTime())
-            {
-                item.text += QLocale().toString(item.dateTime.time(), QLocale::ShortFormat);
-                item.text += QLatin1Char(' ');
-            }
-            if (Preferences::showTooltipTimeToAlarm())
-            {
-                int mins = (now.qDateTime().secsTo(item.dateTime) + 59) / 60;
-                if (mins < 0)
-                    mins = 0;
-                char minutes[3] = "00";
-                minutes[0] = static_cast<char>((mins%60) / 10 + '0');
-                minutes[1] = static_cast<char>((mins%60) % 10 + '0');
-                if (Preferences::showTooltipAlarmTime())
-                    item.text += i18nc("@info prefix + hours:minutes", "(%1%2:%3)", prefix, mins/60, QLatin1String(minutes));
-                else
-                    item.text += i18nc("@info prefix + hours:minutes", "%1%2:%3", prefix, mins/60, QLatin1String(minutes));
-                item.text += QLatin1Char(' ');
-            }
-            item.text += AlarmText::summary(*event);
-
-            // Insert the item into the list in time-sorted order
-            int it = 0;
-            for (int itend = items.count();  it < itend;  ++it)
-            {
-                if (item.dateTime <= items.at(it).dateTime)
-                    break;
-            }
-            items.insert(it, item);
-        }
-    }
+    // Get today's and tomorrow's alarms, in time order
+    const QList<KAEvent> events = ResourcesCalendar::nextDisplayAlarms(tomorrow, maxCount);
+    mToolTipFull = (maxCount > 0  &&  events.count() >= maxCount);
+    mToolTipHorizon = tomorrow.toUtc().qDateTime();
     qCDebug(KALARM_LOG) << "TrayWindow::tooltipAlarmText";
     QString text;
     int count = 0;
-    for (i = 0, iend = items.count();  i < iend;  ++i)
+    for (const KAEvent& event : events)
     {
-        qCDebug(KALARM_LOG) << "TrayWindow::tooltipAlarmText: --" << (count+1) << ")" << items.at(i).text;
-        if (i > 0)
+        const KADateTime dateTime = event.nextTrigger(KAEvent::Trigger::Display).effectiveKDateTime();
+        if (mToolTipFull)
+            mToolTipHorizon = dateTime.toUtc().qDateTime();   // later alarms can't be shown
+        const QDateTime localDateTime = dateTime.toLocalZone().qDateTime();
+
+        // The alarm is due today, or early tomorrow
+        QString item;
+        if (Preferences::showTooltipAlarmTime())
+        {
+            item += QLocale().toString(localDateTime.time(), QLocale::ShortFormat);
+            item += QLatin1Char(' ');
+        }
+        if (Preferences::showTooltipTimeToAlarm())
+        {
+            int mins = (now.qDateTime().secsTo(localDateTime) + 59) / 60;
+            if (mins < 0)
+                mins = 0;
+            char minutes[3] = "00";
+            minutes[0] = static_cast<char>((mins%60) / 10 + '0');
+            minutes[1] = static_cast<char>((mins%60) % 10 + '0');
+            if (Preferences::showTooltipAlarmTime())
+                item += i18nc("@info prefix + hours:minutes", "(%1%2:%3)", prefix, mins/60, QLatin1String(minutes));
+            else
+                item += i18nc("@info prefix + hours:minutes", "%1%2:%3", prefix, mins/60, QLatin1String(minutes));
+            item += QLatin1Char(' ');
+        }
+        item += AlarmText::summary(event);
+
+        qCDebug(KALARM_LOG) << "TrayWindow::tooltipAlarmText: --" << (count+1) << ")" << item;
+        if (count++ > 0)
             text += QLatin1String("<br />");
-        text += items.at(i).text;
-        if (++count == maxCount)
-            break;
+        text += item;
     }
     return text;
 }
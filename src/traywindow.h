@@ -13,11 +13,12 @@
 
 #include <KStatusNotifierItem>
 
+#include <QDateTime>
+
 class QTimer;
 class KToggleAction;
 class MainWindow;
 class NewAlarmAction;
-class AlarmListModel;
 
 using namespace KAlarmCal;
 
@@ -47,17 +48,20 @@ private Q_SLOTS:
     void         slotQuitAfter();
     void         updateStatus();
     void         updateToolTip();
+    void         slotDisplayAlarmsChanged(const QDateTime& oldTime, const QDateTime& newTime);
+    void         slotMinuteTick();
 
 private:
-    QString      tooltipAlarmText() const;
+    QString      tooltipAlarmText();
     void         updateIcon();
 
     MainWindow*     mAssocMainWindow;     // main window associated with this, or null
     KToggleAction*  mActionEnabled;
     NewAlarmAction* mActionNew;
-    mutable AlarmListModel* mAlarmsModel {nullptr}; // active alarms sorted in time order
     QTimer*         mStatusUpdateTimer;
     QTimer*         mToolTipUpdateTimer;
+    QDateTime       mToolTipHorizon;      // alarms due after this time can't affect the tooltip (UTC)
+    bool            mToolTipFull {false}; // the tooltip shows the maximum number of alarms
     bool            mHaveDisabledAlarms {false};  // some individually disabled alarms exist
 };
 